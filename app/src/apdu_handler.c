@@ -49,6 +49,36 @@ __Z_INLINE void handleGetAddrSecp256K1(volatile uint32_t *flags,
     THROW(APDU_CODE_OK);
 }
 
+__Z_INLINE void handleGetAddrBatch(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
+    const uint8_t len = extractHRP(rx, OFFSET_DATA);
+    const uint32_t offset = OFFSET_DATA + 1 + len;
+
+    // base path (4 x uint32) | start index (uint32) | count (uint8)
+    const uint32_t basePathSize = sizeof(uint32_t) * (HDPATH_LEN_DEFAULT - 1);
+    if (rx < offset + basePathSize + sizeof(uint32_t) + 1) {
+        THROW(APDU_CODE_WRONG_LENGTH);
+    }
+
+    uint32_t path[HDPATH_LEN_DEFAULT];
+    MEMCPY(path, G_io_apdu_buffer + offset, basePathSize);
+
+    uint32_t start;
+    MEMCPY(&start, G_io_apdu_buffer + offset + basePathSize, sizeof(uint32_t));
+    const uint8_t count = G_io_apdu_buffer[offset + basePathSize + sizeof(uint32_t)];
+
+    // Only non-hardened indices can be derived from the account public key
+    if (count == 0 || start >= 0x80000000u || 0x80000000u - start < count) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+
+    // The whole range has to be allowed, the last index is the largest one
+    path[HDPATH_LEN_DEFAULT - 1] = start + count - 1;
+    checkHDPath(path, HDPATH_LEN_DEFAULT);
+
+    *tx = crypto_fillAddressBatch(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE - 2, path, start, count);
+    THROW(APDU_CODE_OK);
+}
+
 __Z_INLINE void handleSignSecp256K1(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
     if (!process_chunk(tx, rx)) {
         THROW(APDU_CODE_OK);
@@ -67,9 +97,69 @@ __Z_INLINE void handleSignSecp256K1(volatile uint32_t *flags, volatile uint32_t
     }
 
     view_sign_show();
+    app_sign_review_start();
+    *flags |= IO_ASYNCH_REPLY;
+}
+
+__Z_INLINE void handleSignBatchFetch(volatile uint32_t *tx, uint32_t rx) {
+    if (G_io_apdu_buffer[OFFSET_P2] != 0) {
+        THROW(APDU_CODE_INVALIDP1P2);
+    }
+    if (rx < OFFSET_DATA + 1) {
+        THROW(APDU_CODE_WRONG_LENGTH);
+    }
+    if (!app_sign_batch_approved()) {
+        THROW(APDU_CODE_CONDITIONS_NOT_SATISFIED);
+    }
+
+    const uint8_t start = G_io_apdu_buffer[OFFSET_DATA];
+    if (start >= tx_batch_count()) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+
+    *tx = app_sign_batch_fetch(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE - 2, start);
+    if (*tx == 0) {
+        THROW(APDU_CODE_SIGN_VERIFY_ERROR);
+    }
+    THROW(APDU_CODE_OK);
+}
+
+__Z_INLINE void handleSignBatch(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
+    if (G_io_apdu_buffer[OFFSET_PAYLOAD_TYPE] == PAYLOAD_TYPE_FETCH) {
+        handleSignBatchFetch(tx, rx);
+        return;
+    }
+
+    if (!process_chunk(tx, rx)) {
+        THROW(APDU_CODE_OK);
+    }
+
+    // Put address in output buffer, we will use it to confirm source address
+    app_fill_address(addr_secp256k1);
+
+    const char *error_msg = tx_batch_parse();
+
+    if (error_msg != NULL) {
+        int error_msg_length = strlen(error_msg);
+        MEMCPY(G_io_apdu_buffer, error_msg, error_msg_length);
+        *tx += (error_msg_length);
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+
+    view_sign_show();
+    app_sign_review_start();
     *flags |= IO_ASYNCH_REPLY;
 }
 
+#if defined(APP_SIGN_STATS)
+__Z_INLINE void handleGetSignStats(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
+    app_sign_stats.key_staged = crypto_signing_key_staged(hdPath);
+    MEMCPY(G_io_apdu_buffer, &app_sign_stats, sizeof(app_sign_stats));
+    *tx = sizeof(app_sign_stats);
+    THROW(APDU_CODE_OK);
+}
+#endif
+
 void handleApdu(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
     uint16_t sw = 0;
 
@@ -83,6 +173,12 @@ void handleApdu(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
                 THROW(APDU_CODE_WRONG_LENGTH);
             }
 
+            // An approved batch keeps its key only while the host fetches the signatures
+            if (G_io_apdu_buffer[OFFSET_INS] != INS_SIGN_BATCH ||
+                G_io_apdu_buffer[OFFSET_PAYLOAD_TYPE] != PAYLOAD_TYPE_FETCH) {
+                app_sign_batch_interrupt();
+            }
+
             switch (G_io_apdu_buffer[OFFSET_INS]) {
                 case INS_GET_VERSION: {
                     handle_getversion(flags, tx, rx);
@@ -99,6 +195,23 @@ void handleApdu(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
                     break;
                 }
 
+                case INS_GET_ADDR_BATCH: {
+                    handleGetAddrBatch(flags, tx, rx);
+                    break;
+                }
+
+                case INS_SIGN_BATCH: {
+                    handleSignBatch(flags, tx, rx);
+                    break;
+                }
+
+#if defined(APP_SIGN_STATS)
+                case INS_GET_SIGN_STATS: {
+                    handleGetSignStats(flags, tx, rx);
+                    break;
+                }
+#endif
+
                 default:
                     THROW(APDU_CODE_INS_NOT_SUPPORTED);
             }
@@ -24,14 +24,100 @@
 
 uint8_t action_addr_len;
 
+app_sign_stats_t app_sign_stats;
+
+// Set while a transaction is waiting for the user approval
+static bool sign_review_pending = false;
+
+// Ticker events an approved batch waits for its signatures to be fetched (about 10 s)
+#define SIGN_BATCH_FETCH_TICKS 100
+
+// Approved batch, signatures are computed as they are fetched
+typedef struct {
+    bool approved;
+    // tick of the approval, the key is cleared SIGN_BATCH_FETCH_TICKS later
+    uint32_t approve_tick;
+    // path reviewed by the user, only its staged key signs the batch
+    uint32_t path[HDPATH_LEN_DEFAULT];
+    // bit i is set once the signature of transaction i was returned
+    uint32_t fetched;
+} sign_batch_t;
+
+static sign_batch_t sign_batch;
+
+void app_sign_review_start() {
+    crypto_clear_signing_key();
+    MEMZERO(&sign_batch, sizeof(sign_batch));
+    sign_review_pending = true;
+    app_sign_stats.review_start_tick = app_sign_stats.ticks;
+}
+
+void app_sign_review_end() {
+    sign_review_pending = false;
+    crypto_clear_signing_key();
+    MEMZERO(&sign_batch, sizeof(sign_batch));
+}
+
+void app_sign_tick() {
+    app_sign_stats.ticks++;
+
+    if (sign_batch.approved &&
+        app_sign_stats.ticks - sign_batch.approve_tick >= SIGN_BATCH_FETCH_TICKS) {
+        app_sign_review_end();
+        return;
+    }
+
+    if (!sign_review_pending || crypto_signing_key_staged(hdPath)) {
+        return;
+    }
+
+    // The device is idle while the user reviews, derive the key now
+    crypto_stage_signing_key(hdPath);
+    app_sign_stats.last_stage_ticks = app_sign_stats.ticks - app_sign_stats.review_start_tick;
+}
+
 void app_sign() {
     uint8_t *signature = G_io_apdu_buffer;
 
-    const uint8_t *message = tx_get_buffer() + CRYPTO_BLOB_SKIP_BYTES;
-    const uint16_t messageLength = tx_get_buffer_length() - CRYPTO_BLOB_SKIP_BYTES;
+    sign_review_pending = false;
+    app_sign_stats.last_review_ticks = app_sign_stats.ticks - app_sign_stats.review_start_tick;
+    if (crypto_signing_key_staged(hdPath)) {
+        app_sign_stats.staged_signatures++;
+    } else {
+        app_sign_stats.unstaged_signatures++;
+    }
+
+    if (tx_batch_active()) {
+        // Pin the approved path, later instructions may change hdPath. Its key stays staged
+        // until all signatures were fetched.
+        MEMCPY(sign_batch.path, hdPath, sizeof(sign_batch.path));
+        crypto_stage_signing_key(sign_batch.path);
+        if (!crypto_signing_key_staged(sign_batch.path)) {
+            MEMZERO(&sign_batch, sizeof(sign_batch));
+            set_code(G_io_apdu_buffer, 0, APDU_CODE_SIGN_VERIFY_ERROR);
+            io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, 2);
+            return;
+        }
+        sign_batch.approved = true;
+        sign_batch.approve_tick = app_sign_stats.ticks;
+        sign_batch.fetched = 0;
+
+        G_io_apdu_buffer[0] = tx_batch_count();
+        set_code(G_io_apdu_buffer, 1, APDU_CODE_OK);
+        io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, 3);
+        return;
+    }
+
+    // The digest was computed while the transaction was received
+    const uint8_t *digest = tx_get_digest();
+    if (digest == NULL) {
+        set_code(G_io_apdu_buffer, 0, APDU_CODE_SIGN_VERIFY_ERROR);
+        io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, 2);
+        return;
+    }
 
     const uint8_t replyLen =
-        crypto_sign(signature, IO_APDU_BUFFER_SIZE - 3, message, messageLength);
+        crypto_sign(signature, IO_APDU_BUFFER_SIZE - 3, digest, CRYPTO_DIGEST_LEN);
     if (replyLen > 0) {
         set_code(G_io_apdu_buffer, replyLen, APDU_CODE_OK);
         io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, replyLen + 2);
@@ -41,6 +127,50 @@ void app_sign() {
     }
 }
 
+void app_sign_batch_interrupt() {
+    if (sign_batch.approved) {
+        app_sign_review_end();
+    }
+}
+
+bool app_sign_batch_approved() {
+    return sign_batch.approved && tx_batch_active() && crypto_signing_key_staged(sign_batch.path);
+}
+
+uint16_t app_sign_batch_fetch(uint8_t *buffer, uint16_t bufferLen, uint8_t start) {
+    const uint8_t numTxs = tx_batch_count();
+    if (!app_sign_batch_approved() || start >= numTxs || bufferLen < 1) {
+        return 0;
+    }
+
+    uint16_t offset = 1;
+    uint8_t count = 0;
+    for (uint8_t i = start; i < numTxs && offset + CRYPTO_SIGNATURE_MAX_LEN < bufferLen; i++) {
+        const uint16_t signatureLen = crypto_sign_with_staged_key(buffer + offset + 1,
+                                                                  CRYPTO_SIGNATURE_MAX_LEN,
+                                                                  tx_batch_get_digest(i),
+                                                                  CRYPTO_DIGEST_LEN);
+        if (signatureLen == 0) {
+            crypto_clear_signing_key();
+            MEMZERO(&sign_batch, sizeof(sign_batch));
+            return 0;
+        }
+        buffer[offset] = (uint8_t) signatureLen;
+        offset += 1 + signatureLen;
+        count++;
+        sign_batch.fetched |= 1u << i;
+    }
+    buffer[0] = count;
+
+    // The key is no longer needed once every signature was returned
+    if (sign_batch.fetched == (UINT32_MAX >> (32u - numTxs))) {
+        crypto_clear_signing_key();
+        MEMZERO(&sign_batch, sizeof(sign_batch));
+    }
+
+    return offset;
+}
+
 void app_set_hrp(char *p) {
     crypto_set_hrp(p);
 }
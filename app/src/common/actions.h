@@ -16,14 +16,65 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "crypto.h"
 #include "tx.h"
 #include "apdu_codes.h"
 #include <os_io_seproxyhal.h>
 #include "coin.h"
 
+// Measures how much signing work is moved out of the approval path
+typedef struct {
+    // ticker events since boot
+    uint32_t ticks;
+    // tick at which the last review started
+    uint32_t review_start_tick;
+    // ticks between the start of the last review and its signing key being staged
+    uint32_t last_stage_ticks;
+    // ticks between the start of the last review and its approval
+    uint32_t last_review_ticks;
+    // signatures that found the key already staged
+    uint16_t staged_signatures;
+    // signatures that had to derive the key after approval
+    uint16_t unstaged_signatures;
+    // 1 if a signing key for hdPath is staged when the stats are read
+    uint32_t key_staged;
+} app_sign_stats_t;
+
+extern app_sign_stats_t app_sign_stats;
+
+/// Called when the user approves a transaction
+/// A batch is not signed here, its number of transactions is returned and the signing key
+/// stays staged for app_sign_batch_fetch
 void app_sign();
 
+/// Called for every instruction that does not fetch batch signatures, the key of an approved
+/// batch is cleared so it does not stay staged when the host stops fetching
+void app_sign_batch_interrupt();
+
+/// Whether the active batch was approved, has signatures left to fetch and the key of the
+/// approved path is still staged
+bool app_sign_batch_approved();
+
+/// Sign the transactions of an approved batch starting at start, as many as fit in buffer
+/// Only the key staged at approval is used, it is never derived again here.
+/// Format: N | N x (SIG_LEN | DER signature)
+/// The signing key is cleared once every signature of the batch was returned, when another
+/// instruction arrives or after a fixed number of ticker events.
+/// \return number of bytes written or 0 on error
+uint16_t app_sign_batch_fetch(uint8_t *buffer, uint16_t bufferLen, uint8_t start);
+
+/// A transaction is being shown for review, signing material can be staged
+void app_sign_review_start();
+
+/// The review was rejected or abandoned (e.g. a new transaction is uploaded), nothing stays
+/// staged and the ticker does not stage the key again
+void app_sign_review_end();
+
+/// Called on every ticker event, stages the signing key while a review is pending and clears
+/// the key of a batch whose signatures were not fetched in time
+void app_sign_tick();
+
 void app_set_hrp(char *p);
 
 extern uint8_t action_addr_len;
@@ -49,6 +100,12 @@ __Z_INLINE void app_reply_address(address_kind_e kind) {
     io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, action_addr_len + 2);
 }
 
+__Z_INLINE void app_reject() {
+    app_sign_review_end();
+    set_code(G_io_apdu_buffer, 0, APDU_CODE_COMMAND_NOT_ALLOWED);
+    io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, 2);
+}
+
 __Z_INLINE void app_reply_error() {
     set_code(G_io_apdu_buffer, 0, APDU_CODE_DATA_INVALID);
     io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, 2);
@@ -51,6 +51,7 @@ unsigned char io_event(unsigned char channel) {
                     UX_REDISPLAY();
                 }
             });
+            app_sign_tick();
             break;
         }
 
@@ -90,26 +91,44 @@ unsigned short io_exchange_al(unsigned char channel, unsigned short tx_len) {
     return 0;
 }
 
+void checkHDPath(const uint32_t *path, uint8_t path_len) {
+    // Check values
+    if (path[0] != HDPATH_0_DEFAULT || path[1] != HDPATH_1_DEFAULT ||
+        path[3] != HDPATH_3_DEFAULT) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+
+    // Limit values unless the app is running in expert mode
+    if (!app_mode_expert()) {
+        for (int i = 2; i < path_len; i++) {
+            // hardened or unhardened values should be below 20
+            if ((path[i] & 0x7FFFFFFF) > 100) THROW(APDU_CODE_CONDITIONS_NOT_SATISFIED);
+        }
+    }
+}
+
 void extractHDPath(uint32_t rx, uint32_t offset) {
     if ((rx - offset) < sizeof(uint32_t) * HDPATH_LEN_DEFAULT) {
         THROW(APDU_CODE_WRONG_LENGTH);
     }
 
     MEMCPY(hdPath, G_io_apdu_buffer + offset, sizeof(uint32_t) * HDPATH_LEN_DEFAULT);
+    checkHDPath(hdPath, HDPATH_LEN_DEFAULT);
+}
 
-    // Check values
-    if (hdPath[0] != HDPATH_0_DEFAULT || hdPath[1] != HDPATH_1_DEFAULT ||
-        hdPath[3] != HDPATH_3_DEFAULT) {
+uint8_t extractHRP(uint32_t rx, uint32_t offset) {
+    if (rx < offset + 1) {
         THROW(APDU_CODE_DATA_INVALID);
     }
+    const uint8_t hrp_len = G_io_apdu_buffer[offset];
 
-    // Limit values unless the app is running in expert mode
-    if (!app_mode_expert()) {
-        for (int i = 2; i < HDPATH_LEN_DEFAULT; i++) {
-            // hardened or unhardened values should be below 20
-            if ((hdPath[i] & 0x7FFFFFFF) > 100) THROW(APDU_CODE_CONDITIONS_NOT_SATISFIED);
-        }
+    if (hrp_len == 0 || hrp_len > MAX_BECH32_HRP_LEN || rx < offset + 1 + hrp_len) {
+        THROW(APDU_CODE_DATA_INVALID);
     }
+
+    crypto_set_hrp_len((const char *) G_io_apdu_buffer + offset + 1, hrp_len);
+
+    return hrp_len;
 }
 
 bool process_chunk(volatile uint32_t *tx, uint32_t rx) {
@@ -126,6 +145,8 @@ bool process_chunk(volatile uint32_t *tx, uint32_t rx) {
     uint32_t added;
     switch (payloadType) {
         case 0:
+            // A new upload abandons the review of the previous transaction
+            app_sign_review_end();
             tx_initialize();
             tx_reset();
             extractHDPath(rx, OFFSET_DATA);
@@ -141,6 +162,7 @@ bool process_chunk(volatile uint32_t *tx, uint32_t rx) {
             if (added != rx - OFFSET_DATA) {
                 THROW(APDU_CODE_OUTPUT_BUFFER_TOO_SMALL);
             }
+            tx_digest_finalize();
             return true;
     }
 
@@ -184,6 +206,7 @@ void app_init() {
     USB_power(1);
 
     app_mode_reset();
+    crypto_clear_address_cache();
     if (app_mode_expert()) {
         view_idle_show(1);
     }
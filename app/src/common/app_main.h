@@ -33,16 +33,29 @@
 
 #define OFFSET_PAYLOAD_TYPE OFFSET_P1
 
+// INS_SIGN_BATCH payload type that fetches signatures after the approval
+#define PAYLOAD_TYPE_FETCH 3
+
 #define INS_GET_VERSION        0x00
 #define INS_SIGN_SECP256K1     0x02
 #define INS_GET_ADDR_SECP256K1 0x04
+#define INS_GET_ADDR_BATCH     0x06
+#define INS_SIGN_BATCH         0x08
+#define INS_GET_SIGN_STATS     0x7F  // only with APP_SIGN_STATS
 
 void app_init();
 
 void app_main();
 
+/// Throws if the path is not allowed, path must have at least 4 elements
+void checkHDPath(const uint32_t *path, uint8_t path_len);
+
 void extractHDPath(uint32_t rx, uint32_t offset);
 
+/// Reads HRP_LEN | HRP at offset and makes it the current HRP
+/// \return HRP length
+uint8_t extractHRP(uint32_t rx, uint32_t offset);
+
 bool process_chunk(volatile uint32_t *tx, uint32_t rx);
 
 void handleApdu(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx);
@@ -23,6 +23,7 @@ extern "C" {
 #include "parser_impl.h"
 #include "hexutils.h"
 #include "crypto.h"
+#include "tx_summary.h"
 
 const char *parser_getErrorDescription(parser_error_t err);
 
@@ -33,7 +34,15 @@ parser_error_t parser_parse(parser_context_t *ctx, const uint8_t *data, size_t d
 parser_error_t parser_validate(const parser_context_t *ctx);
 
 //// returns the number of items in the current parsing context
-parser_error_t parser_getNumItems(const parser_context_t *ctx, uint8_t *num_items);
+parser_error_t parser_getNumItems(const parser_context_t *ctx, uint16_t *num_items);
+
+//// returns the number of messages that can be jumped to
+parser_error_t parser_getNumMsgs(const parser_context_t *ctx, uint16_t *num_msgs);
+
+//// returns the display index of the first item of a message, logarithmic in the number of items
+parser_error_t parser_getMsgFirstItem(const parser_context_t *ctx,
+                                      uint16_t msg_idx,
+                                      uint16_t *display_idx);
 
 // retrieves a readable output for each field / page
 parser_error_t parser_getItem(const parser_context_t *ctx,
@@ -45,6 +54,21 @@ parser_error_t parser_getItem(const parser_context_t *ctx,
                               uint8_t pageIdx,
                               uint8_t *pageCount);
 
+/// Number of items of an aggregated summary
+parser_error_t parser_getSummaryNumItems(const tx_summary_t *summary, uint16_t *num_items);
+
+/// Readable output for each item / page of an aggregated summary
+/// Items: Transactions and Chain ID (batches only), Messages, Total per asset, Fee per asset
+/// and one per destination or root memo
+parser_error_t parser_getSummaryItem(const tx_summary_t *summary,
+                                     uint16_t displayIdx,
+                                     char *outKey,
+                                     uint16_t outKeyLen,
+                                     char *outValue,
+                                     uint16_t outValueLen,
+                                     uint8_t pageIdx,
+                                     uint8_t *pageCount);
+
 #ifdef __cplusplus
 }
 #endif
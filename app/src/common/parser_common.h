@@ -57,6 +57,9 @@ typedef enum {
     parser_json_too_many_tokens,  // "NOMEM: JSON string contains too many tokens"
     parser_json_incomplete_json,  // "JSON string is not complete";
     parser_json_contains_whitespace,
+    parser_json_contains_control_char,
+    parser_json_invalid_utf8,
+    parser_json_invalid_escape,
     parser_json_is_not_sorted,
     parser_json_missing_chain_id,
     parser_json_missing_sequence,
@@ -69,8 +72,8 @@ typedef enum {
 
 typedef struct {
     const uint8_t *buffer;
-    uint16_t bufferLen;
-    uint16_t offset;
+    uint32_t bufferLen;
+    uint32_t offset;
 } parser_context_t;
 
 #ifdef __cplusplus
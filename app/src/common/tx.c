@@ -18,8 +18,10 @@
 #include "apdu_codes.h"
 #include "buffering.h"
 #include "parser.h"
+#include "tx_display.h"
 #include <string.h>
 #include "zxmacros.h"
+#include "cx.h"
 
 #if defined(TARGET_NANOX) || defined(TARGET_NANOS2)
 #define RAM_BUFFER_SIZE   8192
@@ -27,6 +29,14 @@
 #elif defined(TARGET_NANOS)
 #define RAM_BUFFER_SIZE   256
 #define FLASH_BUFFER_SIZE 8192
+#else
+// Host builds (simulator), sizes can be overridden to emulate a device
+#ifndef RAM_BUFFER_SIZE
+#define RAM_BUFFER_SIZE 8192
+#endif
+#ifndef FLASH_BUFFER_SIZE
+#define FLASH_BUFFER_SIZE 16384
+#endif
 #endif
 
 // Ram
@@ -44,20 +54,108 @@ storage_t N_appdata_impl __attribute__((aligned(64)));
 #elif defined(TARGET_NANOX) || defined(TARGET_NANOS2)
 storage_t const N_appdata_impl __attribute__((aligned(64)));
 #define N_appdata (*(volatile storage_t *) PIC(&N_appdata_impl))
+
+#else
+// Flash is emulated in RAM
+storage_t N_appdata_impl;
+#define N_appdata N_appdata_impl
 #endif
 
 parser_context_t ctx_parsed_tx;
 
+// Running hash of the signed blob, updated as chunks arrive
+typedef struct {
+    cx_sha256_t ctx;
+    uint8_t digest[CX_SHA256_SIZE];
+    bool ready;
+    // data was appended after the digest was completed
+    bool stale;
+} tx_digest_t;
+
+tx_digest_t tx_digest;
+
+// One digest per transaction stays in RAM until the batch is signed
+#if defined(TARGET_NANOS)
+#define TX_BATCH_MAX_TXS 4
+#else
+#define TX_BATCH_MAX_TXS 32
+#endif
+
+// Several transactions signed after a single review
+// The buffer holds one record per transaction: LEN (2 bytes, big endian) | JSON
+typedef struct {
+    bool active;
+    uint8_t num_txs;
+    uint8_t digests[TX_BATCH_MAX_TXS][CX_SHA256_SIZE];
+    // held from the display while the batch is parsed or active
+    tx_summary_t *summary;
+} tx_batch_t;
+
+tx_batch_t tx_batch;
+
+// The summary storage goes back to the display of single transactions
+static void tx_batch_release() {
+    tx_batch.active = false;
+    tx_batch.num_txs = 0;
+    if (tx_batch.summary != NULL) {
+        tx_display_releaseSummary();
+        tx_batch.summary = NULL;
+    }
+}
+
 void tx_initialize() {
     buffering_init(ram_buffer, sizeof(ram_buffer), N_appdata.buffer, sizeof(N_appdata.buffer));
 }
 
 void tx_reset() {
     buffering_reset();
+
+    MEMZERO(&tx_digest, sizeof(tx_digest));
+    cx_sha256_init(&tx_digest.ctx);
+
+    tx_batch_release();
 }
 
 uint32_t tx_append(unsigned char *buffer, uint32_t length) {
-    return buffering_append(buffer, length);
+    const uint32_t prev_length = tx_get_buffer_length();
+    const uint32_t added = buffering_append(buffer, length);
+    if (added != length) {
+        return added;
+    }
+    if (tx_digest.ready) {
+        tx_digest.stale = true;
+        return added;
+    }
+
+    // Hash the new data, skipping the bytes that are not part of the signed blob
+    uint32_t skip = 0;
+#if CRYPTO_BLOB_SKIP_BYTES > 0
+    if (prev_length < CRYPTO_BLOB_SKIP_BYTES) {
+        skip = CRYPTO_BLOB_SKIP_BYTES - prev_length;
+    }
+#else
+    (void) prev_length;
+#endif
+    if (skip < added) {
+        cx_hash(&tx_digest.ctx.header, 0, buffer + skip, added - skip, NULL, 0);
+    }
+
+    return added;
+}
+
+void tx_digest_finalize() {
+    if (tx_digest.ready) {
+        return;
+    }
+    cx_hash(&tx_digest.ctx.header, CX_LAST, NULL, 0, tx_digest.digest, CX_SHA256_SIZE);
+    tx_digest.ready = true;
+}
+
+const uint8_t *tx_get_digest() {
+    if (!tx_digest.ready || tx_digest.stale) {
+        return NULL;
+    }
+    return tx_digest.digest;
 }
 
 uint32_t tx_get_buffer_length() {
@@ -69,6 +167,8 @@ uint8_t *tx_get_buffer() {
 }
 
 const char *tx_parse() {
+    tx_batch_release();
+
     uint8_t err = parser_parse(&ctx_parsed_tx, tx_get_buffer(), tx_get_buffer_length());
 
     if (err != parser_ok) {
@@ -85,8 +185,77 @@ const char *tx_parse() {
     return NULL;
 }
 
-tx_error_t tx_getNumItems(uint8_t *num_items) {
-    parser_error_t err = parser_getNumItems(&ctx_parsed_tx, num_items);
+static parser_error_t tx_batch_parse_records() {
+    const uint8_t *data = tx_get_buffer();
+    const uint32_t dataLen = tx_get_buffer_length();
+
+    uint32_t offset = 0;
+    while (offset < dataLen) {
+        if (tx_batch.num_txs >= TX_BATCH_MAX_TXS) {
+            return parser_value_out_of_range;
+        }
+        if (dataLen - offset < 2) {
+            return parser_unexpected_buffer_end;
+        }
+        const uint16_t recordLen = (uint16_t)((data[offset] << 8u) | data[offset + 1]);
+        offset += 2;
+        if (recordLen == 0 || recordLen > dataLen - offset) {
+            return parser_unexpected_buffer_end;
+        }
+        const uint8_t *record = data + offset;
+
+        // Every transaction gets the same checks as a single one
+        CHECK_PARSER_ERR(parser_parse(&ctx_parsed_tx, record, recordLen))
+        CHECK_PARSER_ERR(parser_validate(&ctx_parsed_tx))
+        CHECK_PARSER_ERR(tx_summary_add_tx(tx_batch.summary, &parser_tx_obj.json))
+
+        cx_hash_sha256(record, recordLen, tx_batch.digests[tx_batch.num_txs], CX_SHA256_SIZE);
+        tx_batch.num_txs++;
+        offset += recordLen;
+    }
+
+    if (tx_batch.num_txs == 0) {
+        return parser_no_data;
+    }
+    return parser_ok;
+}
+
+const char *tx_batch_parse() {
+    tx_batch_release();
+    tx_batch.summary = tx_display_holdSummary();
+
+    const parser_error_t err = tx_batch_parse_records();
+    if (err != parser_ok) {
+        tx_batch_release();
+        return parser_getErrorDescription(err);
+    }
+
+    tx_batch.active = true;
+    return NULL;
+}
+
+bool tx_batch_active() {
+    return tx_batch.active;
+}
+
+uint8_t tx_batch_count() {
+    return tx_batch.active ? tx_batch.num_txs : 0;
+}
+
+const uint8_t *tx_batch_get_digest(uint8_t index) {
+    if (!tx_batch.active || index >= tx_batch.num_txs) {
+        return NULL;
+    }
+    return tx_batch.digests[index];
+}
+
+tx_error_t tx_getNumItems(uint16_t *num_items) {
+    parser_error_t err;
+    if (tx_batch.active) {
+        err = parser_getSummaryNumItems(tx_batch.summary, num_items);
+    } else {
+        err = parser_getNumItems(&ctx_parsed_tx, num_items);
+    }
 
     if (err != parser_ok) {
         return tx_no_data;
@@ -95,7 +264,29 @@ tx_error_t tx_getNumItems(uint8_t *num_items) {
     return tx_no_error;
 }
 
-tx_error_t tx_getItem(uint8_t displayIdx,
+tx_error_t tx_getNumMsgs(uint16_t *num_msgs) {
+    *num_msgs = 0;
+    // Batches only show the summary
+    if (tx_batch.active) {
+        return tx_no_error;
+    }
+    if (parser_getNumMsgs(&ctx_parsed_tx, num_msgs) != parser_ok) {
+        return tx_no_data;
+    }
+    return tx_no_error;
+}
+
+tx_error_t tx_getMsgFirstItem(uint16_t msgIdx, uint16_t *displayIdx) {
+    if (tx_batch.active) {
+        return tx_no_data;
+    }
+    if (parser_getMsgFirstItem(&ctx_parsed_tx, msgIdx, displayIdx) != parser_ok) {
+        return tx_no_data;
+    }
+    return tx_no_error;
+}
+
+tx_error_t tx_getItem(uint16_t displayIdx,
                       char *outKey,
                       uint16_t outKeyLen,
                       char *outVal,
@@ -104,7 +295,7 @@ tx_error_t tx_getItem(uint8_t displayIdx,
                       uint8_t *pageCount) {
     tx_error_t err = tx_no_error;
 
-    uint8_t numItems = 0;
+    uint16_t numItems = 0;
     err = tx_getNumItems(&numItems);
     if (err != tx_no_error) {
         return err;
@@ -114,14 +305,25 @@ tx_error_t tx_getItem(uint8_t displayIdx,
         return tx_no_data;
     }
 
-    err = (tx_error_t) parser_getItem(&ctx_parsed_tx,
-                                      displayIdx,
-                                      outKey,
-                                      outKeyLen,
-                                      outVal,
-                                      outValLen,
-                                      pageIdx,
-                                      pageCount);
+    if (tx_batch.active) {
+        err = (tx_error_t) parser_getSummaryItem(tx_batch.summary,
+                                                 displayIdx,
+                                                 outKey,
+                                                 outKeyLen,
+                                                 outVal,
+                                                 outValLen,
+                                                 pageIdx,
+                                                 pageCount);
+    } else {
+        err = (tx_error_t) parser_getItem(&ctx_parsed_tx,
+                                          displayIdx,
+                                          outKey,
+                                          outKeyLen,
+                                          outVal,
+                                          outValLen,
+                                          pageIdx,
+                                          pageCount);
+    }
 
     // Convert error codes
     if (err == parser_no_data || err == parser_display_idx_out_of_range ||
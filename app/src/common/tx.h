@@ -15,6 +15,7 @@
  ********************************************************************************/
 #pragma once
 
+#include <stdbool.h>
 #include "os.h"
 #include "coin.h"
 
@@ -35,6 +36,14 @@ void tx_reset();
 /// \return It returns an error message if the buffer is too small.
 uint32_t tx_append(unsigned char *buffer, uint32_t length);
 
+/// Completes the SHA-256 of the transaction blob that was computed while appending
+/// This function should be called after the last chunk was appended.
+void tx_digest_finalize();
+
+/// Returns the SHA-256 of the transaction blob
+/// \return NULL if tx_digest_finalize was not called after the last append
+const uint8_t *tx_get_digest();
+
 /// Returns size of the raw json transaction buffer
 /// \return
 uint32_t tx_get_buffer_length();
@@ -48,11 +57,33 @@ uint8_t *tx_get_buffer();
 /// \return It returns NULL if json is valid or error message otherwise.
 const char *tx_parse();
 
+/// Parse a batch of transactions stored in the transaction buffer
+/// Records are LEN (2 bytes, big endian) | JSON, each one is parsed and validated
+/// like a single transaction. Items then show an aggregated summary of the batch.
+/// \return It returns NULL if all transactions are valid or error message otherwise.
+const char *tx_batch_parse();
+
+/// Whether the buffer holds a successfully parsed batch
+bool tx_batch_active();
+
+/// Number of transactions in the active batch
+uint8_t tx_batch_count();
+
+/// Returns the SHA-256 of a transaction of the active batch
+/// \return NULL if there is no active batch or index is out of range
+const uint8_t *tx_batch_get_digest(uint8_t index);
+
 /// Return the number of items in the transaction
-tx_error_t tx_getNumItems(uint8_t *num_items);
+tx_error_t tx_getNumItems(uint16_t *num_items);
+
+/// Return the number of messages in the transaction
+tx_error_t tx_getNumMsgs(uint16_t *num_msgs);
+
+/// Return the display index of the first item of a message, e.g. to jump to it
+tx_error_t tx_getMsgFirstItem(uint16_t msgIdx, uint16_t *displayIdx);
 
 /// Gets an specific item from the transaction (including paging)
-tx_error_t tx_getItem(uint8_t displayIdx,
+tx_error_t tx_getItem(uint16_t displayIdx,
                       char *outKey,
                       uint16_t outKeyLen,
                       char *outValue,
@@ -21,14 +21,116 @@
 
 #include <bech32.h>
 
+#define RIPEMD160_LEN 20u
+
 uint32_t hdPath[HDPATH_LEN_DEFAULT];
 
 uint8_t bech32_hrp_len;
 char bech32_hrp[MAX_BECH32_HRP_LEN + 1];
 
+// Recently derived addresses, valid for the current HRP only
+#if defined(TARGET_NANOS)
+#define ADDR_CACHE_SIZE 1
+#else
+#define ADDR_CACHE_SIZE 4
+#endif
+
+// Longer addresses (i.e. very long HRPs) are not cached
+#define ADDR_CACHE_MAX_ADDR_LEN 64
+
+typedef struct {
+    uint32_t path[HDPATH_LEN_DEFAULT];
+    uint8_t pubKey[PK_LEN_SECP256K1];
+    char addr[ADDR_CACHE_MAX_ADDR_LEN + 1];
+    bool valid;
+} addr_cache_entry_t;
+
+typedef struct {
+    addr_cache_entry_t entries[ADDR_CACHE_SIZE];
+    uint8_t next_entry;
+} addr_cache_t;
+
+addr_cache_t addr_cache;
+
+void crypto_clear_address_cache() {
+    MEMZERO(&addr_cache, sizeof(addr_cache));
+}
+
+__Z_INLINE const addr_cache_entry_t *addr_cache_find(const uint32_t path[HDPATH_LEN_DEFAULT]) {
+    for (uint8_t i = 0; i < ADDR_CACHE_SIZE; i++) {
+        const addr_cache_entry_t *entry = &addr_cache.entries[i];
+        // The HRP is part of the key, the address starts with it
+        if (entry->valid && MEMCMP(entry->path, path, sizeof(entry->path)) == 0 &&
+            strncmp(entry->addr, bech32_hrp, bech32_hrp_len) == 0 &&
+            entry->addr[bech32_hrp_len] == '1') {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+__Z_INLINE void addr_cache_insert(const uint32_t path[HDPATH_LEN_DEFAULT],
+                                  const uint8_t *pubKey,
+                                  const char *addr) {
+    const size_t addr_len = strlen(addr);
+    if (addr_len > ADDR_CACHE_MAX_ADDR_LEN) {
+        return;
+    }
+
+    addr_cache_entry_t *entry = &addr_cache.entries[addr_cache.next_entry];
+    MEMCPY(entry->path, path, sizeof(entry->path));
+    MEMCPY(entry->pubKey, pubKey, PK_LEN_SECP256K1);
+    MEMCPY(entry->addr, addr, addr_len + 1);
+    entry->valid = true;
+
+    addr_cache.next_entry = (addr_cache.next_entry + 1) % ADDR_CACHE_SIZE;
+}
+
+void crypto_set_hrp_len(const char *hrp, uint8_t hrp_len) {
+    if (hrp_len > MAX_BECH32_HRP_LEN) {
+        return;
+    }
+
+    // Cached addresses belong to the previous HRP
+    if (hrp_len != bech32_hrp_len || MEMCMP(bech32_hrp, hrp, hrp_len) != 0) {
+        crypto_clear_address_cache();
+    }
+
+    MEMZERO(bech32_hrp, sizeof(bech32_hrp));
+    MEMCPY(bech32_hrp, hrp, hrp_len);
+    bech32_hrp_len = hrp_len;
+}
+
+// Account node (path without the address index) used to derive batches of addresses
+typedef struct {
+    uint32_t path[HDPATH_LEN_DEFAULT - 1];
+    // uncompressed public key
+    uint8_t publicKey[65];
+    uint8_t chainCode[32];
+    bool valid;
+} xpub_cache_t;
+
+xpub_cache_t xpub_cache;
+
+__Z_INLINE void compress_pubkey(const uint8_t *W, uint8_t *pubKey) {
+    pubKey[0] = W[64] & 1 ? 0x03 : 0x02;
+    MEMCPY(pubKey + 1, W + 1, 32);
+}
+
 #if defined(TARGET_NANOS) || defined(TARGET_NANOX) || defined(TARGET_NANOS2)
 #include "cx.h"
 
+__Z_INLINE void hash_sha256(const uint8_t *in, uint16_t inLen, uint8_t *out) {
+    cx_hash_sha256(in, inLen, out, CX_SHA256_SIZE);
+}
+
+void ripemd160_32(uint8_t *out, uint8_t *in) {
+    cx_ripemd160_t rip160;
+    cx_ripemd160_init(&rip160);
+    cx_hash(&rip160.header, CX_LAST, in, CX_SHA256_SIZE, out, CX_RIPEMD160_SIZE);
+}
+
+
 void crypto_extractPublicKey(const uint32_t path[HDPATH_LEN_DEFAULT],
                              uint8_t *pubKey,
                              uint16_t pubKeyLen) {
@@ -72,44 +174,151 @@ void crypto_extractPublicKey(const uint32_t path[HDPATH_LEN_DEFAULT],
     MEMCPY(pubKey, cx_publicKey.W, PK_LEN_SECP256K1);
 }
 
-uint16_t crypto_sign(uint8_t *signature,
-                     uint16_t signatureMaxlen,
-                     const uint8_t *message,
-                     uint16_t messageLen) {
-    uint8_t messageDigest[CX_SHA256_SIZE];
+static const uint8_t secp256k1_order[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFE, 0xBA, 0xAE, 0xDC, 0xE6, 0xAF, 0x48,
+    0xA0, 0x3B, 0xBF, 0xD2, 0x5E, 0x8C, 0xD0, 0x36, 0x41, 0x41,
+};
 
-    // Hash it
-    cx_hash_sha256(message, messageLen, messageDigest, CX_SHA256_SIZE);
+void crypto_load_xpub(const uint32_t basePath[HDPATH_LEN_DEFAULT - 1]) {
+    if (xpub_cache.valid && MEMCMP(xpub_cache.path, basePath, sizeof(xpub_cache.path)) == 0) {
+        return;
+    }
+    MEMZERO(&xpub_cache, sizeof(xpub_cache));
 
+    cx_ecfp_public_key_t cx_publicKey;
     cx_ecfp_private_key_t cx_privateKey;
     uint8_t privateKeyData[32];
-    int signatureLength = 0;
-    unsigned int info = 0;
 
     BEGIN_TRY {
         TRY {
-            // Generate keys
             os_perso_derive_node_bip32(CX_CURVE_256K1,
-                                       hdPath,
+                                       basePath,
+                                       HDPATH_LEN_DEFAULT - 1,
+                                       privateKeyData,
+                                       xpub_cache.chainCode);
+
+            cx_ecfp_init_private_key(CX_CURVE_256K1, privateKeyData, 32, &cx_privateKey);
+            cx_ecfp_init_public_key(CX_CURVE_256K1, NULL, 0, &cx_publicKey);
+            cx_ecfp_generate_pair(CX_CURVE_256K1, &cx_publicKey, &cx_privateKey, 1);
+        }
+        FINALLY {
+            MEMZERO(&cx_privateKey, sizeof(cx_privateKey));
+            MEMZERO(privateKeyData, 32);
+        }
+    }
+    END_TRY;
+
+    MEMCPY(xpub_cache.publicKey, cx_publicKey.W, sizeof(xpub_cache.publicKey));
+    MEMCPY(xpub_cache.path, basePath, sizeof(xpub_cache.path));
+    xpub_cache.valid = true;
+}
+
+__Z_INLINE void bip32_hmac_sha512(const uint8_t *key,
+                                  uint16_t keyLen,
+                                  const uint8_t *in,
+                                  uint16_t inLen,
+                                  uint8_t *out) {
+    cx_hmac_sha512(key, keyLen, in, inLen, out, 64);
+}
+
+// child = parent + tweak * G, all points uncompressed
+__Z_INLINE bool bip32_add_tweak(const uint8_t *parent, const uint8_t *tweak, uint8_t *child) {
+    if (cx_math_cmp((uint8_t *) tweak, (uint8_t *) PIC(secp256k1_order), 32) >= 0 ||
+        cx_math_is_zero((uint8_t *) tweak, 32)) {
+        return false;
+    }
+
+    cx_ecfp_public_key_t cx_tweakPoint;
+    cx_ecfp_private_key_t cx_tweak;
+    cx_ecfp_init_private_key(CX_CURVE_256K1, tweak, 32, &cx_tweak);
+    cx_ecfp_init_public_key(CX_CURVE_256K1, NULL, 0, &cx_tweakPoint);
+    cx_ecfp_generate_pair(CX_CURVE_256K1, &cx_tweakPoint, &cx_tweak, 1);
+    MEMZERO(&cx_tweak, sizeof(cx_tweak));
+
+    // The last argument is the length of one coordinate, points are 1 + 2 * 32 bytes
+    return cx_ecfp_add_point(CX_CURVE_256K1, child, cx_tweakPoint.W, parent, 32) != 0;
+}
+
+typedef struct {
+    cx_ecfp_private_key_t privateKey;
+    // path the key was derived for
+    uint32_t path[HDPATH_LEN_DEFAULT];
+    bool ready;
+} staged_key_t;
+
+staged_key_t staged_key;
+
+void crypto_clear_signing_key() {
+    MEMZERO(&staged_key, sizeof(staged_key));
+}
+
+bool crypto_signing_key_staged(const uint32_t path[HDPATH_LEN_DEFAULT]) {
+    return staged_key.ready && MEMCMP(staged_key.path, path, sizeof(staged_key.path)) == 0;
+}
+
+void crypto_stage_signing_key(const uint32_t path[HDPATH_LEN_DEFAULT]) {
+    if (crypto_signing_key_staged(path)) {
+        return;
+    }
+    crypto_clear_signing_key();
+
+    uint8_t privateKeyData[32];
+
+    BEGIN_TRY {
+        TRY {
+            os_perso_derive_node_bip32(CX_CURVE_256K1,
+                                       path,
                                        HDPATH_LEN_DEFAULT,
                                        privateKeyData,
                                        NULL);
 
-            cx_ecfp_init_private_key(CX_CURVE_256K1, privateKeyData, 32, &cx_privateKey);
+            cx_ecfp_init_private_key(CX_CURVE_256K1, privateKeyData, 32, &staged_key.privateKey);
+            MEMCPY(staged_key.path, path, sizeof(staged_key.path));
+            staged_key.ready = true;
+        }
+        CATCH_OTHER(e) {
+            crypto_clear_signing_key();
+        }
+        FINALLY {
+            MEMZERO(privateKeyData, 32);
+        }
+    }
+    END_TRY;
+}
+
+uint16_t crypto_sign_with_staged_key(uint8_t *signature,
+                                     uint16_t signatureMaxlen,
+                                     const uint8_t *digest,
+                                     uint16_t digestLen) {
+    if (digestLen != CX_SHA256_SIZE) {
+        return 0;
+    }
+
+    int signatureLength = 0;
+    unsigned int info = 0;
+
+    BEGIN_TRY {
+        TRY {
+            if (!staged_key.ready) {
+                THROW(APDU_CODE_EXECUTION_ERROR);
+            }
 
             // Sign
-            signatureLength = cx_ecdsa_sign(&cx_privateKey,
+            signatureLength = cx_ecdsa_sign(&staged_key.privateKey,
                                             CX_RND_RFC6979 | CX_LAST,
                                             CX_SHA256,
-                                            messageDigest,
+                                            digest,
                                             CX_SHA256_SIZE,
                                             signature,
                                             signatureMaxlen,
                                             &info);
         }
+        CATCH_OTHER(e) {
+            signatureLength = 0;
+            crypto_clear_signing_key();
+        }
         FINALLY {
-            MEMZERO(&cx_privateKey, sizeof(cx_privateKey));
-            MEMZERO(privateKeyData, 32);
         }
     }
     END_TRY;
@@ -118,81 +327,279 @@ uint16_t crypto_sign(uint8_t *signature,
 }
 
 #else
+#include "host/bip32.h"
+#include "host/ripemd160.h"
+#include "host/secp256k1.h"
+#include "host/sha2.h"
+
+///////////////////////////////////////
+// Software backend for tests, simulation and benchmarks. Keys come from a test mnemonic.
+///////////////////////////////////////
+
+__Z_INLINE void hash_sha256(const uint8_t *in, uint16_t inLen, uint8_t *out) {
+    sw_sha256(in, inLen, out);
+}
+
+void ripemd160_32(uint8_t *out, uint8_t *in) {
+    sw_ripemd160(in, CRYPTO_DIGEST_LEN, out);
+}
+
+typedef struct {
+    uint8_t seed[SW_BIP39_SEED_SIZE];
+    bool ready;
+} host_seed_t;
+
+host_seed_t host_seed;
+
+void crypto_host_set_mnemonic(const char *mnemonic) {
+    MEMZERO(&host_seed, sizeof(host_seed));
+    sw_bip39_mnemonic_to_seed(mnemonic, host_seed.seed);
+    host_seed.ready = true;
+
+    // Everything derived from the previous seed is stale
+    crypto_clear_address_cache();
+    crypto_clear_signing_key();
+    MEMZERO(&xpub_cache, sizeof(xpub_cache));
+}
+
+__Z_INLINE bool host_derive_node(const uint32_t *path, uint8_t pathLen, sw_bip32_node_t *node) {
+    if (!host_seed.ready) {
+        crypto_host_set_mnemonic(CRYPTO_HOST_DEFAULT_MNEMONIC);
+    }
+    return sw_bip32_derive_path(host_seed.seed, path, pathLen, node);
+}
 
 void crypto_extractPublicKey(const uint32_t path[HDPATH_LEN_DEFAULT],
                              uint8_t *pubKey,
                              uint16_t pubKeyLen) {
-    ///////////////////////////////////////
-    // THIS IS ONLY USED FOR TEST PURPOSES
-    ///////////////////////////////////////
+    if (pubKeyLen < PK_LEN_SECP256K1) {
+        return;
+    }
 
-    // Empty version for non-Ledger devices
-    MEMZERO(pubKey, pubKeyLen);
+    sw_bip32_node_t node;
+    uint8_t publicKey[SW_SECP256K1_POINT_SIZE];
+    if (!host_derive_node(path, HDPATH_LEN_DEFAULT, &node) ||
+        !sw_secp256k1_pubkey_create(node.privateKey, publicKey)) {
+        MEMZERO(pubKey, pubKeyLen);
+    } else {
+        compress_pubkey(publicKey, pubKey);
+    }
+    MEMZERO(&node, sizeof(node));
 }
 
-uint16_t crypto_sign(uint8_t *signature,
-                     uint16_t signatureMaxlen,
-                     const uint8_t *message,
-                     uint16_t messageLen) {
-    // Empty version for non-Ledger devices
-    return 0;
+void crypto_load_xpub(const uint32_t basePath[HDPATH_LEN_DEFAULT - 1]) {
+    if (xpub_cache.valid && MEMCMP(xpub_cache.path, basePath, sizeof(xpub_cache.path)) == 0) {
+        return;
+    }
+    MEMZERO(&xpub_cache, sizeof(xpub_cache));
+
+    sw_bip32_node_t node;
+    if (host_derive_node(basePath, HDPATH_LEN_DEFAULT - 1, &node) &&
+        sw_secp256k1_pubkey_create(node.privateKey, xpub_cache.publicKey)) {
+        MEMCPY(xpub_cache.chainCode, node.chainCode, sizeof(xpub_cache.chainCode));
+        MEMCPY(xpub_cache.path, basePath, sizeof(xpub_cache.path));
+        xpub_cache.valid = true;
+    }
+    MEMZERO(&node, sizeof(node));
 }
 
-#endif
+__Z_INLINE void bip32_hmac_sha512(const uint8_t *key,
+                                  uint16_t keyLen,
+                                  const uint8_t *in,
+                                  uint16_t inLen,
+                                  uint8_t *out) {
+    sw_hmac_sha512(key, keyLen, in, inLen, out);
+}
+
+// child = parent + tweak * G, all points uncompressed
+__Z_INLINE bool bip32_add_tweak(const uint8_t *parent, const uint8_t *tweak, uint8_t *child) {
+    uint8_t tweakPoint[SW_SECP256K1_POINT_SIZE];
+    return sw_secp256k1_scalar_is_valid(tweak) && sw_secp256k1_pubkey_create(tweak, tweakPoint) &&
+           sw_secp256k1_point_add(parent, tweakPoint, child);
+}
+
+typedef struct {
+    uint8_t privateKey[SW_SECP256K1_SCALAR_SIZE];
+    // path the key was derived for
+    uint32_t path[HDPATH_LEN_DEFAULT];
+    bool ready;
+} staged_key_t;
+
+staged_key_t staged_key;
+
+void crypto_clear_signing_key() {
+    MEMZERO(&staged_key, sizeof(staged_key));
+}
+
+bool crypto_signing_key_staged(const uint32_t path[HDPATH_LEN_DEFAULT]) {
+    return staged_key.ready && MEMCMP(staged_key.path, path, sizeof(staged_key.path)) == 0;
+}
+
+void crypto_stage_signing_key(const uint32_t path[HDPATH_LEN_DEFAULT]) {
+    if (crypto_signing_key_staged(path)) {
+        return;
+    }
+    crypto_clear_signing_key();
 
-uint8_t extractHRP(uint32_t rx, uint32_t offset) {
-    if (rx < offset + 1) {
-        THROW(APDU_CODE_DATA_INVALID);
+    sw_bip32_node_t node;
+    if (host_derive_node(path, HDPATH_LEN_DEFAULT, &node)) {
+        MEMCPY(staged_key.privateKey, node.privateKey, sizeof(staged_key.privateKey));
+        MEMCPY(staged_key.path, path, sizeof(staged_key.path));
+        staged_key.ready = true;
     }
-    MEMZERO(bech32_hrp, MAX_BECH32_HRP_LEN);
+    MEMZERO(&node, sizeof(node));
+}
 
-    bech32_hrp_len = G_io_apdu_buffer[offset];
+uint16_t crypto_sign_with_staged_key(uint8_t *signature,
+                                     uint16_t signatureMaxlen,
+                                     const uint8_t *digest,
+                                     uint16_t digestLen) {
+    if (digestLen != CRYPTO_DIGEST_LEN) {
+        return 0;
+    }
 
-    if (bech32_hrp_len == 0 || bech32_hrp_len > MAX_BECH32_HRP_LEN) {
-        THROW(APDU_CODE_DATA_INVALID);
+    uint16_t signatureLength = 0;
+    uint8_t r[SW_SECP256K1_SCALAR_SIZE];
+    uint8_t s[SW_SECP256K1_SCALAR_SIZE];
+    if (staged_key.ready && sw_secp256k1_sign(staged_key.privateKey, digest, r, s)) {
+        signatureLength = sw_secp256k1_der_encode(r, s, signature, signatureMaxlen);
     }
+    MEMZERO(r, sizeof(r));
+    MEMZERO(s, sizeof(s));
+
+    return signatureLength;
+}
+
+#endif
 
-    memcpy(bech32_hrp, G_io_apdu_buffer + offset + 1, bech32_hrp_len);
-    bech32_hrp[bech32_hrp_len] = 0;  // zero terminate
+bool crypto_ckd_pub(const uint8_t publicKey[65],
+                    const uint8_t chainCode[32],
+                    uint32_t index,
+                    uint8_t childPubKey[PK_LEN_SECP256K1]) {
+    MEMZERO(childPubKey, PK_LEN_SECP256K1);
+    if (index & 0x80000000u) {
+        return false;
+    }
 
-    return bech32_hrp_len;
+    uint8_t data[PK_LEN_SECP256K1 + 4];
+    compress_pubkey(publicKey, data);
+    data[PK_LEN_SECP256K1 + 0] = (index >> 24) & 0xFF;
+    data[PK_LEN_SECP256K1 + 1] = (index >> 16) & 0xFF;
+    data[PK_LEN_SECP256K1 + 2] = (index >> 8) & 0xFF;
+    data[PK_LEN_SECP256K1 + 3] = index & 0xFF;
+
+    // I = HMAC-SHA512(chain code, parent pubkey || index), child = parent + I_L * G
+    uint8_t I[64];
+    uint8_t child[65];
+    bip32_hmac_sha512(chainCode, 32, data, sizeof(data), I);
+    const bool ok = bip32_add_tweak(publicKey, I, child);
+    MEMZERO(I, sizeof(I));
+
+    if (ok) {
+        compress_pubkey(child, childPubKey);
+    }
+    return ok;
 }
 
-void ripemd160_32(uint8_t *out, uint8_t *in) {
-    cx_ripemd160_t rip160;
-    cx_ripemd160_init(&rip160);
-    cx_hash(&rip160.header, CX_LAST, in, CX_SHA256_SIZE, out, CX_RIPEMD160_SIZE);
+bool crypto_derive_child_pubkey(uint32_t index, uint8_t *pubKey) {
+    if (!xpub_cache.valid) {
+        MEMZERO(pubKey, PK_LEN_SECP256K1);
+        return false;
+    }
+    return crypto_ckd_pub(xpub_cache.publicKey, xpub_cache.chainCode, index, pubKey);
+}
+
+uint16_t crypto_sign(uint8_t *signature,
+                     uint16_t signatureMaxlen,
+                     const uint8_t *digest,
+                     uint16_t digestLen) {
+    // Usually staged while the user was reviewing the transaction
+    crypto_stage_signing_key(hdPath);
+    const uint16_t signatureLength =
+        crypto_sign_with_staged_key(signature, signatureMaxlen, digest, digestLen);
+    crypto_clear_signing_key();
+    return signatureLength;
 }
 
 void crypto_set_hrp(char *p) {
-    bech32_hrp_len = strlen(p);
-    if (bech32_hrp_len < MAX_BECH32_HRP_LEN) {
-        strlcpy(bech32_hrp, p, MAX_BECH32_HRP_LEN);
+    const size_t hrp_len = strlen(p);
+    if (hrp_len < MAX_BECH32_HRP_LEN) {
+        crypto_set_hrp_len(p, hrp_len);
     }
 }
 
+void crypto_encodeAddress(const uint8_t *pubKey, char *addr, uint16_t addr_len) {
+    // Hash it
+    uint8_t hashed1_pk[CRYPTO_DIGEST_LEN];
+    hash_sha256(pubKey, PK_LEN_SECP256K1, hashed1_pk);
+
+    uint8_t hashed2_pk[RIPEMD160_LEN];
+    ripemd160_32(hashed2_pk, hashed1_pk);
+
+    bech32EncodeFromBytes(addr, addr_len, bech32_hrp, hashed2_pk, RIPEMD160_LEN, 1);
+}
+
 uint16_t crypto_fillAddress(uint8_t *buffer, uint16_t buffer_len) {
     if (buffer_len < PK_LEN_SECP256K1 + 50) {
         return 0;
     }
 
+    char *addr = (char *) (buffer + PK_LEN_SECP256K1);
+
+    const addr_cache_entry_t *cached = addr_cache_find(hdPath);
+    if (cached != NULL) {
+        const size_t addr_len = strlen(cached->addr);
+        if (addr_len < buffer_len - PK_LEN_SECP256K1) {
+            MEMCPY(buffer, cached->pubKey, PK_LEN_SECP256K1);
+            MEMCPY(addr, cached->addr, addr_len + 1);
+            return PK_LEN_SECP256K1 + addr_len;
+        }
+    }
+
     // extract pubkey
     crypto_extractPublicKey(hdPath, buffer, buffer_len);
+    crypto_encodeAddress(buffer, addr, buffer_len - PK_LEN_SECP256K1);
 
-    // Hash it
-    uint8_t hashed1_pk[CX_SHA256_SIZE];
-    cx_hash_sha256(buffer, PK_LEN_SECP256K1, hashed1_pk, CX_SHA256_SIZE);
+    addr_cache_insert(hdPath, buffer, addr);
 
-    uint8_t hashed2_pk[CX_RIPEMD160_SIZE];
-    ripemd160_32(hashed2_pk, hashed1_pk);
+    return PK_LEN_SECP256K1 + strlen(addr);
+}
 
-    char *addr = (char *) (buffer + PK_LEN_SECP256K1);
-    bech32EncodeFromBytes(addr,
-                          buffer_len - PK_LEN_SECP256K1,
-                          bech32_hrp,
-                          hashed2_pk,
-                          CX_RIPEMD160_SIZE,
-                          1);
+uint16_t crypto_fillAddressBatch(uint8_t *buffer,
+                                 uint16_t buffer_len,
+                                 const uint32_t basePath[HDPATH_LEN_DEFAULT - 1],
+                                 uint32_t start,
+                                 uint8_t count) {
+    if (buffer_len < 1) {
+        return 0;
+    }
 
-    return PK_LEN_SECP256K1 + strlen(addr);
+    // The account node is derived once and shared by all the indices
+    crypto_load_xpub(basePath);
+
+    uint8_t pubKey[PK_LEN_SECP256K1];
+    char addr[MAX_BECH32_HRP_LEN + 50];
+
+    uint16_t pos = 1;
+    uint8_t num_entries = 0;
+    for (; num_entries < count; num_entries++) {
+        if (!crypto_derive_child_pubkey(start + num_entries, pubKey)) {
+            break;
+        }
+        crypto_encodeAddress(pubKey, addr, sizeof(addr));
+
+        // PK | ADDR_LEN | ADDR, stop when the next entry does not fit
+        const uint8_t addr_len = strlen(addr);
+        if (pos + PK_LEN_SECP256K1 + 1 + addr_len > buffer_len) {
+            break;
+        }
+        MEMCPY(buffer + pos, pubKey, PK_LEN_SECP256K1);
+        pos += PK_LEN_SECP256K1;
+        buffer[pos++] = addr_len;
+        MEMCPY(buffer + pos, addr, addr_len);
+        pos += addr_len;
+    }
+    buffer[0] = num_entries;
+
+    return pos;
 }
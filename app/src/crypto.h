@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <zxmacros.h>
 #include "coin.h"
 
@@ -23,21 +24,97 @@
 extern "C" {
 #endif
 
-#define MAX_BECH32_HRP_LEN 83u
+#define MAX_BECH32_HRP_LEN       83u
+#define CRYPTO_DIGEST_LEN        32u
+#define CRYPTO_SIGNATURE_MAX_LEN 72u  // DER encoded
 
 extern uint32_t hdPath[HDPATH_LEN_DEFAULT];
 extern char *hrp;
 
-uint8_t extractHRP(uint32_t rx, uint32_t offset);
-
 void crypto_set_hrp(char *p);
 
+/// Set the HRP used for addresses
+/// \param hrp: does not need to be terminated
+/// \param hrp_len: must not exceed MAX_BECH32_HRP_LEN
+void crypto_set_hrp_len(const char *hrp, uint8_t hrp_len);
+
+/// Forget all cached public keys and addresses
+void crypto_clear_address_cache();
+
 uint16_t crypto_fillAddress(uint8_t *buffer, uint16_t bufferLen);
 
+/// Bech32 address of a compressed public key using the current HRP
+void crypto_encodeAddress(const uint8_t *pubKey, char *addr, uint16_t addr_len);
+
+/// Derive (and cache) the public key and chain code of an account node
+void crypto_load_xpub(const uint32_t basePath[HDPATH_LEN_DEFAULT - 1]);
+
+/// BIP32 public child key derivation, the same code runs on the device and on the host
+/// \param publicKey: uncompressed parent public key
+/// \param chainCode: parent chain code
+/// \param index: must not be hardened
+/// \param childPubKey (out) compressed child public key, zeroed on error
+/// \return false if the index is hardened or the child key is not valid
+bool crypto_ckd_pub(const uint8_t publicKey[65],
+                    const uint8_t chainCode[32],
+                    uint32_t index,
+                    uint8_t childPubKey[PK_LEN_SECP256K1]);
+
+/// Public key of a non-hardened child of the node loaded by crypto_load_xpub
+/// \return false if no node is loaded or the child key is not valid
+bool crypto_derive_child_pubkey(uint32_t index, uint8_t *pubKey);
+
+/// Fill buffer with the public keys and addresses of basePath/start .. basePath/start+count-1
+/// Format: N | N x (PK[33] | ADDR_LEN | ADDR), only the entries that fit are written
+/// \return number of bytes written
+uint16_t crypto_fillAddressBatch(uint8_t *buffer,
+                                 uint16_t bufferLen,
+                                 const uint32_t basePath[HDPATH_LEN_DEFAULT - 1],
+                                 uint32_t start,
+                                 uint8_t count);
+
+/// Derive the signing key for path ahead of signing (e.g. while the user reviews)
+void crypto_stage_signing_key(const uint32_t path[HDPATH_LEN_DEFAULT]);
+
+/// Whether a staged signing key for path is available
+bool crypto_signing_key_staged(const uint32_t path[HDPATH_LEN_DEFAULT]);
+
+/// Zeroize the staged signing key
+void crypto_clear_signing_key();
+
+/// Sign the SHA-256 digest of the transaction blob with the key of hdPath
+/// The key is staged if it was not, and always cleared afterwards
+/// \param signature (out) DER encoded signature
+/// \param signatureMaxlen
+/// \param digest
+/// \param digestLen: must be CRYPTO_DIGEST_LEN
+/// \return signature length or 0 on error
 uint16_t crypto_sign(uint8_t *signature,
                      uint16_t signatureMaxlen,
-                     const uint8_t *message,
-                     uint16_t messageLen);
+                     const uint8_t *digest,
+                     uint16_t digestLen);
+
+/// Sign a digest with the staged signing key, which is kept for further signatures
+/// The key is never staged here, signing fails if crypto_stage_signing_key was not called.
+/// The caller must call crypto_clear_signing_key when done.
+/// \param signature (out) DER encoded signature
+/// \param signatureMaxlen
+/// \param digest
+/// \param digestLen: must be CRYPTO_DIGEST_LEN
+/// \return signature length or 0 on error
+uint16_t crypto_sign_with_staged_key(uint8_t *signature,
+                                     uint16_t signatureMaxlen,
+                                     const uint8_t *digest,
+                                     uint16_t digestLen);
+
+#if !(defined(TARGET_NANOS) || defined(TARGET_NANOX) || defined(TARGET_NANOS2))
+// Same test mnemonic as the Zemu tests
+#define CRYPTO_HOST_DEFAULT_MNEMONIC \
+    "equip will roof matter pink blind book anxiety banner elbow sun young"
+
+/// Host builds only: derive all keys from this mnemonic (default CRYPTO_HOST_DEFAULT_MNEMONIC)
+void crypto_host_set_mnemonic(const char *mnemonic);
+#endif
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,130 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#if !(defined(TARGET_NANOS) || defined(TARGET_NANOX) || defined(TARGET_NANOS2))
+
+#include <string.h>
+#include "bip32.h"
+#include "secp256k1.h"
+#include "sha2.h"
+
+#define BIP39_PBKDF2_ROUNDS 2048
+
+void sw_bip39_mnemonic_to_seed(const char *mnemonic, uint8_t seed[SW_BIP39_SEED_SIZE]) {
+    static const char salt[] = "mnemonic";
+    sw_pbkdf2_hmac_sha512((const uint8_t *) mnemonic,
+                          strlen(mnemonic),
+                          (const uint8_t *) salt,
+                          sizeof(salt) - 1,
+                          BIP39_PBKDF2_ROUNDS,
+                          seed,
+                          SW_BIP39_SEED_SIZE);
+}
+
+bool sw_bip32_master(const uint8_t *seed, size_t seedLen, sw_bip32_node_t *node) {
+    static const char key[] = "Bitcoin seed";
+    uint8_t I[SW_SHA512_SIZE];
+    sw_hmac_sha512((const uint8_t *) key, sizeof(key) - 1, seed, seedLen, I);
+
+    memcpy(node->privateKey, I, 32);
+    memcpy(node->chainCode, I + 32, 32);
+    memset(I, 0, sizeof(I));
+    return sw_secp256k1_scalar_is_valid(node->privateKey);
+}
+
+static inline void compress_point(const uint8_t point[65], uint8_t out[33]) {
+    out[0] = (point[64] & 1) ? 0x03 : 0x02;
+    memcpy(out + 1, point + 1, 32);
+}
+
+static inline void write_index(uint8_t *out, uint32_t index) {
+    out[0] = (uint8_t)(index >> 24);
+    out[1] = (uint8_t)(index >> 16);
+    out[2] = (uint8_t)(index >> 8);
+    out[3] = (uint8_t) index;
+}
+
+bool sw_bip32_ckd_priv(const sw_bip32_node_t *parent, uint32_t index, sw_bip32_node_t *child) {
+    // hardened: 0x00 || k || index, otherwise: compressed(K) || index
+    uint8_t data[37];
+    if (index & SW_BIP32_HARDENED) {
+        data[0] = 0x00;
+        memcpy(data + 1, parent->privateKey, 32);
+    } else {
+        uint8_t publicKey[SW_SECP256K1_POINT_SIZE];
+        if (!sw_secp256k1_pubkey_create(parent->privateKey, publicKey)) {
+            return false;
+        }
+        compress_point(publicKey, data);
+    }
+    write_index(data + 33, index);
+
+    uint8_t I[SW_SHA512_SIZE];
+    sw_hmac_sha512(parent->chainCode, 32, data, sizeof(data), I);
+    memset(data, 0, sizeof(data));
+
+    // child = I_L + k (mod n)
+    bool ok = sw_secp256k1_scalar_is_valid(I) &&
+              sw_secp256k1_scalar_add(I, parent->privateKey, child->privateKey);
+    memcpy(child->chainCode, I + 32, 32);
+    memset(I, 0, sizeof(I));
+    return ok;
+}
+
+bool sw_bip32_ckd_pub(const uint8_t publicKey[65],
+                      const uint8_t chainCode[32],
+                      uint32_t index,
+                      uint8_t childPublicKey[65]) {
+    if (index & SW_BIP32_HARDENED) {
+        return false;
+    }
+
+    uint8_t data[37];
+    compress_point(publicKey, data);
+    write_index(data + 33, index);
+
+    uint8_t I[SW_SHA512_SIZE];
+    sw_hmac_sha512(chainCode, 32, data, sizeof(data), I);
+
+    // child = parent + I_L * G
+    uint8_t tweak[SW_SECP256K1_POINT_SIZE];
+    const bool ok = sw_secp256k1_pubkey_create(I, tweak) &&
+                    sw_secp256k1_point_add(publicKey, tweak, childPublicKey);
+    memset(I, 0, sizeof(I));
+    return ok;
+}
+
+bool sw_bip32_derive_path(const uint8_t seed[SW_BIP39_SEED_SIZE],
+                          const uint32_t *path,
+                          uint8_t pathLen,
+                          sw_bip32_node_t *node) {
+    if (!sw_bip32_master(seed, SW_BIP39_SEED_SIZE, node)) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < pathLen; i++) {
+        sw_bip32_node_t child;
+        if (!sw_bip32_ckd_priv(node, path[i], &child)) {
+            memset(node, 0, sizeof(sw_bip32_node_t));
+            return false;
+        }
+        memcpy(node, &child, sizeof(sw_bip32_node_t));
+        memset(&child, 0, sizeof(child));
+    }
+    return true;
+}
+
+#endif
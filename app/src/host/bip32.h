@@ -0,0 +1,65 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#pragma once
+
+// Software BIP32/BIP39 key derivation for host builds (tests, simulator and benchmarks)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SW_BIP32_HARDENED 0x80000000u
+#define SW_BIP39_SEED_SIZE 64
+
+typedef struct {
+    uint8_t privateKey[32];
+    uint8_t chainCode[32];
+} sw_bip32_node_t;
+
+/// BIP39 seed of a mnemonic (no passphrase)
+void sw_bip39_mnemonic_to_seed(const char *mnemonic, uint8_t seed[SW_BIP39_SEED_SIZE]);
+
+/// Master node of a seed ("Bitcoin seed" HMAC key)
+/// \return false if the seed produces an invalid key
+bool sw_bip32_master(const uint8_t *seed, size_t seedLen, sw_bip32_node_t *node);
+
+/// Private child key derivation, hardened if index has the high bit set
+/// \return false if the child is invalid (the caller should try the next index)
+bool sw_bip32_ckd_priv(const sw_bip32_node_t *parent, uint32_t index, sw_bip32_node_t *child);
+
+/// Public child key derivation of a non-hardened index
+/// \param publicKey: uncompressed parent public key
+/// \param chainCode: parent chain code
+/// \param childPublicKey (out) uncompressed child public key
+bool sw_bip32_ckd_pub(const uint8_t publicKey[65],
+                      const uint8_t chainCode[32],
+                      uint32_t index,
+                      uint8_t childPublicKey[65]);
+
+/// Derive a node from the master node of a seed
+bool sw_bip32_derive_path(const uint8_t seed[SW_BIP39_SEED_SIZE],
+                          const uint32_t *path,
+                          uint8_t pathLen,
+                          sw_bip32_node_t *node);
+
+#ifdef __cplusplus
+}
+#endif
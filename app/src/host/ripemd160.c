@@ -0,0 +1,141 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#if !(defined(TARGET_NANOS) || defined(TARGET_NANOX) || defined(TARGET_NANOS2))
+
+#include <string.h>
+#include "ripemd160.h"
+
+#define ROTL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+// Message word selection and rotation amounts for the left and right lines
+static const uint8_t rmd_r[80] = {
+    0, 1, 2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15, 7,  4,  13, 1,
+    10, 6, 15, 3,  12, 0,  9,  5,  2,  14, 11, 8,  3,  10, 14, 4,  9,  15, 8,  1,
+    2,  7, 0,  6,  13, 11, 5,  12, 1,  9,  11, 10, 0,  8,  12, 4,  13, 3,  7,  15,
+    14, 5, 6,  2,  4,  0,  5,  9,  7,  12, 2,  10, 14, 1,  3,  8,  11, 6,  15, 13,
+};
+
+static const uint8_t rmd_rp[80] = {
+    5,  14, 7,  0, 9, 2,  11, 4,  13, 6,  15, 8,  1,  10, 3,  12, 6,  11, 3,  7,
+    0,  13, 5,  10, 14, 15, 8,  12, 4,  9,  1,  2,  15, 5,  1,  3,  7,  14, 6,  9,
+    11, 8,  12, 2, 10, 0,  4,  13, 8,  6,  4,  1,  3,  11, 15, 0,  5,  12, 2,  13,
+    9,  7,  10, 14, 12, 15, 10, 4,  1,  5,  8,  7,  6,  2,  13, 14, 0,  3,  9,  11,
+};
+
+static const uint8_t rmd_s[80] = {
+    11, 14, 15, 12, 5,  8,  7,  9,  11, 13, 14, 15, 6,  7,  9,  8,  7,  6,  8,  13,
+    11, 9,  7,  15, 7,  12, 15, 9,  11, 7,  13, 12, 11, 13, 6,  7,  14, 9,  13, 15,
+    14, 8,  13, 6,  5,  12, 7,  5,  11, 12, 14, 15, 14, 15, 9,  8,  9,  14, 5,  6,
+    8,  6,  5,  12, 9,  15, 5,  11, 6,  8,  13, 12, 5,  12, 13, 14, 11, 8,  5,  6,
+};
+
+static const uint8_t rmd_sp[80] = {
+    8,  9,  9,  11, 13, 15, 15, 5,  7,  7,  8,  11, 14, 14, 12, 6,  9,  13, 15, 7,
+    12, 8,  9,  11, 7,  7,  12, 7,  6,  15, 13, 11, 9,  7,  15, 11, 8,  6,  6,  14,
+    12, 13, 5,  14, 13, 13, 7,  5,  15, 5,  8,  11, 14, 14, 6,  14, 6,  9,  12, 9,
+    12, 5,  15, 8,  8,  5,  12, 9,  12, 5,  14, 6,  8,  13, 6,  5,  15, 13, 11, 11,
+};
+
+static const uint32_t rmd_k[5] = {0x00000000, 0x5A827999, 0x6ED9EBA1, 0x8F1BBCDC, 0xA953FD4E};
+static const uint32_t rmd_kp[5] = {0x50A28BE6, 0x5C4DD124, 0x6D703EF3, 0x7A6D76E9, 0x00000000};
+
+static uint32_t rmd_f(uint8_t round, uint32_t x, uint32_t y, uint32_t z) {
+    switch (round) {
+        case 0:
+            return x ^ y ^ z;
+        case 1:
+            return (x & y) | (~x & z);
+        case 2:
+            return (x | ~y) ^ z;
+        case 3:
+            return (x & z) | (y & ~z);
+        default:
+            return x ^ (y | ~z);
+    }
+}
+
+static void ripemd160_compress(uint32_t state[5], const uint8_t block[64]) {
+    uint32_t x[16];
+    for (uint8_t i = 0; i < 16; i++) {
+        x[i] = (uint32_t) block[4 * i] | (uint32_t) block[4 * i + 1] << 8 |
+               (uint32_t) block[4 * i + 2] << 16 | (uint32_t) block[4 * i + 3] << 24;
+    }
+
+    uint32_t al = state[0], bl = state[1], cl = state[2], dl = state[3], el = state[4];
+    uint32_t ar = al, br = bl, cr = cl, dr = dl, er = el;
+
+    for (uint8_t j = 0; j < 80; j++) {
+        const uint8_t round = j / 16;
+
+        uint32_t t = al + rmd_f(round, bl, cl, dl) + x[rmd_r[j]] + rmd_k[round];
+        t = ROTL32(t, rmd_s[j]) + el;
+        al = el;
+        el = dl;
+        dl = ROTL32(cl, 10);
+        cl = bl;
+        bl = t;
+
+        t = ar + rmd_f(4 - round, br, cr, dr) + x[rmd_rp[j]] + rmd_kp[round];
+        t = ROTL32(t, rmd_sp[j]) + er;
+        ar = er;
+        er = dr;
+        dr = ROTL32(cr, 10);
+        cr = br;
+        br = t;
+    }
+
+    const uint32_t t = state[1] + cl + dr;
+    state[1] = state[2] + dl + er;
+    state[2] = state[3] + el + ar;
+    state[3] = state[4] + al + br;
+    state[4] = state[0] + bl + cr;
+    state[0] = t;
+}
+
+void sw_ripemd160(const uint8_t *in, size_t len, uint8_t out[SW_RIPEMD160_SIZE]) {
+    uint32_t state[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    const uint64_t bit_length = (uint64_t) len * 8;
+
+    while (len >= 64) {
+        ripemd160_compress(state, in);
+        in += 64;
+        len -= 64;
+    }
+
+    // Padding: 0x80, zeros and the little endian bit length
+    uint8_t block[64];
+    memset(block, 0, sizeof(block));
+    memcpy(block, in, len);
+    block[len] = 0x80;
+    if (len >= 56) {
+        ripemd160_compress(state, block);
+        memset(block, 0, sizeof(block));
+    }
+    for (uint8_t i = 0; i < 8; i++) {
+        block[56 + i] = (uint8_t)(bit_length >> (8 * i));
+    }
+    ripemd160_compress(state, block);
+
+    for (uint8_t i = 0; i < 5; i++) {
+        out[4 * i] = (uint8_t) state[i];
+        out[4 * i + 1] = (uint8_t)(state[i] >> 8);
+        out[4 * i + 2] = (uint8_t)(state[i] >> 16);
+        out[4 * i + 3] = (uint8_t)(state[i] >> 24);
+    }
+}
+
+#endif
@@ -0,0 +1,34 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#pragma once
+
+// Software RIPEMD-160 for host builds (tests, simulator and benchmarks)
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SW_RIPEMD160_SIZE 20
+
+void sw_ripemd160(const uint8_t *in, size_t len, uint8_t out[SW_RIPEMD160_SIZE]);
+
+#ifdef __cplusplus
+}
+#endif
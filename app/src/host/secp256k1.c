@@ -0,0 +1,568 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#if !(defined(TARGET_NANOS) || defined(TARGET_NANOX) || defined(TARGET_NANOS2))
+
+#include <string.h>
+#include "secp256k1.h"
+#include "sha2.h"
+
+#define BN_LIMBS 8
+
+// 256-bit integer, little endian 32-bit limbs
+typedef struct {
+    uint32_t v[BN_LIMBS];
+} bn_t;
+
+// Modulus m with c = 2^256 - m, used to fold the high half of products
+typedef struct {
+    bn_t m;
+    bn_t c;
+} modulus_t;
+
+// Jacobian coordinates, Z = 0 is the point at infinity
+typedef struct {
+    bn_t x;
+    bn_t y;
+    bn_t z;
+} point_t;
+
+static const modulus_t field_p = {
+    {{0xFFFFFC2F, 0xFFFFFFFE, 0xFFFFFFFF, 0xFFFFFFFF,
+      0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF}},
+    {{0x000003D1, 0x00000001, 0, 0, 0, 0, 0, 0}},
+};
+
+static const modulus_t order_n = {
+    {{0xD0364141, 0xBFD25E8C, 0xAF48A03B, 0xBAAEDCE6,
+      0xFFFFFFFE, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF}},
+    {{0x2FC9BEBF, 0x402DA173, 0x50B75FC4, 0x45512319, 0x00000001, 0, 0, 0}},
+};
+
+static const bn_t generator_x = {{0x16F81798, 0x59F2815B, 0x2DCE28D9, 0x029BFCDB,
+                                  0xCE870B07, 0x55A06295, 0xF9DCBBAC, 0x79BE667E}};
+static const bn_t generator_y = {{0xFB10D4B8, 0x9C47D08F, 0xA6855419, 0xFD17B448,
+                                  0x0E1108A8, 0x5DA4FBFC, 0x26A3C465, 0x483ADA77}};
+
+static void bn_from_bytes(bn_t *a, const uint8_t in[32]) {
+    for (uint8_t i = 0; i < BN_LIMBS; i++) {
+        const uint8_t *p = in + 28 - 4 * i;
+        a->v[i] = (uint32_t) p[0] << 24 | (uint32_t) p[1] << 16 | (uint32_t) p[2] << 8 | p[3];
+    }
+}
+
+static void bn_to_bytes(const bn_t *a, uint8_t out[32]) {
+    for (uint8_t i = 0; i < BN_LIMBS; i++) {
+        uint8_t *p = out + 28 - 4 * i;
+        p[0] = (uint8_t)(a->v[i] >> 24);
+        p[1] = (uint8_t)(a->v[i] >> 16);
+        p[2] = (uint8_t)(a->v[i] >> 8);
+        p[3] = (uint8_t) a->v[i];
+    }
+}
+
+static void bn_set_word(bn_t *a, uint32_t w) {
+    memset(a, 0, sizeof(bn_t));
+    a->v[0] = w;
+}
+
+static bool bn_is_zero(const bn_t *a) {
+    uint32_t acc = 0;
+    for (uint8_t i = 0; i < BN_LIMBS; i++) {
+        acc |= a->v[i];
+    }
+    return acc == 0;
+}
+
+static int bn_cmp(const bn_t *a, const bn_t *b) {
+    for (int8_t i = BN_LIMBS - 1; i >= 0; i--) {
+        if (a->v[i] != b->v[i]) {
+            return a->v[i] > b->v[i] ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+static bool bn_bit(const bn_t *a, uint16_t bit) {
+    return (a->v[bit / 32] >> (bit % 32)) & 1;
+}
+
+static uint32_t bn_add(bn_t *r, const bn_t *a, const bn_t *b) {
+    uint64_t carry = 0;
+    for (uint8_t i = 0; i < BN_LIMBS; i++) {
+        carry += (uint64_t) a->v[i] + b->v[i];
+        r->v[i] = (uint32_t) carry;
+        carry >>= 32;
+    }
+    return (uint32_t) carry;
+}
+
+static uint32_t bn_sub(bn_t *r, const bn_t *a, const bn_t *b) {
+    uint64_t borrow = 0;
+    for (uint8_t i = 0; i < BN_LIMBS; i++) {
+        const uint64_t d = (uint64_t) a->v[i] - b->v[i] - borrow;
+        r->v[i] = (uint32_t) d;
+        borrow = (d >> 32) & 1;
+    }
+    return (uint32_t) borrow;
+}
+
+static void mod_add(bn_t *r, const bn_t *a, const bn_t *b, const modulus_t *mod) {
+    const uint32_t carry = bn_add(r, a, b);
+    if (carry || bn_cmp(r, &mod->m) >= 0) {
+        bn_sub(r, r, &mod->m);
+    }
+}
+
+static void mod_sub(bn_t *r, const bn_t *a, const bn_t *b, const modulus_t *mod) {
+    if (bn_sub(r, a, b)) {
+        bn_add(r, r, &mod->m);
+    }
+}
+
+// r = (a * b) mod m, using 2^256 = c (mod m) to fold the high half until it vanishes
+static void mod_mul(bn_t *r, const bn_t *a, const bn_t *b, const modulus_t *mod) {
+    uint32_t t[2 * BN_LIMBS];
+    memset(t, 0, sizeof(t));
+    for (uint8_t i = 0; i < BN_LIMBS; i++) {
+        uint64_t carry = 0;
+        for (uint8_t j = 0; j < BN_LIMBS; j++) {
+            carry += (uint64_t) a->v[i] * b->v[j] + t[i + j];
+            t[i + j] = (uint32_t) carry;
+            carry >>= 32;
+        }
+        t[i + BN_LIMBS] = (uint32_t) carry;
+    }
+
+    for (;;) {
+        bool high_zero = true;
+        for (uint8_t i = BN_LIMBS; i < 2 * BN_LIMBS; i++) {
+            high_zero &= t[i] == 0;
+        }
+        if (high_zero) {
+            break;
+        }
+
+        uint32_t f[2 * BN_LIMBS];
+        memset(f, 0, sizeof(f));
+        for (uint8_t i = 0; i < BN_LIMBS; i++) {
+            uint64_t carry = 0;
+            for (uint8_t j = 0; j < BN_LIMBS; j++) {
+                carry += (uint64_t) t[BN_LIMBS + i] * mod->c.v[j] + f[i + j];
+                f[i + j] = (uint32_t) carry;
+                carry >>= 32;
+            }
+            f[i + BN_LIMBS] = (uint32_t) carry;
+        }
+        uint64_t carry = 0;
+        for (uint8_t i = 0; i < 2 * BN_LIMBS; i++) {
+            carry += (uint64_t) f[i] + (i < BN_LIMBS ? t[i] : 0);
+            t[i] = (uint32_t) carry;
+            carry >>= 32;
+        }
+    }
+
+    memcpy(r->v, t, sizeof(r->v));
+    while (bn_cmp(r, &mod->m) >= 0) {
+        bn_sub(r, r, &mod->m);
+    }
+}
+
+// r = a^-1 (mod m), m is prime: a^(m-2)
+static void mod_inv(bn_t *r, const bn_t *a, const modulus_t *mod) {
+    bn_t e, two, acc;
+    bn_set_word(&two, 2);
+    bn_sub(&e, &mod->m, &two);
+    bn_set_word(&acc, 1);
+    for (int16_t bit = 255; bit >= 0; bit--) {
+        mod_mul(&acc, &acc, &acc, mod);
+        if (bn_bit(&e, bit)) {
+            mod_mul(&acc, &acc, a, mod);
+        }
+    }
+    *r = acc;
+}
+
+static void point_set_infinity(point_t *p) {
+    memset(p, 0, sizeof(point_t));
+    p->x.v[0] = 1;
+    p->y.v[0] = 1;
+}
+
+static bool point_is_infinity(const point_t *p) {
+    return bn_is_zero(&p->z);
+}
+
+static void point_double(point_t *r, const point_t *p) {
+    const modulus_t *f = &field_p;
+    if (point_is_infinity(p) || bn_is_zero(&p->y)) {
+        point_set_infinity(r);
+        return;
+    }
+
+    bn_t yy, s, m, t, x3, y3, z3;
+    // S = 4 X Y^2
+    mod_mul(&yy, &p->y, &p->y, f);
+    mod_mul(&s, &p->x, &yy, f);
+    mod_add(&s, &s, &s, f);
+    mod_add(&s, &s, &s, f);
+    // M = 3 X^2 (a = 0)
+    mod_mul(&t, &p->x, &p->x, f);
+    mod_add(&m, &t, &t, f);
+    mod_add(&m, &m, &t, f);
+    // X3 = M^2 - 2 S
+    mod_mul(&x3, &m, &m, f);
+    mod_sub(&x3, &x3, &s, f);
+    mod_sub(&x3, &x3, &s, f);
+    // Y3 = M (S - X3) - 8 Y^4
+    mod_sub(&t, &s, &x3, f);
+    mod_mul(&y3, &m, &t, f);
+    mod_mul(&t, &yy, &yy, f);
+    mod_add(&t, &t, &t, f);
+    mod_add(&t, &t, &t, f);
+    mod_add(&t, &t, &t, f);
+    mod_sub(&y3, &y3, &t, f);
+    // Z3 = 2 Y Z
+    mod_mul(&z3, &p->y, &p->z, f);
+    mod_add(&z3, &z3, &z3, f);
+
+    r->x = x3;
+    r->y = y3;
+    r->z = z3;
+}
+
+static void point_add(point_t *r, const point_t *p, const point_t *q) {
+    const modulus_t *f = &field_p;
+    if (point_is_infinity(p)) {
+        *r = *q;
+        return;
+    }
+    if (point_is_infinity(q)) {
+        *r = *p;
+        return;
+    }
+
+    bn_t z1z1, z2z2, u1, u2, s1, s2, h, rr, hh, hhh, t, x3, y3, z3;
+    mod_mul(&z1z1, &p->z, &p->z, f);
+    mod_mul(&z2z2, &q->z, &q->z, f);
+    mod_mul(&u1, &p->x, &z2z2, f);
+    mod_mul(&u2, &q->x, &z1z1, f);
+    mod_mul(&s1, &p->y, &z2z2, f);
+    mod_mul(&s1, &s1, &q->z, f);
+    mod_mul(&s2, &q->y, &z1z1, f);
+    mod_mul(&s2, &s2, &p->z, f);
+
+    if (bn_cmp(&u1, &u2) == 0) {
+        if (bn_cmp(&s1, &s2) == 0) {
+            point_double(r, p);
+        } else {
+            point_set_infinity(r);
+        }
+        return;
+    }
+
+    mod_sub(&h, &u2, &u1, f);
+    mod_sub(&rr, &s2, &s1, f);
+    mod_mul(&hh, &h, &h, f);
+    mod_mul(&hhh, &hh, &h, f);
+    mod_mul(&t, &u1, &hh, f);
+    // X3 = R^2 - H^3 - 2 U1 H^2
+    mod_mul(&x3, &rr, &rr, f);
+    mod_sub(&x3, &x3, &hhh, f);
+    mod_sub(&x3, &x3, &t, f);
+    mod_sub(&x3, &x3, &t, f);
+    // Y3 = R (U1 H^2 - X3) - S1 H^3
+    mod_sub(&t, &t, &x3, f);
+    mod_mul(&y3, &rr, &t, f);
+    mod_mul(&t, &s1, &hhh, f);
+    mod_sub(&y3, &y3, &t, f);
+    // Z3 = H Z1 Z2
+    mod_mul(&z3, &h, &p->z, f);
+    mod_mul(&z3, &z3, &q->z, f);
+
+    r->x = x3;
+    r->y = y3;
+    r->z = z3;
+}
+
+static void point_mul(point_t *r, const bn_t *k, const point_t *p) {
+    point_t acc;
+    point_set_infinity(&acc);
+    for (int16_t bit = 255; bit >= 0; bit--) {
+        point_double(&acc, &acc);
+        if (bn_bit(k, bit)) {
+            point_add(&acc, &acc, p);
+        }
+    }
+    *r = acc;
+}
+
+static void point_generator(point_t *g) {
+    g->x = generator_x;
+    g->y = generator_y;
+    bn_set_word(&g->z, 1);
+}
+
+static void point_to_affine(bn_t *x, bn_t *y, const point_t *p) {
+    bn_t zinv, zinv2, zinv3;
+    mod_inv(&zinv, &p->z, &field_p);
+    mod_mul(&zinv2, &zinv, &zinv, &field_p);
+    mod_mul(&zinv3, &zinv2, &zinv, &field_p);
+    mod_mul(x, &p->x, &zinv2, &field_p);
+    mod_mul(y, &p->y, &zinv3, &field_p);
+}
+
+static bool point_decode(point_t *p, const uint8_t in[SW_SECP256K1_POINT_SIZE]) {
+    if (in[0] != 0x04) {
+        return false;
+    }
+    bn_from_bytes(&p->x, in + 1);
+    bn_from_bytes(&p->y, in + 33);
+    bn_set_word(&p->z, 1);
+    if (bn_cmp(&p->x, &field_p.m) >= 0 || bn_cmp(&p->y, &field_p.m) >= 0) {
+        return false;
+    }
+
+    // y^2 = x^3 + 7
+    bn_t lhs, rhs, seven;
+    bn_set_word(&seven, 7);
+    mod_mul(&lhs, &p->y, &p->y, &field_p);
+    mod_mul(&rhs, &p->x, &p->x, &field_p);
+    mod_mul(&rhs, &rhs, &p->x, &field_p);
+    mod_add(&rhs, &rhs, &seven, &field_p);
+    return bn_cmp(&lhs, &rhs) == 0;
+}
+
+static bool point_encode(uint8_t out[SW_SECP256K1_POINT_SIZE], const point_t *p) {
+    if (point_is_infinity(p)) {
+        return false;
+    }
+    bn_t x, y;
+    point_to_affine(&x, &y, p);
+    out[0] = 0x04;
+    bn_to_bytes(&x, out + 1);
+    bn_to_bytes(&y, out + 33);
+    return true;
+}
+
+static bool scalar_is_valid(const bn_t *k) {
+    return !bn_is_zero(k) && bn_cmp(k, &order_n.m) < 0;
+}
+
+bool sw_secp256k1_scalar_is_valid(const uint8_t k[SW_SECP256K1_SCALAR_SIZE]) {
+    bn_t a;
+    bn_from_bytes(&a, k);
+    return scalar_is_valid(&a);
+}
+
+bool sw_secp256k1_scalar_add(const uint8_t a[SW_SECP256K1_SCALAR_SIZE],
+                             const uint8_t b[SW_SECP256K1_SCALAR_SIZE],
+                             uint8_t out[SW_SECP256K1_SCALAR_SIZE]) {
+    bn_t x, y, r;
+    bn_from_bytes(&x, a);
+    bn_from_bytes(&y, b);
+    if (bn_cmp(&x, &order_n.m) >= 0 || bn_cmp(&y, &order_n.m) >= 0) {
+        return false;
+    }
+    mod_add(&r, &x, &y, &order_n);
+    bn_to_bytes(&r, out);
+    return !bn_is_zero(&r);
+}
+
+bool sw_secp256k1_pubkey_create(const uint8_t privateKey[SW_SECP256K1_SCALAR_SIZE],
+                                uint8_t publicKey[SW_SECP256K1_POINT_SIZE]) {
+    bn_t k;
+    bn_from_bytes(&k, privateKey);
+    if (!scalar_is_valid(&k)) {
+        return false;
+    }
+
+    point_t g, p;
+    point_generator(&g);
+    point_mul(&p, &k, &g);
+    memset(&k, 0, sizeof(k));
+    return point_encode(publicKey, &p);
+}
+
+bool sw_secp256k1_point_add(const uint8_t a[SW_SECP256K1_POINT_SIZE],
+                            const uint8_t b[SW_SECP256K1_POINT_SIZE],
+                            uint8_t out[SW_SECP256K1_POINT_SIZE]) {
+    point_t p, q, r;
+    if (!point_decode(&p, a) || !point_decode(&q, b)) {
+        return false;
+    }
+    point_add(&r, &p, &q);
+    return point_encode(out, &r);
+}
+
+// Reduce a 256-bit big endian value modulo n (bits2octets for a 256-bit hash)
+static void scalar_from_digest(bn_t *e, const uint8_t digest[32]) {
+    bn_from_bytes(e, digest);
+    if (bn_cmp(e, &order_n.m) >= 0) {
+        bn_sub(e, e, &order_n.m);
+    }
+}
+
+bool sw_secp256k1_sign(const uint8_t privateKey[SW_SECP256K1_SCALAR_SIZE],
+                       const uint8_t digest[32],
+                       uint8_t r[SW_SECP256K1_SCALAR_SIZE],
+                       uint8_t s[SW_SECP256K1_SCALAR_SIZE]) {
+    bn_t d, e;
+    bn_from_bytes(&d, privateKey);
+    if (!scalar_is_valid(&d)) {
+        return false;
+    }
+    scalar_from_digest(&e, digest);
+
+    // RFC6979 3.2: HMAC_DRBG seeded with x || h1
+    uint8_t K[SW_SHA256_SIZE];
+    uint8_t V[SW_SHA256_SIZE];
+    uint8_t buf[SW_SHA256_SIZE + 1 + 2 * SW_SECP256K1_SCALAR_SIZE];
+    memset(K, 0x00, sizeof(K));
+    memset(V, 0x01, sizeof(V));
+    memcpy(buf + SW_SHA256_SIZE + 1, privateKey, SW_SECP256K1_SCALAR_SIZE);
+    bn_to_bytes(&e, buf + SW_SHA256_SIZE + 1 + SW_SECP256K1_SCALAR_SIZE);
+
+    for (uint8_t round = 0; round < 2; round++) {
+        memcpy(buf, V, sizeof(V));
+        buf[SW_SHA256_SIZE] = round;
+        sw_hmac_sha256(K, sizeof(K), buf, sizeof(buf), K);
+        sw_hmac_sha256(K, sizeof(K), V, sizeof(V), V);
+    }
+
+    bool done = false;
+    while (!done) {
+        sw_hmac_sha256(K, sizeof(K), V, sizeof(V), V);
+
+        bn_t k;
+        bn_from_bytes(&k, V);
+        if (scalar_is_valid(&k)) {
+            point_t g, p;
+            bn_t x, y, rr, ss, kinv;
+            point_generator(&g);
+            point_mul(&p, &k, &g);
+            point_to_affine(&x, &y, &p);
+
+            // r = x mod n, s = k^-1 (e + r d) mod n
+            rr = x;
+            if (bn_cmp(&rr, &order_n.m) >= 0) {
+                bn_sub(&rr, &rr, &order_n.m);
+            }
+            mod_inv(&kinv, &k, &order_n);
+            mod_mul(&ss, &rr, &d, &order_n);
+            mod_add(&ss, &ss, &e, &order_n);
+            mod_mul(&ss, &ss, &kinv, &order_n);
+
+            if (!bn_is_zero(&rr) && !bn_is_zero(&ss)) {
+                bn_to_bytes(&rr, r);
+                bn_to_bytes(&ss, s);
+                done = true;
+            }
+            memset(&kinv, 0, sizeof(kinv));
+        }
+        memset(&k, 0, sizeof(k));
+
+        if (!done) {
+            uint8_t retry[SW_SHA256_SIZE + 1];
+            memcpy(retry, V, sizeof(V));
+            retry[SW_SHA256_SIZE] = 0x00;
+            sw_hmac_sha256(K, sizeof(K), retry, sizeof(retry), K);
+            sw_hmac_sha256(K, sizeof(K), V, sizeof(V), V);
+        }
+    }
+
+    memset(&d, 0, sizeof(d));
+    memset(K, 0, sizeof(K));
+    memset(V, 0, sizeof(V));
+    memset(buf, 0, sizeof(buf));
+    return true;
+}
+
+bool sw_secp256k1_verify(const uint8_t publicKey[SW_SECP256K1_POINT_SIZE],
+                         const uint8_t digest[32],
+                         const uint8_t r[SW_SECP256K1_SCALAR_SIZE],
+                         const uint8_t s[SW_SECP256K1_SCALAR_SIZE]) {
+    point_t q;
+    if (!point_decode(&q, publicKey)) {
+        return false;
+    }
+
+    bn_t rr, ss, e;
+    bn_from_bytes(&rr, r);
+    bn_from_bytes(&ss, s);
+    if (!scalar_is_valid(&rr) || !scalar_is_valid(&ss)) {
+        return false;
+    }
+    scalar_from_digest(&e, digest);
+
+    // P = (e w) G + (r w) Q, w = s^-1
+    bn_t w, u1, u2;
+    mod_inv(&w, &ss, &order_n);
+    mod_mul(&u1, &e, &w, &order_n);
+    mod_mul(&u2, &rr, &w, &order_n);
+
+    point_t g, p1, p2, p;
+    point_generator(&g);
+    point_mul(&p1, &u1, &g);
+    point_mul(&p2, &u2, &q);
+    point_add(&p, &p1, &p2);
+    if (point_is_infinity(&p)) {
+        return false;
+    }
+
+    bn_t x, y;
+    point_to_affine(&x, &y, &p);
+    if (bn_cmp(&x, &order_n.m) >= 0) {
+        bn_sub(&x, &x, &order_n.m);
+    }
+    return bn_cmp(&x, &rr) == 0;
+}
+
+// Minimal DER integer: leading zeros stripped, 0x00 prepended if the high bit is set
+static uint8_t der_integer(const uint8_t v[SW_SECP256K1_SCALAR_SIZE], uint8_t *out) {
+    uint8_t start = 0;
+    while (start < SW_SECP256K1_SCALAR_SIZE - 1 && v[start] == 0) {
+        start++;
+    }
+    const uint8_t pad = (v[start] & 0x80) ? 1 : 0;
+    const uint8_t len = SW_SECP256K1_SCALAR_SIZE - start + pad;
+
+    out[0] = 0x02;
+    out[1] = len;
+    out[2] = 0x00;
+    memcpy(out + 2 + pad, v + start, SW_SECP256K1_SCALAR_SIZE - start);
+    return 2 + len;
+}
+
+uint16_t sw_secp256k1_der_encode(const uint8_t r[SW_SECP256K1_SCALAR_SIZE],
+                                 const uint8_t s[SW_SECP256K1_SCALAR_SIZE],
+                                 uint8_t *out,
+                                 uint16_t outLen) {
+    uint8_t tmp[SW_SECP256K1_DER_MAX_SIZE];
+    uint8_t len = 2;
+    len += der_integer(r, tmp + len);
+    len += der_integer(s, tmp + len);
+    tmp[0] = 0x30;
+    tmp[1] = len - 2;
+
+    if (len > outLen) {
+        return 0;
+    }
+    memcpy(out, tmp, len);
+    return len;
+}
+
+#endif
@@ -0,0 +1,75 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#pragma once
+
+// Software secp256k1 for host builds (tests, simulator and benchmarks)
+// Not constant time: it must never handle real keys
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SW_SECP256K1_SCALAR_SIZE 32
+#define SW_SECP256K1_POINT_SIZE  65
+// DER encoded signature: 0x30 L 0x02 L r 0x02 L s
+#define SW_SECP256K1_DER_MAX_SIZE 72
+
+/// Whether k is a valid private key (0 < k < n)
+bool sw_secp256k1_scalar_is_valid(const uint8_t k[SW_SECP256K1_SCALAR_SIZE]);
+
+/// out = (a + b) mod n
+/// \return false if the result is zero
+bool sw_secp256k1_scalar_add(const uint8_t a[SW_SECP256K1_SCALAR_SIZE],
+                             const uint8_t b[SW_SECP256K1_SCALAR_SIZE],
+                             uint8_t out[SW_SECP256K1_SCALAR_SIZE]);
+
+/// Uncompressed public key (04 | X | Y) of a private key
+/// \return false if the private key is not valid
+bool sw_secp256k1_pubkey_create(const uint8_t privateKey[SW_SECP256K1_SCALAR_SIZE],
+                                uint8_t publicKey[SW_SECP256K1_POINT_SIZE]);
+
+/// out = a + b, all points uncompressed
+/// \return false if a point is not on the curve or the result is the point at infinity
+bool sw_secp256k1_point_add(const uint8_t a[SW_SECP256K1_POINT_SIZE],
+                            const uint8_t b[SW_SECP256K1_POINT_SIZE],
+                            uint8_t out[SW_SECP256K1_POINT_SIZE]);
+
+/// ECDSA with RFC6979 (HMAC-SHA256) nonces. As on the device, s is not normalized.
+/// \return false if the private key is not valid
+bool sw_secp256k1_sign(const uint8_t privateKey[SW_SECP256K1_SCALAR_SIZE],
+                       const uint8_t digest[32],
+                       uint8_t r[SW_SECP256K1_SCALAR_SIZE],
+                       uint8_t s[SW_SECP256K1_SCALAR_SIZE]);
+
+bool sw_secp256k1_verify(const uint8_t publicKey[SW_SECP256K1_POINT_SIZE],
+                         const uint8_t digest[32],
+                         const uint8_t r[SW_SECP256K1_SCALAR_SIZE],
+                         const uint8_t s[SW_SECP256K1_SCALAR_SIZE]);
+
+/// DER encoding of (r, s)
+/// \return encoded length or 0 if it does not fit
+uint16_t sw_secp256k1_der_encode(const uint8_t r[SW_SECP256K1_SCALAR_SIZE],
+                                 const uint8_t s[SW_SECP256K1_SCALAR_SIZE],
+                                 uint8_t *out,
+                                 uint16_t outLen);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,374 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#if !(defined(TARGET_NANOS) || defined(TARGET_NANOX) || defined(TARGET_NANOS2))
+
+#include <string.h>
+#include "sha2.h"
+
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define ROTR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const uint64_t sha512_k[80] = {
+    0x428a2f98d728ae22, 0x7137449123ef65cd, 0xb5c0fbcfec4d3b2f, 0xe9b5dba58189dbbc,
+    0x3956c25bf348b538, 0x59f111f1b605d019, 0x923f82a4af194f9b, 0xab1c5ed5da6d8118,
+    0xd807aa98a3030242, 0x12835b0145706fbe, 0x243185be4ee4b28c, 0x550c7dc3d5ffb4e2,
+    0x72be5d74f27b896f, 0x80deb1fe3b1696b1, 0x9bdc06a725c71235, 0xc19bf174cf692694,
+    0xe49b69c19ef14ad2, 0xefbe4786384f25e3, 0x0fc19dc68b8cd5b5, 0x240ca1cc77ac9c65,
+    0x2de92c6f592b0275, 0x4a7484aa6ea6e483, 0x5cb0a9dcbd41fbd4, 0x76f988da831153b5,
+    0x983e5152ee66dfab, 0xa831c66d2db43210, 0xb00327c898fb213f, 0xbf597fc7beef0ee4,
+    0xc6e00bf33da88fc2, 0xd5a79147930aa725, 0x06ca6351e003826f, 0x142929670a0e6e70,
+    0x27b70a8546d22ffc, 0x2e1b21385c26c926, 0x4d2c6dfc5ac42aed, 0x53380d139d95b3df,
+    0x650a73548baf63de, 0x766a0abb3c77b2a8, 0x81c2c92e47edaee6, 0x92722c851482353b,
+    0xa2bfe8a14cf10364, 0xa81a664bbc423001, 0xc24b8b70d0f89791, 0xc76c51a30654be30,
+    0xd192e819d6ef5218, 0xd69906245565a910, 0xf40e35855771202a, 0x106aa07032bbd1b8,
+    0x19a4c116b8d2d0c8, 0x1e376c085141ab53, 0x2748774cdf8eeb99, 0x34b0bcb5e19b48a8,
+    0x391c0cb3c5c95a63, 0x4ed8aa4ae3418acb, 0x5b9cca4f7763e373, 0x682e6ff3d6b2b8a3,
+    0x748f82ee5defb2fc, 0x78a5636f43172f60, 0x84c87814a1f0ab72, 0x8cc702081a6439ec,
+    0x90befffa23631e28, 0xa4506cebde82bde9, 0xbef9a3f7b2c67915, 0xc67178f2e372532b,
+    0xca273eceea26619c, 0xd186b8c721c0c207, 0xeada7dd6cde0eb1e, 0xf57d4f7fee6ed178,
+    0x06f067aa72176fba, 0x0a637dc5a2c898a6, 0x113f9804bef90dae, 0x1b710b35131c471b,
+    0x28db77f523047d84, 0x32caab7b40c72493, 0x3c9ebe0a15c9bebc, 0x431d67c49c100d4c,
+    0x4cc5d4becb3e42b6, 0x597f299cfc657e2a, 0x5fcb6fab3ad6faec, 0x6c44198c4a475817,
+};
+
+static void sha256_compress(uint32_t state[8], const uint8_t block[SW_SHA256_BLOCK_SIZE]) {
+    uint32_t w[64];
+    for (uint8_t i = 0; i < 16; i++) {
+        w[i] = (uint32_t) block[4 * i] << 24 | (uint32_t) block[4 * i + 1] << 16 |
+               (uint32_t) block[4 * i + 2] << 8 | (uint32_t) block[4 * i + 3];
+    }
+    for (uint8_t i = 16; i < 64; i++) {
+        const uint32_t s0 = ROTR32(w[i - 15], 7) ^ ROTR32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const uint32_t s1 = ROTR32(w[i - 2], 17) ^ ROTR32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (uint8_t i = 0; i < 64; i++) {
+        const uint32_t S1 = ROTR32(e, 6) ^ ROTR32(e, 11) ^ ROTR32(e, 25);
+        const uint32_t ch = (e & f) ^ (~e & g);
+        const uint32_t t1 = h + S1 + ch + sha256_k[i] + w[i];
+        const uint32_t S0 = ROTR32(a, 2) ^ ROTR32(a, 13) ^ ROTR32(a, 22);
+        const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        const uint32_t t2 = S0 + maj;
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+static void sha512_compress(uint64_t state[8], const uint8_t block[SW_SHA512_BLOCK_SIZE]) {
+    uint64_t w[80];
+    for (uint8_t i = 0; i < 16; i++) {
+        w[i] = 0;
+        for (uint8_t j = 0; j < 8; j++) {
+            w[i] = (w[i] << 8) | block[8 * i + j];
+        }
+    }
+    for (uint8_t i = 16; i < 80; i++) {
+        const uint64_t s0 = ROTR64(w[i - 15], 1) ^ ROTR64(w[i - 15], 8) ^ (w[i - 15] >> 7);
+        const uint64_t s1 = ROTR64(w[i - 2], 19) ^ ROTR64(w[i - 2], 61) ^ (w[i - 2] >> 6);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint64_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint64_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (uint8_t i = 0; i < 80; i++) {
+        const uint64_t S1 = ROTR64(e, 14) ^ ROTR64(e, 18) ^ ROTR64(e, 41);
+        const uint64_t ch = (e & f) ^ (~e & g);
+        const uint64_t t1 = h + S1 + ch + sha512_k[i] + w[i];
+        const uint64_t S0 = ROTR64(a, 28) ^ ROTR64(a, 34) ^ ROTR64(a, 39);
+        const uint64_t maj = (a & b) ^ (a & c) ^ (b & c);
+        const uint64_t t2 = S0 + maj;
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+void sw_sha256_init(sw_sha256_t *ctx) {
+    static const uint32_t iv[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+    memset(ctx, 0, sizeof(sw_sha256_t));
+    memcpy(ctx->state, iv, sizeof(iv));
+}
+
+void sw_sha256_update(sw_sha256_t *ctx, const uint8_t *in, size_t len) {
+    ctx->length += len;
+    while (len > 0) {
+        size_t n = SW_SHA256_BLOCK_SIZE - ctx->block_len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(ctx->block + ctx->block_len, in, n);
+        ctx->block_len += n;
+        in += n;
+        len -= n;
+        if (ctx->block_len == SW_SHA256_BLOCK_SIZE) {
+            sha256_compress(ctx->state, ctx->block);
+            ctx->block_len = 0;
+        }
+    }
+}
+
+void sw_sha256_final(sw_sha256_t *ctx, uint8_t out[SW_SHA256_SIZE]) {
+    const uint64_t bit_length = ctx->length * 8;
+
+    // Padding: 0x80, zeros and the big endian bit length
+    ctx->block[ctx->block_len++] = 0x80;
+    if (ctx->block_len > SW_SHA256_BLOCK_SIZE - 8) {
+        memset(ctx->block + ctx->block_len, 0, SW_SHA256_BLOCK_SIZE - ctx->block_len);
+        sha256_compress(ctx->state, ctx->block);
+        ctx->block_len = 0;
+    }
+    memset(ctx->block + ctx->block_len, 0, SW_SHA256_BLOCK_SIZE - 8 - ctx->block_len);
+    for (uint8_t i = 0; i < 8; i++) {
+        ctx->block[SW_SHA256_BLOCK_SIZE - 1 - i] = (uint8_t)(bit_length >> (8 * i));
+    }
+    sha256_compress(ctx->state, ctx->block);
+
+    for (uint8_t i = 0; i < 8; i++) {
+        out[4 * i] = (uint8_t)(ctx->state[i] >> 24);
+        out[4 * i + 1] = (uint8_t)(ctx->state[i] >> 16);
+        out[4 * i + 2] = (uint8_t)(ctx->state[i] >> 8);
+        out[4 * i + 3] = (uint8_t) ctx->state[i];
+    }
+    memset(ctx, 0, sizeof(sw_sha256_t));
+}
+
+void sw_sha256(const uint8_t *in, size_t len, uint8_t out[SW_SHA256_SIZE]) {
+    sw_sha256_t ctx;
+    sw_sha256_init(&ctx);
+    sw_sha256_update(&ctx, in, len);
+    sw_sha256_final(&ctx, out);
+}
+
+void sw_sha512_init(sw_sha512_t *ctx) {
+    static const uint64_t iv[8] = {
+        0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
+        0x510e527fade682d1, 0x9b05688c2b3e6c1f, 0x1f83d9abfb41bd6b, 0x5be0cd19137e2179,
+    };
+    memset(ctx, 0, sizeof(sw_sha512_t));
+    memcpy(ctx->state, iv, sizeof(iv));
+}
+
+void sw_sha512_update(sw_sha512_t *ctx, const uint8_t *in, size_t len) {
+    ctx->length += len;
+    while (len > 0) {
+        size_t n = SW_SHA512_BLOCK_SIZE - ctx->block_len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(ctx->block + ctx->block_len, in, n);
+        ctx->block_len += n;
+        in += n;
+        len -= n;
+        if (ctx->block_len == SW_SHA512_BLOCK_SIZE) {
+            sha512_compress(ctx->state, ctx->block);
+            ctx->block_len = 0;
+        }
+    }
+}
+
+void sw_sha512_final(sw_sha512_t *ctx, uint8_t out[SW_SHA512_SIZE]) {
+    const uint64_t bit_length = ctx->length * 8;
+
+    // Padding: 0x80, zeros and the 128-bit big endian bit length
+    ctx->block[ctx->block_len++] = 0x80;
+    if (ctx->block_len > SW_SHA512_BLOCK_SIZE - 16) {
+        memset(ctx->block + ctx->block_len, 0, SW_SHA512_BLOCK_SIZE - ctx->block_len);
+        sha512_compress(ctx->state, ctx->block);
+        ctx->block_len = 0;
+    }
+    memset(ctx->block + ctx->block_len, 0, SW_SHA512_BLOCK_SIZE - 8 - ctx->block_len);
+    for (uint8_t i = 0; i < 8; i++) {
+        ctx->block[SW_SHA512_BLOCK_SIZE - 1 - i] = (uint8_t)(bit_length >> (8 * i));
+    }
+    sha512_compress(ctx->state, ctx->block);
+
+    for (uint8_t i = 0; i < 8; i++) {
+        for (uint8_t j = 0; j < 8; j++) {
+            out[8 * i + j] = (uint8_t)(ctx->state[i] >> (56 - 8 * j));
+        }
+    }
+    memset(ctx, 0, sizeof(sw_sha512_t));
+}
+
+void sw_sha512(const uint8_t *in, size_t len, uint8_t out[SW_SHA512_SIZE]) {
+    sw_sha512_t ctx;
+    sw_sha512_init(&ctx);
+    sw_sha512_update(&ctx, in, len);
+    sw_sha512_final(&ctx, out);
+}
+
+void sw_hmac_sha256(const uint8_t *key,
+                    size_t key_len,
+                    const uint8_t *in,
+                    size_t len,
+                    uint8_t out[SW_SHA256_SIZE]) {
+    uint8_t pad[SW_SHA256_BLOCK_SIZE];
+    uint8_t key_block[SW_SHA256_BLOCK_SIZE];
+    memset(key_block, 0, sizeof(key_block));
+    if (key_len > SW_SHA256_BLOCK_SIZE) {
+        sw_sha256(key, key_len, key_block);
+    } else {
+        memcpy(key_block, key, key_len);
+    }
+
+    sw_sha256_t ctx;
+    uint8_t inner[SW_SHA256_SIZE];
+
+    for (uint8_t i = 0; i < SW_SHA256_BLOCK_SIZE; i++) {
+        pad[i] = key_block[i] ^ 0x36;
+    }
+    sw_sha256_init(&ctx);
+    sw_sha256_update(&ctx, pad, sizeof(pad));
+    sw_sha256_update(&ctx, in, len);
+    sw_sha256_final(&ctx, inner);
+
+    for (uint8_t i = 0; i < SW_SHA256_BLOCK_SIZE; i++) {
+        pad[i] = key_block[i] ^ 0x5c;
+    }
+    sw_sha256_init(&ctx);
+    sw_sha256_update(&ctx, pad, sizeof(pad));
+    sw_sha256_update(&ctx, inner, sizeof(inner));
+    sw_sha256_final(&ctx, out);
+
+    memset(key_block, 0, sizeof(key_block));
+    memset(pad, 0, sizeof(pad));
+}
+
+void sw_hmac_sha512(const uint8_t *key,
+                    size_t key_len,
+                    const uint8_t *in,
+                    size_t len,
+                    uint8_t out[SW_SHA512_SIZE]) {
+    uint8_t pad[SW_SHA512_BLOCK_SIZE];
+    uint8_t key_block[SW_SHA512_BLOCK_SIZE];
+    memset(key_block, 0, sizeof(key_block));
+    if (key_len > SW_SHA512_BLOCK_SIZE) {
+        sw_sha512(key, key_len, key_block);
+    } else {
+        memcpy(key_block, key, key_len);
+    }
+
+    sw_sha512_t ctx;
+    uint8_t inner[SW_SHA512_SIZE];
+
+    for (uint8_t i = 0; i < SW_SHA512_BLOCK_SIZE; i++) {
+        pad[i] = key_block[i] ^ 0x36;
+    }
+    sw_sha512_init(&ctx);
+    sw_sha512_update(&ctx, pad, sizeof(pad));
+    sw_sha512_update(&ctx, in, len);
+    sw_sha512_final(&ctx, inner);
+
+    for (uint8_t i = 0; i < SW_SHA512_BLOCK_SIZE; i++) {
+        pad[i] = key_block[i] ^ 0x5c;
+    }
+    sw_sha512_init(&ctx);
+    sw_sha512_update(&ctx, pad, sizeof(pad));
+    sw_sha512_update(&ctx, inner, sizeof(inner));
+    sw_sha512_final(&ctx, out);
+
+    memset(key_block, 0, sizeof(key_block));
+    memset(pad, 0, sizeof(pad));
+}
+
+void sw_pbkdf2_hmac_sha512(const uint8_t *pass,
+                           size_t pass_len,
+                           const uint8_t *salt,
+                           size_t salt_len,
+                           uint32_t iterations,
+                           uint8_t *out,
+                           size_t out_len) {
+    uint8_t salt_block[256];
+    if (salt_len + 4 > sizeof(salt_block)) {
+        memset(out, 0, out_len);
+        return;
+    }
+    memcpy(salt_block, salt, salt_len);
+
+    uint32_t block_index = 1;
+    while (out_len > 0) {
+        salt_block[salt_len] = (uint8_t)(block_index >> 24);
+        salt_block[salt_len + 1] = (uint8_t)(block_index >> 16);
+        salt_block[salt_len + 2] = (uint8_t)(block_index >> 8);
+        salt_block[salt_len + 3] = (uint8_t) block_index;
+
+        uint8_t u[SW_SHA512_SIZE];
+        uint8_t t[SW_SHA512_SIZE];
+        sw_hmac_sha512(pass, pass_len, salt_block, salt_len + 4, u);
+        memcpy(t, u, sizeof(t));
+        for (uint32_t i = 1; i < iterations; i++) {
+            sw_hmac_sha512(pass, pass_len, u, sizeof(u), u);
+            for (uint8_t j = 0; j < SW_SHA512_SIZE; j++) {
+                t[j] ^= u[j];
+            }
+        }
+
+        const size_t n = out_len < SW_SHA512_SIZE ? out_len : SW_SHA512_SIZE;
+        memcpy(out, t, n);
+        out += n;
+        out_len -= n;
+        block_index++;
+    }
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#pragma once
+
+// Software SHA-2 for host builds (tests, simulator and benchmarks)
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SW_SHA256_SIZE       32
+#define SW_SHA256_BLOCK_SIZE 64
+#define SW_SHA512_SIZE       64
+#define SW_SHA512_BLOCK_SIZE 128
+
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;
+    uint8_t block[SW_SHA256_BLOCK_SIZE];
+    uint8_t block_len;
+} sw_sha256_t;
+
+typedef struct {
+    uint64_t state[8];
+    uint64_t length;
+    uint8_t block[SW_SHA512_BLOCK_SIZE];
+    uint8_t block_len;
+} sw_sha512_t;
+
+void sw_sha256_init(sw_sha256_t *ctx);
+void sw_sha256_update(sw_sha256_t *ctx, const uint8_t *in, size_t len);
+void sw_sha256_final(sw_sha256_t *ctx, uint8_t out[SW_SHA256_SIZE]);
+void sw_sha256(const uint8_t *in, size_t len, uint8_t out[SW_SHA256_SIZE]);
+
+void sw_sha512_init(sw_sha512_t *ctx);
+void sw_sha512_update(sw_sha512_t *ctx, const uint8_t *in, size_t len);
+void sw_sha512_final(sw_sha512_t *ctx, uint8_t out[SW_SHA512_SIZE]);
+void sw_sha512(const uint8_t *in, size_t len, uint8_t out[SW_SHA512_SIZE]);
+
+void sw_hmac_sha256(const uint8_t *key,
+                    size_t key_len,
+                    const uint8_t *in,
+                    size_t len,
+                    uint8_t out[SW_SHA256_SIZE]);
+
+void sw_hmac_sha512(const uint8_t *key,
+                    size_t key_len,
+                    const uint8_t *in,
+                    size_t len,
+                    uint8_t out[SW_SHA512_SIZE]);
+
+/// PBKDF2 with HMAC-SHA512 (as used by BIP39)
+void sw_pbkdf2_hmac_sha512(const uint8_t *pass,
+                           size_t pass_len,
+                           const uint8_t *salt,
+                           size_t salt_len,
+                           uint32_t iterations,
+                           uint8_t *out,
+                           size_t out_len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,237 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+
+#if !(defined(TARGET_NANOS) || defined(TARGET_NANOX) || defined(TARGET_NANOS2))
+
+#include <pthread.h>
+#include <string.h>
+#include "tx_result_cache.h"
+#include "sha2.h"
+#include "common/parser.h"
+#include "app_mode.h"
+
+typedef struct {
+    bool used;
+    uint8_t digest[SW_SHA256_SIZE];
+    // expert mode shows more items, results of both modes are kept apart
+    bool expert;
+    // last lookup or store, the entry with the lowest tick is evicted first
+    uint32_t tick;
+    tx_result_t result;
+} result_cache_entry_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    uint32_t tick;
+    uint64_t hits;
+    uint64_t misses;
+    result_cache_entry_t entries[TX_RESULT_CACHE_SHARD_ENTRIES];
+} result_cache_shard_t;
+
+static result_cache_shard_t shards[TX_RESULT_CACHE_SHARDS];
+static pthread_once_t shards_once = PTHREAD_ONCE_INIT;
+
+// parser_parse keeps its state in globals
+static pthread_mutex_t parser_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void shards_init() {
+    for (uint16_t i = 0; i < TX_RESULT_CACHE_SHARDS; i++) {
+        pthread_mutex_init(&shards[i].lock, NULL);
+    }
+}
+
+static result_cache_shard_t *get_shard(const uint8_t digest[SW_SHA256_SIZE]) {
+    pthread_once(&shards_once, shards_init);
+    return &shards[digest[0] % TX_RESULT_CACHE_SHARDS];
+}
+
+// Only the used bytes of text are copied
+static void copy_result(tx_result_t *dst, const tx_result_t *src) {
+    dst->verdict = src->verdict;
+    dst->num_items = src->num_items;
+    dst->truncated = src->truncated;
+    dst->text_len = src->text_len;
+    memcpy(dst->text, src->text, src->text_len);
+}
+
+static result_cache_entry_t *find_entry(result_cache_shard_t *shard,
+                                        const uint8_t digest[SW_SHA256_SIZE],
+                                        bool expert) {
+    for (uint16_t i = 0; i < TX_RESULT_CACHE_SHARD_ENTRIES; i++) {
+        result_cache_entry_t *entry = &shard->entries[i];
+        if (entry->used && entry->expert == expert &&
+            !memcmp(entry->digest, digest, SW_SHA256_SIZE)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static result_cache_entry_t *evict_entry(result_cache_shard_t *shard) {
+    result_cache_entry_t *victim = &shard->entries[0];
+    for (uint16_t i = 0; i < TX_RESULT_CACHE_SHARD_ENTRIES; i++) {
+        result_cache_entry_t *entry = &shard->entries[i];
+        if (!entry->used) {
+            return entry;
+        }
+        if (entry->tick < victim->tick) {
+            victim = entry;
+        }
+    }
+    return victim;
+}
+
+static void render_items(const parser_context_t *ctx, tx_result_t *result) {
+    uint16_t num_items = 0;
+    if (parser_getNumItems(ctx, &num_items) != parser_ok) {
+        result->truncated = true;
+        return;
+    }
+
+    for (uint16_t i = 0; i < num_items; i++) {
+        char key[TX_RESULT_KEY_SIZE];
+        const uint16_t text_len = result->text_len;
+        const uint16_t value_len = TX_RESULT_TEXT_SIZE - text_len;
+        uint8_t pageCount = 0;
+        if (value_len < 2) {
+            result->truncated = true;
+            return;
+        }
+
+        // The value is written in place, right after its key
+        if (parser_getItem(ctx, i, key, sizeof(key), result->text + text_len, value_len, 0,
+                           &pageCount) != parser_ok ||
+            pageCount != 1) {
+            result->truncated = true;
+            return;
+        }
+
+        // Move the value to make room for the key
+        const size_t key_size = strlen(key) + 1;
+        const size_t value_size = strlen(result->text + text_len) + 1;
+        if (key_size + value_size > value_len) {
+            result->truncated = true;
+            return;
+        }
+        memmove(result->text + text_len + key_size, result->text + text_len, value_size);
+        memcpy(result->text + text_len, key, key_size);
+        result->text_len += key_size + value_size;
+        result->num_items++;
+    }
+}
+
+static void process_tx(const uint8_t *data, size_t dataLen, tx_result_t *result) {
+    result->num_items = 0;
+    result->truncated = false;
+    result->text_len = 0;
+
+    parser_context_t ctx;
+    result->verdict = parser_parse(&ctx, data, dataLen);
+    if (result->verdict == parser_ok) {
+        result->verdict = parser_validate(&ctx);
+    }
+    if (result->verdict == parser_ok) {
+        render_items(&ctx, result);
+    }
+}
+
+parser_error_t tx_result_cache_process(const uint8_t *data, size_t dataLen, tx_result_t *result) {
+    uint8_t digest[SW_SHA256_SIZE];
+    sw_sha256(data, dataLen, digest);
+    result_cache_shard_t *shard = get_shard(digest);
+
+    // A hit was rendered in the mode it is stored under
+    pthread_mutex_lock(&shard->lock);
+    result_cache_entry_t *entry = find_entry(shard, digest, app_mode_expert());
+    if (entry != NULL) {
+        shard->hits++;
+        entry->tick = ++shard->tick;
+        copy_result(result, &entry->result);
+        pthread_mutex_unlock(&shard->lock);
+        return result->verdict;
+    }
+    shard->misses++;
+    pthread_mutex_unlock(&shard->lock);
+
+    // The mode may change before the parser is free, the result is stored under the mode it was
+    // rendered with
+    pthread_mutex_lock(&parser_lock);
+    const bool expert = app_mode_expert();
+    process_tx(data, dataLen, result);
+    pthread_mutex_unlock(&parser_lock);
+
+    // Another thread may have stored the same payload meanwhile
+    pthread_mutex_lock(&shard->lock);
+    entry = find_entry(shard, digest, expert);
+    if (entry == NULL) {
+        entry = evict_entry(shard);
+        entry->used = true;
+        memcpy(entry->digest, digest, SW_SHA256_SIZE);
+        entry->expert = expert;
+    }
+    entry->tick = ++shard->tick;
+    copy_result(&entry->result, result);
+    pthread_mutex_unlock(&shard->lock);
+
+    return result->verdict;
+}
+
+parser_error_t tx_result_getItem(const tx_result_t *result,
+                                 uint16_t item_idx,
+                                 const char **key,
+                                 const char **value) {
+    if (item_idx >= result->num_items) {
+        return parser_display_idx_out_of_range;
+    }
+
+    const char *p = result->text;
+    for (uint16_t i = 0; i < item_idx; i++) {
+        p += strlen(p) + 1;
+        p += strlen(p) + 1;
+    }
+    *key = p;
+    *value = p + strlen(p) + 1;
+    return parser_ok;
+}
+
+void tx_result_cache_clear() {
+    pthread_once(&shards_once, shards_init);
+    for (uint16_t i = 0; i < TX_RESULT_CACHE_SHARDS; i++) {
+        result_cache_shard_t *shard = &shards[i];
+        pthread_mutex_lock(&shard->lock);
+        shard->tick = 0;
+        shard->hits = 0;
+        shard->misses = 0;
+        memset(shard->entries, 0, sizeof(shard->entries));
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
+
+void tx_result_cache_stats(uint64_t *hits, uint64_t *misses) {
+    pthread_once(&shards_once, shards_init);
+    *hits = 0;
+    *misses = 0;
+    for (uint16_t i = 0; i < TX_RESULT_CACHE_SHARDS; i++) {
+        result_cache_shard_t *shard = &shards[i];
+        pthread_mutex_lock(&shard->lock);
+        *hits += shard->hits;
+        *misses += shard->misses;
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
+
+#endif
@@ -0,0 +1,78 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+
+#pragma once
+
+// Results of parser_parse, parser_validate and the rendered items for host services that see
+// the same tx bytes repeatedly. Entries are keyed by the SHA-256 of the payload and kept in
+// shards, each with its own lock, so lookups from several threads rarely wait on each other.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "common/parser_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TX_RESULT_CACHE_SHARDS        16
+#define TX_RESULT_CACHE_SHARD_ENTRIES 8
+// Rendered items as "key\0value\0", values are not split in pages
+#define TX_RESULT_TEXT_SIZE 4096
+#define TX_RESULT_KEY_SIZE  64
+
+typedef struct {
+    // first error of parser_parse or parser_validate
+    parser_error_t verdict;
+    uint16_t num_items;
+    // items that did not fit in text or could not be rendered are left out
+    bool truncated;
+    uint16_t text_len;
+    char text[TX_RESULT_TEXT_SIZE];
+} tx_result_t;
+
+/// Parse, validate and render a tx, repeated payloads are served from the cache.
+/// The parser keeps a single tx, so misses are processed one at a time.
+/// \param data: tx bytes
+/// \param dataLen
+/// \param result: filled with the verdict and, for valid txs, the rendered items
+/// \return verdict
+parser_error_t tx_result_cache_process(const uint8_t *data, size_t dataLen, tx_result_t *result);
+
+/// Key and value of a rendered item
+/// \param result
+/// \param item_idx
+/// \param key: terminated string inside result
+/// \param value: terminated string inside result
+/// \return parser_display_idx_out_of_range if the item does not exist
+parser_error_t tx_result_getItem(const tx_result_t *result,
+                                 uint16_t item_idx,
+                                 const char **key,
+                                 const char **value);
+
+/// Drop all entries and reset the counters
+void tx_result_cache_clear();
+
+/// Lookups since the last clear, added up over all shards
+/// \param hits
+/// \param misses
+void tx_result_cache_stats(uint64_t *hits, uint64_t *misses);
+
+#ifdef __cplusplus
+}
+#endif
@@ -19,79 +19,485 @@
 #include <common/parser_common.h>
 #include "json_parser.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #define EQUALS(_P, _Q, _LEN) (MEMCMP(PIC(_P), PIC(_Q), (_LEN)) == 0)
 
-parser_error_t json_parse(parsed_json_t *parsed_json, const char *buffer, uint16_t bufferLen) {
+#define SP JSON_CHAR_SPACE
+#define CT JSON_CHAR_CONTROL
+#define ST JSON_CHAR_STRUCTURAL
+#define ES JSON_CHAR_ESCAPE
+#define UC JSON_CHAR_UTF8_CONT
+#define U2 JSON_CHAR_UTF8_LEAD2
+#define U3 JSON_CHAR_UTF8_LEAD3
+#define U4 JSON_CHAR_UTF8_LEAD4
+// 0xc0, 0xc1 and bytes from 0xf5 never appear in UTF-8
+const uint8_t json_char_class[256] = {
+    /* 0x00 */ CT, CT, CT, CT, CT, CT, CT, CT,
+    /* 0x08 */ CT, SP | CT, SP | CT, SP | CT, SP | CT, SP | CT, CT, CT,
+    /* 0x10 */ CT, CT, CT, CT, CT, CT, CT, CT,
+    /* 0x18 */ CT, CT, CT, CT, CT, CT, CT, CT,
+    /* 0x20 */ SP, 0, ST, 0, 0, 0, 0, 0,
+    /* 0x28 */ 0, 0, 0, 0, ST, 0, 0, 0,
+    /* 0x30 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 0x38 */ 0, 0, ST, 0, 0, 0, 0, 0,
+    /* 0x40 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 0x48 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 0x50 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 0x58 */ 0, 0, 0, ST, ES, ST, 0, 0,
+    /* 0x60 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 0x68 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 0x70 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 0x78 */ 0, 0, 0, ST, 0, ST, 0, 0,
+    /* 0x80 */ UC, UC, UC, UC, UC, UC, UC, UC,
+    /* 0x88 */ UC, UC, UC, UC, UC, UC, UC, UC,
+    /* 0x90 */ UC, UC, UC, UC, UC, UC, UC, UC,
+    /* 0x98 */ UC, UC, UC, UC, UC, UC, UC, UC,
+    /* 0xa0 */ UC, UC, UC, UC, UC, UC, UC, UC,
+    /* 0xa8 */ UC, UC, UC, UC, UC, UC, UC, UC,
+    /* 0xb0 */ UC, UC, UC, UC, UC, UC, UC, UC,
+    /* 0xb8 */ UC, UC, UC, UC, UC, UC, UC, UC,
+    /* 0xc0 */ 0, 0, U2, U2, U2, U2, U2, U2,
+    /* 0xc8 */ U2, U2, U2, U2, U2, U2, U2, U2,
+    /* 0xd0 */ U2, U2, U2, U2, U2, U2, U2, U2,
+    /* 0xd8 */ U2, U2, U2, U2, U2, U2, U2, U2,
+    /* 0xe0 */ U3, U3, U3, U3, U3, U3, U3, U3,
+    /* 0xe8 */ U3, U3, U3, U3, U3, U3, U3, U3,
+    /* 0xf0 */ U4, U4, U4, U4, U4, 0, 0, 0,
+    /* 0xf8 */ 0, 0, 0, 0, 0, 0, 0, 0,
+};
+#undef SP
+#undef CT
+#undef ST
+#undef ES
+#undef UC
+#undef U2
+#undef U3
+#undef U4
+
+// Whitespace and control characters are all below 0x21
+#define JSON_CHAR_LOW_CLASSES (JSON_CHAR_SPACE | JSON_CHAR_CONTROL)
+
+uint32_t json_find_char_class(const char *buffer, uint32_t len, uint8_t char_class) {
+    const uint8_t *classes = (const uint8_t *) PIC(json_char_class);
+    uint32_t i = 0;
+
+#if defined(__SSE2__)
+    // Skip 16 byte blocks without any byte below 0x21, only blocks with candidates are
+    // classified byte by byte
+    if ((char_class & ~JSON_CHAR_LOW_CLASSES) == 0) {
+        const __m128i limit = _mm_set1_epi8(0x20);
+        while (i + 16 <= len) {
+            const __m128i block = _mm_loadu_si128((const __m128i *) (buffer + i));
+            const __m128i low = _mm_cmpeq_epi8(_mm_min_epu8(block, limit), block);
+            if (_mm_movemask_epi8(low) != 0) {
+                break;
+            }
+            i += 16;
+        }
+    }
+#endif
+
+    for (; i < len; i++) {
+        if (classes[(uint8_t) buffer[i]] & char_class) {
+            return i;
+        }
+    }
+    return len;
+}
+
+parser_error_t json_read_hex4(const char *buffer, uint32_t len, uint16_t *value) {
+    *value = 0;
+    if (len < 4) {
+        return parser_json_invalid_escape;
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        const char c = buffer[i];
+        uint8_t digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else {
+            return parser_json_invalid_escape;
+        }
+        *value = (*value << 4) | digit;
+    }
+    return parser_ok;
+}
+
+// Validate the escape sequence at buffer[*i], a \u escape of a high surrogate must be
+// followed by the low surrogate
+__Z_INLINE parser_error_t json_validate_escape(const char *buffer, uint32_t len, uint32_t *i) {
+    if (*i + 1 >= len) {
+        return parser_json_invalid_escape;
+    }
+
+    switch (buffer[*i + 1]) {
+        case '"':
+        case '\\':
+        case '/':
+        case 'b':
+        case 'f':
+        case 'n':
+        case 'r':
+        case 't':
+            *i += 2;
+            return parser_ok;
+        case 'u':
+            break;
+        default:
+            return parser_json_invalid_escape;
+    }
+
+    uint16_t code_unit;
+    CHECK_PARSER_ERR(json_read_hex4(buffer + *i + 2, len - *i - 2, &code_unit))
+    *i += 6;
+
+    if (code_unit >= 0xDC00 && code_unit <= 0xDFFF) {
+        return parser_json_invalid_escape;
+    }
+    if (code_unit >= 0xD800 && code_unit <= 0xDBFF) {
+        if (*i + 1 >= len || buffer[*i] != '\\' || buffer[*i + 1] != 'u') {
+            return parser_json_invalid_escape;
+        }
+        CHECK_PARSER_ERR(json_read_hex4(buffer + *i + 2, len - *i - 2, &code_unit))
+        if (code_unit < 0xDC00 || code_unit > 0xDFFF) {
+            return parser_json_invalid_escape;
+        }
+        *i += 6;
+    }
+    return parser_ok;
+}
+
+// Validate the UTF-8 sequence at buffer[*i], overlong encodings, surrogates and code
+// points above U+10FFFF are rejected
+__Z_INLINE parser_error_t json_validate_utf8(const uint8_t *classes,
+                                             const char *buffer,
+                                             uint32_t len,
+                                             uint32_t *i) {
+    const uint8_t lead = (uint8_t) buffer[*i];
+    const uint8_t lead_class = classes[lead];
+    uint8_t num_cont;
+    uint8_t min = 0x80;
+    uint8_t max = 0xBF;
+
+    if (lead_class & JSON_CHAR_UTF8_LEAD2) {
+        num_cont = 1;
+    } else if (lead_class & JSON_CHAR_UTF8_LEAD3) {
+        num_cont = 2;
+        min = lead == 0xE0 ? 0xA0 : min;
+        max = lead == 0xED ? 0x9F : max;
+    } else if (lead_class & JSON_CHAR_UTF8_LEAD4) {
+        num_cont = 3;
+        min = lead == 0xF0 ? 0x90 : min;
+        max = lead == 0xF4 ? 0x8F : max;
+    } else {
+        return parser_json_invalid_utf8;
+    }
+
+    if (len - *i <= num_cont) {
+        return parser_json_invalid_utf8;
+    }
+    const uint8_t first = (uint8_t) buffer[*i + 1];
+    if (first < min || first > max) {
+        return parser_json_invalid_utf8;
+    }
+    for (uint8_t j = 2; j <= num_cont; j++) {
+        if (!(classes[(uint8_t) buffer[*i + j]] & JSON_CHAR_UTF8_CONT)) {
+            return parser_json_invalid_utf8;
+        }
+    }
+
+    *i += num_cont + 1;
+    return parser_ok;
+}
+
+parser_error_t json_validate_string(const char *buffer, uint32_t len, bool *is_ascii) {
+    const uint8_t *classes = (const uint8_t *) PIC(json_char_class);
+    *is_ascii = true;
+
+    uint32_t i = 0;
+    while (i < len) {
+#if defined(__SSE2__)
+        // Blocks without escapes or bytes from 0x80 need no further checks
+        const __m128i backslash = _mm_set1_epi8('\\');
+        while (i + 16 <= len) {
+            const __m128i block = _mm_loadu_si128((const __m128i *) (buffer + i));
+            const __m128i escapes = _mm_cmpeq_epi8(block, backslash);
+            if ((_mm_movemask_epi8(block) | _mm_movemask_epi8(escapes)) != 0) {
+                break;
+            }
+            i += 16;
+        }
+        // Check the current block byte by byte, then go back to skipping blocks
+        const uint32_t block_end = len - i > 16 ? i + 16 : len;
+#else
+        const uint32_t block_end = len;
+#endif
+
+        while (i < block_end) {
+            const uint8_t c = (uint8_t) buffer[i];
+            if (c < 0x80 && !(classes[c] & JSON_CHAR_ESCAPE)) {
+                i++;
+                continue;
+            }
+
+            *is_ascii = false;
+            if (c < 0x80) {
+                CHECK_PARSER_ERR(json_validate_escape(buffer, len, &i))
+            } else {
+                CHECK_PARSER_ERR(json_validate_utf8(classes, buffer, len, &i))
+            }
+        }
+    }
+
+    return parser_ok;
+}
+
+parser_error_t json_decode_string(const char *buffer,
+                                  uint32_t len,
+                                  char *out,
+                                  uint16_t out_len,
+                                  uint16_t *out_written) {
+    const uint8_t *classes = (const uint8_t *) PIC(json_char_class);
+    *out_written = 0;
+
+    uint32_t i = 0;
+    while (i < len) {
+        if (*out_written >= out_len) {
+            return parser_value_out_of_range;
+        }
+
+        const uint8_t c = (uint8_t) buffer[i];
+        char decoded = '.';
+        if (c >= 0x80) {
+            // One placeholder per code point
+            i++;
+            while (i < len && (classes[(uint8_t) buffer[i]] & JSON_CHAR_UTF8_CONT)) {
+                i++;
+            }
+        } else if (c == '\\' && i + 1 < len && buffer[i + 1] == 'u') {
+            uint16_t code_unit;
+            CHECK_PARSER_ERR(json_read_hex4(buffer + i + 2, len - i - 2, &code_unit))
+            i += 6;
+            if (code_unit >= 0x20 && code_unit < 0x7F) {
+                decoded = (char) code_unit;
+            }
+            // The low surrogate belongs to the same code point
+            if (code_unit >= 0xD800 && code_unit <= 0xDBFF) {
+                i += 6;
+            }
+        } else if (c == '\\' && i + 1 < len) {
+            const char escaped = buffer[i + 1];
+            if (escaped == '"' || escaped == '\\' || escaped == '/') {
+                decoded = escaped;
+            }
+            i += 2;
+        } else {
+            if (!(classes[c] & JSON_CHAR_CONTROL)) {
+                decoded = (char) c;
+            }
+            i++;
+        }
+
+        out[(*out_written)++] = decoded;
+    }
+
+    return parser_ok;
+}
+
+uint64_t json_hash(uint64_t hash, const void *data, uint32_t len) {
+    const uint8_t *bytes = (const uint8_t *) data;
+    for (uint32_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+__Z_INLINE parser_error_t json_parse_error(int32_t jsmn_error) {
+    switch (jsmn_error) {
+        case JSMN_ERROR_NOMEM:
+            return parser_json_too_many_tokens;
+        case JSMN_ERROR_INVAL:
+            return parser_unexpected_characters;
+        case JSMN_ERROR_PART:
+            return parser_json_incomplete_json;
+        default:
+            return parser_json_unexpected_error;
+    }
+}
+
+#if defined(JSON_SOA_TOKENS)
+// Split the jsmn output into the arena columns and link every token to its next sibling
+static void json_split_tokens(const json_token_arena_t *arena, uint16_t num_tokens) {
+    for (uint16_t i = 0; i < num_tokens; i++) {
+        arena->type[i] = (uint8_t) arena->tokens[i].type;
+        arena->start[i] = arena->tokens[i].start;
+        arena->end[i] = arena->tokens[i].end;
+    }
+
+    // Children always follow their parent and start before it ends
+    for (int32_t i = num_tokens - 1; i >= 0; i--) {
+        uint16_t next = i + 1;
+        while (next < num_tokens && arena->start[next] < arena->end[i]) {
+            next = arena->skip[next];
+        }
+        arena->skip[i] = next;
+    }
+}
+#endif
+
+parser_error_t json_parse(parsed_json_t *parsed_json,
+                          const json_token_arena_t *arena,
+                          const char *buffer,
+                          uint32_t bufferLen) {
     jsmn_parser parser;
     jsmn_init(&parser);
 
-    MEMZERO(parsed_json, sizeof(parsed_json_t));
+    // The arena is not cleared, jsmn initializes every token it hands out and only
+    // the first numberOfTokens tokens are ever read
+    parsed_json->isValid = 0;
+    parsed_json->numberOfTokens = 0;
+    parsed_json->maxTokens = 0;
+    parsed_json->buffer = NULL;
+    parsed_json->bufferLen = 0;
+    parsed_json->generation++;
+    parsed_json->fingerprint = 0;
+
+    if (bufferLen > JSON_MAX_BUFFER_LEN) {
+        return parser_value_out_of_range;
+    }
+    if (arena == NULL || arena->tokens == NULL || arena->ascii == NULL) {
+        return parser_no_data;
+    }
+#if defined(JSON_SOA_TOKENS)
+    parsed_json->tokenType = arena->type;
+    parsed_json->tokenStart = arena->start;
+    parsed_json->tokenEnd = arena->end;
+    parsed_json->tokenSkip = arena->skip;
+#else
+    parsed_json->tokens = arena->tokens;
+#endif
+    parsed_json->tokenAscii = arena->ascii;
+    parsed_json->maxTokens = arena->capacity;
     parsed_json->buffer = buffer;
     parsed_json->bufferLen = bufferLen;
 
     int32_t num_tokens = jsmn_parse(&parser,
                                     parsed_json->buffer,
                                     parsed_json->bufferLen,
-                                    parsed_json->tokens,
-                                    MAX_NUMBER_OF_TOKENS);
+                                    arena->tokens,
+                                    arena->capacity);
 
     if (num_tokens < 0) {
-        switch (num_tokens) {
-            case JSMN_ERROR_NOMEM:
-                return parser_json_too_many_tokens;
-            case JSMN_ERROR_INVAL:
-                return parser_unexpected_characters;
-            case JSMN_ERROR_PART:
-                return parser_json_incomplete_json;
-            default:
-                return parser_json_unexpected_error;
-        }
+        return json_parse_error(num_tokens);
     }
 
-    parsed_json->numberOfTokens = 0;
-    parsed_json->isValid = 0;
-
     // Parsing error
     if (num_tokens <= 0) {
         return parser_json_zero_tokens;
     }
 
     // We cannot support if number of tokens exceeds the limit
-    if (num_tokens > MAX_NUMBER_OF_TOKENS) {
+    if (num_tokens > arena->capacity) {
         return parser_json_too_many_tokens;
     }
 
+#if defined(DISPLAY_PLAN_CACHE)
+    uint64_t fingerprint = JSON_HASH_INIT;
+#endif
+    for (int32_t i = 0; i < num_tokens; i++) {
+        const jsmntok_t *token = &arena->tokens[i];
+        bool is_ascii = false;
+
+#if defined(DISPLAY_PLAN_CACHE)
+        // Keys are the strings that have a child, their value
+        const bool is_key = token->type == JSMN_STRING && token->size > 0;
+        const uint16_t key_len = is_key ? (uint16_t) (token->end - token->start) : 0;
+        const uint8_t shape[5] = {(uint8_t) token->type,
+                                  (uint8_t) (token->size & 0xFF),
+                                  (uint8_t) ((token->size >> 8) & 0xFF),
+                                  (uint8_t) (key_len & 0xFF),
+                                  (uint8_t) (key_len >> 8)};
+        fingerprint = json_hash(fingerprint, shape, sizeof(shape));
+        fingerprint = json_hash(fingerprint, buffer + token->start, key_len);
+#endif
+
+        if (token->type == JSMN_STRING || token->type == JSMN_PRIMITIVE) {
+#if defined(JSMN_WIDE_TOKENS)
+            // Offsets are 32-bit, but token lengths must still fit the display code
+            if (token->end - token->start > JSON_MAX_TOKEN_LEN) {
+                return parser_value_out_of_range;
+            }
+#endif
+            CHECK_PARSER_ERR(json_validate_string(buffer + token->start,
+                                                  token->end - token->start,
+                                                  &is_ascii))
+        }
+
+        if (is_ascii) {
+            arena->ascii[i >> 3] |= (uint8_t) (1u << (i & 7));
+        } else {
+            arena->ascii[i >> 3] &= (uint8_t) ~(1u << (i & 7));
+        }
+    }
+
+#if defined(JSON_SOA_TOKENS)
+    json_split_tokens(arena, num_tokens);
+#endif
+
     parsed_json->numberOfTokens = num_tokens;
+#if defined(DISPLAY_PLAN_CACHE)
+    parsed_json->fingerprint = fingerprint;
+#endif
     parsed_json->isValid = true;
 
     return parser_ok;
 }
 
+parser_error_t json_count_tokens(const char *buffer, uint32_t bufferLen, uint16_t *num_tokens) {
+    *num_tokens = 0;
+    if (bufferLen > JSON_MAX_BUFFER_LEN) {
+        return parser_value_out_of_range;
+    }
+
+    jsmn_parser parser;
+    jsmn_init(&parser);
+    const int32_t count = jsmn_parse(&parser, buffer, bufferLen, NULL, 0);
+    if (count < 0) {
+        return json_parse_error(count);
+    }
+    if (count == 0) {
+        return parser_json_zero_tokens;
+    }
+    if (count > UINT16_MAX) {
+        return parser_json_too_many_tokens;
+    }
+
+    *num_tokens = (uint16_t) count;
+    return parser_ok;
+}
+
+
 parser_error_t array_get_element_count(const parsed_json_t *json,
                                        uint16_t array_token_index,
                                        uint16_t *number_elements) {
     *number_elements = 0;
-    if (array_token_index < 0 || array_token_index > json->numberOfTokens) {
+    if (array_token_index >= json->numberOfTokens) {
         return parser_no_data;
     }
 
-    jsmntok_t array_token = json->tokens[array_token_index];
-    uint16_t token_index = array_token_index;
-    uint16_t prev_element_end = array_token.start;
-    while (true) {
-        token_index++;
-        if (token_index >= json->numberOfTokens) {
-            break;
-        }
-        jsmntok_t current_token = json->tokens[token_index];
-        if (current_token.start > array_token.end) {
-            break;
-        }
-        if (current_token.start <= prev_element_end) {
-            continue;
-        }
-        prev_element_end = current_token.end;
+    const jsmnint_t array_end = JSON_TOKEN_END(json, array_token_index);
+    uint16_t token_index = array_token_index + 1;
+    while (token_index < json->numberOfTokens && JSON_TOKEN_START(json, token_index) < array_end) {
         (*number_elements)++;
+        token_index = JSON_TOKEN_SKIP(json, token_index);
     }
 
     return parser_ok;
@@ -101,32 +507,20 @@ parser_error_t array_get_nth_element(const parsed_json_t *json,
                                      uint16_t array_token_index,
                                      uint16_t element_index,
                                      uint16_t *token_index) {
-    if (array_token_index < 0 || array_token_index > json->numberOfTokens) {
+    if (array_token_index >= json->numberOfTokens) {
         return parser_no_data;
     }
 
-    jsmntok_t array_token = json->tokens[array_token_index];
-    *token_index = array_token_index;
-
+    const jsmnint_t array_end = JSON_TOKEN_END(json, array_token_index);
+    *token_index = array_token_index + 1;
     uint16_t element_count = 0;
-    uint16_t prev_element_end = array_token.start;
-    while (true) {
-        (*token_index)++;
-        if (*token_index >= json->numberOfTokens) {
-            break;
-        }
-        jsmntok_t current_token = json->tokens[*token_index];
-        if (current_token.start > array_token.end) {
-            break;
-        }
-        if (current_token.start <= prev_element_end) {
-            continue;
-        }
-        prev_element_end = current_token.end;
+    while (*token_index < json->numberOfTokens &&
+           JSON_TOKEN_START(json, *token_index) < array_end) {
         if (element_count == element_index) {
             return parser_ok;
         }
         element_count++;
+        *token_index = JSON_TOKEN_SKIP(json, *token_index);
     }
 
     return parser_no_data;
@@ -136,28 +530,17 @@ parser_error_t object_get_element_count(const parsed_json_t *json,
                                         uint16_t object_token_index,
                                         uint16_t *element_count) {
     *element_count = 0;
-    if (object_token_index < 0 || object_token_index > json->numberOfTokens) {
+    if (object_token_index >= json->numberOfTokens) {
         return parser_no_data;
     }
 
-    jsmntok_t object_token = json->tokens[object_token_index];
-    uint16_t token_index = object_token_index;
-    uint16_t prev_element_end = object_token.start;
-    token_index++;
-    while (true) {
-        if (token_index >= json->numberOfTokens) {
-            break;
-        }
-        jsmntok_t key_token = json->tokens[token_index++];
-        jsmntok_t value_token = json->tokens[token_index];
-        if (key_token.start > object_token.end) {
-            break;
-        }
-        if (key_token.start <= prev_element_end) {
-            continue;
-        }
-        prev_element_end = value_token.end;
+    // Keys are followed by their value
+    const jsmnint_t object_end = JSON_TOKEN_END(json, object_token_index);
+    uint16_t key_index = object_token_index + 1;
+    while ((uint32_t) key_index + 1 < json->numberOfTokens &&
+           JSON_TOKEN_START(json, key_index) < object_end) {
         (*element_count)++;
+        key_index = JSON_TOKEN_SKIP(json, key_index + 1);
     }
 
     return parser_ok;
@@ -168,32 +551,21 @@ parser_error_t object_get_nth_key(const parsed_json_t *json,
                                   uint16_t object_element_index,
                                   uint16_t *token_index) {
     *token_index = object_token_index;
-    if (object_token_index < 0 || object_token_index > json->numberOfTokens) {
+    if (object_token_index >= json->numberOfTokens) {
         return parser_no_data;
     }
 
-    jsmntok_t object_token = json->tokens[object_token_index];
+    const jsmnint_t object_end = JSON_TOKEN_END(json, object_token_index);
+    uint16_t key_index = object_token_index + 1;
     uint16_t element_count = 0;
-    uint16_t prev_element_end = object_token.start;
-    (*token_index)++;
-    while (true) {
-        if (*token_index >= json->numberOfTokens) {
-            break;
-        }
-        jsmntok_t key_token = json->tokens[(*token_index)++];
-        jsmntok_t value_token = json->tokens[*token_index];
-        if (key_token.start > object_token.end) {
-            break;
-        }
-        if (key_token.start <= prev_element_end) {
-            continue;
-        }
-        prev_element_end = value_token.end;
+    while ((uint32_t) key_index + 1 < json->numberOfTokens &&
+           JSON_TOKEN_START(json, key_index) < object_end) {
         if (element_count == object_element_index) {
-            (*token_index)--;
+            *token_index = key_index;
             return parser_ok;
         }
         element_count++;
+        key_index = JSON_TOKEN_SKIP(json, key_index + 1);
     }
 
     return parser_no_data;
@@ -203,7 +575,7 @@ parser_error_t object_get_nth_value(const parsed_json_t *json,
                                     uint16_t object_token_index,
                                     uint16_t object_element_index,
                                     uint16_t *key_index) {
-    if (object_token_index < 0 || object_token_index > json->numberOfTokens) {
+    if (object_token_index >= json->numberOfTokens) {
         return parser_no_data;
     }
 
@@ -213,39 +585,238 @@ parser_error_t object_get_nth_value(const parsed_json_t *json,
     return parser_ok;
 }
 
+uint16_t json_skip_token(const parsed_json_t *json, uint16_t token_index) {
+    if (token_index >= json->numberOfTokens) {
+        return json->numberOfTokens;
+    }
+
+#if defined(JSON_SOA_TOKENS)
+    return json->tokenSkip[token_index];
+#else
+    // Children always start before their parent ends
+    const jsmnint_t end = JSON_TOKEN_END(json, token_index);
+    token_index++;
+    while (token_index < json->numberOfTokens && JSON_TOKEN_START(json, token_index) < end) {
+        token_index++;
+    }
+
+    return token_index;
+#endif
+}
+
 parser_error_t object_get_value(const parsed_json_t *json,
                                 uint16_t object_token_index,
                                 const char *key_name,
                                 uint16_t *token_index) {
-    if (object_token_index < 0 || object_token_index > json->numberOfTokens) {
+    if (object_token_index >= json->numberOfTokens) {
         return parser_no_data;
     }
 
-    const jsmntok_t object_token = json->tokens[object_token_index];
+    const jsmnint_t object_end = JSON_TOKEN_END(json, object_token_index);
+    const uint16_t key_name_len = (uint16_t) strlen(key_name);
 
-    *token_index = object_token_index;
-    int prev_element_end = object_token.start;
-    (*token_index)++;
+    uint16_t key_index = object_token_index + 1;
+    while ((uint32_t) key_index + 1 < json->numberOfTokens &&
+           JSON_TOKEN_START(json, key_index) < object_end) {
+        if (key_name_len == JSON_TOKEN_LEN(json, key_index) &&
+            EQUALS(key_name, json->buffer + JSON_TOKEN_START(json, key_index), key_name_len)) {
+            *token_index = key_index + 1;
+            return parser_ok;
+        }
+        key_index = JSON_TOKEN_SKIP(json, key_index + 1);
+    }
 
-    while (*token_index < json->numberOfTokens) {
-        const jsmntok_t key_token = json->tokens[*token_index];
-        (*token_index)++;
-        const jsmntok_t value_token = json->tokens[*token_index];
+    return parser_no_data;
+}
 
-        if (key_token.start > object_token.end) {
-            break;
+parser_error_t json_projection_compile(json_projection_t *projection,
+                                       const char *const *paths,
+                                       uint8_t num_paths) {
+    MEMZERO(projection, sizeof(json_projection_t));
+    if (num_paths > JSON_PROJECTION_MAX_PATHS) {
+        return parser_value_out_of_range;
+    }
+
+    for (uint8_t p = 0; p < num_paths; p++) {
+        json_path_t *path = &projection->paths[p];
+        path->path = paths[p];
+
+        const size_t path_len = strlen(path->path);
+        if (path_len == 0 || path_len > UINT8_MAX) {
+            return parser_value_out_of_range;
+        }
+
+        uint16_t start = 0;
+        for (uint16_t i = 0; i <= path_len; i++) {
+            if (i < path_len && path->path[i] != '/') {
+                continue;
+            }
+            if (i == start || path->num_segments >= JSON_PROJECTION_MAX_SEGMENTS) {
+                return parser_value_out_of_range;
+            }
+
+            json_path_segment_t *segment = &path->segments[path->num_segments++];
+            segment->offset = start;
+            segment->len = i - start;
+            segment->index = 0;
+            for (uint16_t j = start; j < i; j++) {
+                const char c = path->path[j];
+                if (c < '0' || c > '9' || segment->index > 999) {
+                    segment->index = JSON_PROJECTION_NO_INDEX;
+                    break;
+                }
+                segment->index = segment->index * 10 + (c - '0');
+            }
+            start = i + 1;
+        }
+    }
+
+    projection->num_paths = num_paths;
+    return parser_ok;
+}
+
+typedef struct {
+    const parsed_json_t *json;
+    const json_projection_t *projection;
+    json_projection_match_t *matches;
+    uint16_t max_matches;
+    uint16_t num_matches;
+} projection_ctx_t;
+
+__Z_INLINE bool projection_segment_is_wildcard(const json_path_t *path, uint8_t depth) {
+    const json_path_segment_t *segment = &path->segments[depth];
+    return segment->len == 1 && path->path[segment->offset] == JSON_PROJECTION_WILDCARD[0];
+}
+
+// Paths in mask whose segment at depth matches the given object key
+static uint32_t projection_match_key(const projection_ctx_t *ctx,
+                                     uint32_t mask,
+                                     uint8_t depth,
+                                     uint16_t key_index) {
+    const char *key = ctx->json->buffer + JSON_TOKEN_START(ctx->json, key_index);
+    const uint16_t key_len = JSON_TOKEN_LEN(ctx->json, key_index);
+
+    uint32_t child_mask = 0;
+    for (uint8_t p = 0; p < ctx->projection->num_paths; p++) {
+        if (!(mask & (1u << p))) {
+            continue;
+        }
+        const json_path_t *path = &ctx->projection->paths[p];
+        const json_path_segment_t *segment = &path->segments[depth];
+        if (projection_segment_is_wildcard(path, depth) ||
+            (segment->len == key_len && !MEMCMP(path->path + segment->offset, key, key_len))) {
+            child_mask |= 1u << p;
+        }
+    }
+    return child_mask;
+}
+
+// Paths in mask whose segment at depth matches the given array element
+static uint32_t projection_match_index(const projection_ctx_t *ctx,
+                                       uint32_t mask,
+                                       uint8_t depth,
+                                       uint16_t element_index) {
+    uint32_t child_mask = 0;
+    for (uint8_t p = 0; p < ctx->projection->num_paths; p++) {
+        if (!(mask & (1u << p))) {
+            continue;
+        }
+        const json_path_t *path = &ctx->projection->paths[p];
+        if (projection_segment_is_wildcard(path, depth) ||
+            path->segments[depth].index == element_index) {
+            child_mask |= 1u << p;
+        }
+    }
+    return child_mask;
+}
+
+// Visits the value at token_index, where mask contains the paths that matched all segments
+// up to depth. Returns the index of the token that follows the value.
+static parser_error_t projection_visit(projection_ctx_t *ctx,
+                                       uint16_t token_index,
+                                       uint8_t depth,
+                                       uint32_t mask,
+                                       uint16_t *next_token_index) {
+    const parsed_json_t *json = ctx->json;
+    const jsmntype_t token_type = JSON_TOKEN_TYPE(json, token_index);
+    const jsmnint_t token_end = JSON_TOKEN_END(json, token_index);
+
+    // Report the paths that end here and keep the ones that go deeper
+    uint32_t deeper_mask = 0;
+    for (uint8_t p = 0; p < ctx->projection->num_paths; p++) {
+        if (!(mask & (1u << p))) {
+            continue;
         }
-        if (key_token.start <= prev_element_end) {
+        if (ctx->projection->paths[p].num_segments > depth) {
+            deeper_mask |= 1u << p;
             continue;
         }
-        prev_element_end = value_token.end;
+        if (ctx->num_matches >= ctx->max_matches) {
+            return parser_unexpected_buffer_end;
+        }
+        ctx->matches[ctx->num_matches].path_index = p;
+        ctx->matches[ctx->num_matches].token_index = token_index;
+        ctx->num_matches++;
+    }
+
+    if (deeper_mask == 0 || (token_type != JSMN_OBJECT && token_type != JSMN_ARRAY)) {
+        // Nothing else to find in this value
+        *next_token_index = json_skip_token(json, token_index);
+        return parser_ok;
+    }
 
-        if (((uint16_t) strlen(key_name)) == (key_token.end - key_token.start)) {
-            if (EQUALS(key_name, json->buffer + key_token.start, key_token.end - key_token.start)) {
-                return parser_ok;
+    uint16_t child_index = token_index + 1;
+    uint16_t element_index = 0;
+    while (child_index < json->numberOfTokens && JSON_TOKEN_START(json, child_index) < token_end) {
+        uint32_t child_mask;
+        if (token_type == JSMN_OBJECT) {
+            child_mask = projection_match_key(ctx, deeper_mask, depth, child_index);
+            // move to the value
+            child_index++;
+            if (child_index >= json->numberOfTokens) {
+                break;
             }
+        } else {
+            child_mask = projection_match_index(ctx, deeper_mask, depth, element_index);
         }
+        element_index++;
+
+        if (child_mask == 0) {
+            child_index = json_skip_token(json, child_index);
+            continue;
+        }
+        CHECK_PARSER_ERR(projection_visit(ctx, child_index, depth + 1, child_mask, &child_index))
     }
 
-    return parser_no_data;
+    *next_token_index = child_index;
+    return parser_ok;
+}
+
+parser_error_t json_projection_resolve(const parsed_json_t *json,
+                                       const json_projection_t *projection,
+                                       json_projection_match_t *matches,
+                                       uint16_t max_matches,
+                                       uint16_t *num_matches) {
+    *num_matches = 0;
+    if (!json->isValid || json->numberOfTokens == 0) {
+        return parser_json_zero_tokens;
+    }
+
+    projection_ctx_t ctx = {
+        .json = json,
+        .projection = projection,
+        .matches = matches,
+        .max_matches = max_matches,
+        .num_matches = 0,
+    };
+
+    uint32_t mask = 0;
+    for (uint8_t p = 0; p < projection->num_paths; p++) {
+        mask |= 1u << p;
+    }
+
+    uint16_t next_token_index;
+    const parser_error_t err = projection_visit(&ctx, ROOT_TOKEN_INDEX, 0, mask, &next_token_index);
+    *num_matches = ctx.num_matches;
+    return err;
 }
@@ -30,7 +30,7 @@ extern "C" {
 #include "bolos_target.h"
 #endif
 
-/// Max number of accepted tokens in the JSON input
+/// Size of the default token arena
 #define MAX_NUMBER_OF_TOKENS 1536
 
 // we must limit the number
@@ -39,32 +39,223 @@ extern "C" {
 #define MAX_NUMBER_OF_TOKENS 128
 #endif
 
+#if defined(JSMN_WIDE_TOKENS)
+/// Max accepted input length, host builds use 32-bit token offsets
+#define JSON_MAX_BUFFER_LEN INT32_MAX
+#else
+/// Max accepted input length, tokens store 16-bit offsets
+#define JSON_MAX_BUFFER_LEN INT16_MAX
+#endif
+
+/// Max length of a single token, the display code measures tokens with uint16_t
+#define JSON_MAX_TOKEN_LEN UINT16_MAX
+
 #define ROOT_TOKEN_INDEX 0
 
 //---------------------------------------------
 
+// Token storage provided by the caller of json_parse, declare it with JSON_TOKEN_ARENA.
+// With JSON_SOA_TOKENS (host builds) jsmn output is split into one array per field, so
+// scans that read a single field go over contiguous memory.
+typedef struct {
+    uint16_t capacity;
+    // jsmn output
+    jsmntok_t *tokens;
+    // one bit per token, see JSON_TOKEN_IS_ASCII
+    uint8_t *ascii;
+#if defined(JSON_SOA_TOKENS)
+    uint8_t *type;
+    jsmnint_t *start;
+    jsmnint_t *end;
+    // index of the token that follows the token and all its children
+    uint16_t *skip;
+#endif
+} json_token_arena_t;
+
+#define JSON_TOKEN_ASCII_BYTES(_CAPACITY) (((_CAPACITY) + 7) / 8)
+
+#if defined(JSON_SOA_TOKENS)
+#define JSON_TOKEN_ARENA(_NAME, _CAPACITY)                                    \
+    static jsmntok_t _NAME##_tokens[_CAPACITY];                               \
+    static uint8_t _NAME##_ascii[JSON_TOKEN_ASCII_BYTES(_CAPACITY)];          \
+    static uint8_t _NAME##_type[_CAPACITY];                                   \
+    static jsmnint_t _NAME##_start[_CAPACITY];                                \
+    static jsmnint_t _NAME##_end[_CAPACITY];                                  \
+    static uint16_t _NAME##_skip[_CAPACITY];                                  \
+    static const json_token_arena_t _NAME = {                                 \
+        _CAPACITY, _NAME##_tokens, _NAME##_ascii, _NAME##_type,               \
+        _NAME##_start, _NAME##_end, _NAME##_skip}
+#else
+#define JSON_TOKEN_ARENA(_NAME, _CAPACITY)                                    \
+    static jsmntok_t _NAME##_tokens[_CAPACITY];                               \
+    static uint8_t _NAME##_ascii[JSON_TOKEN_ASCII_BYTES(_CAPACITY)];          \
+    static const json_token_arena_t _NAME = {                                 \
+        _CAPACITY, _NAME##_tokens, _NAME##_ascii}
+#endif
+
 // Context that keeps all the parsed data together. That includes:
 //  - parsed json tokens
 //  - re-created SendMsg struct with indices pointing to tokens in parsed json
+// Tokens are read with the JSON_TOKEN_* accessors, which work with both layouts.
 typedef struct {
     uint8_t isValid;
     uint32_t numberOfTokens;
-    jsmntok_t tokens[MAX_NUMBER_OF_TOKENS];
+#if defined(JSON_SOA_TOKENS)
+    const uint8_t *tokenType;
+    const jsmnint_t *tokenStart;
+    const jsmnint_t *tokenEnd;
+    const uint16_t *tokenSkip;
+#else
+    const jsmntok_t *tokens;
+#endif
+    const uint8_t *tokenAscii;
+    uint16_t maxTokens;
     const char *buffer;
-    uint16_t bufferLen;
+    uint32_t bufferLen;
+    // incremented by every json_parse, lets caches built on the tokens detect a new parse
+    uint32_t generation;
+    // hash of the token types, their number of children and the keys. Documents that only
+    // differ in their values have the same fingerprint. Only computed with DISPLAY_PLAN_CACHE.
+    uint64_t fingerprint;
 } parsed_json_t;
 
+#if defined(JSON_SOA_TOKENS)
+#define JSON_TOKEN_TYPE(_JSON, _IDX) ((jsmntype_t) (_JSON)->tokenType[_IDX])
+#define JSON_TOKEN_START(_JSON, _IDX) ((_JSON)->tokenStart[_IDX])
+#define JSON_TOKEN_END(_JSON, _IDX) ((_JSON)->tokenEnd[_IDX])
+#define JSON_TOKEN_SKIP(_JSON, _IDX) ((_JSON)->tokenSkip[_IDX])
+#else
+#define JSON_TOKEN_TYPE(_JSON, _IDX) ((_JSON)->tokens[_IDX].type)
+#define JSON_TOKEN_START(_JSON, _IDX) ((_JSON)->tokens[_IDX].start)
+#define JSON_TOKEN_END(_JSON, _IDX) ((_JSON)->tokens[_IDX].end)
+#define JSON_TOKEN_SKIP(_JSON, _IDX) json_skip_token(_JSON, _IDX)
+#endif
+#define JSON_TOKEN_LEN(_JSON, _IDX) (JSON_TOKEN_END(_JSON, _IDX) - JSON_TOKEN_START(_JSON, _IDX))
+// Set for strings and primitives that only hold ASCII characters and no escapes, their
+// bytes can be displayed as they are
+#define JSON_TOKEN_IS_ASCII(_JSON, _IDX) \
+    (((_JSON)->tokenAscii[(_IDX) >> 3] >> ((_IDX) & 7)) & 1u)
+
+/// Initial value of json_hash
+#define JSON_HASH_INIT 0xcbf29ce484222325ull
+
+/// Character classes in json_char_class
+#define JSON_CHAR_SPACE 0x01u
+#define JSON_CHAR_CONTROL 0x02u
+#define JSON_CHAR_STRUCTURAL 0x04u
+#define JSON_CHAR_ESCAPE 0x08u
+#define JSON_CHAR_UTF8_CONT 0x10u
+#define JSON_CHAR_UTF8_LEAD2 0x20u
+#define JSON_CHAR_UTF8_LEAD3 0x40u
+#define JSON_CHAR_UTF8_LEAD4 0x80u
+
+/// Class of every byte value, a single load classifies a character
+extern const uint8_t json_char_class[256];
+
+/// Max number of key paths in a projection
+#define JSON_PROJECTION_MAX_PATHS 16
+/// Max number of segments in a projection key path
+#define JSON_PROJECTION_MAX_SEGMENTS 8
+/// Segment that matches any key or array element
+#define JSON_PROJECTION_WILDCARD "*"
+
+#define JSON_PROJECTION_NO_INDEX 0xFFFF
+
+typedef struct {
+    // position of the segment inside the path string
+    uint8_t offset;
+    uint8_t len;
+    // array index if the segment is numeric, otherwise JSON_PROJECTION_NO_INDEX
+    uint16_t index;
+} json_path_segment_t;
+
+typedef struct {
+    const char *path;
+    uint8_t num_segments;
+    json_path_segment_t segments[JSON_PROJECTION_MAX_SEGMENTS];
+} json_path_t;
+
+// Compiled set of key paths, e.g. "chain_id" or "msgs/*/value/to_address"
+typedef struct {
+    uint8_t num_paths;
+    json_path_t paths[JSON_PROJECTION_MAX_PATHS];
+} json_projection_t;
+
+typedef struct {
+    // index of the path in the projection
+    uint8_t path_index;
+    // token that holds the value
+    uint16_t token_index;
+} json_projection_match_t;
+
 //---------------------------------------------
 // NEW JSON PARSER CODE
 
 /// Parse json to create a token representation
 /// \param parsed_json
+/// \param arena: receives the tokens, must outlive parsed_json
 /// \param transaction
-/// \param transaction_length
+/// \param transaction_length: up to JSON_MAX_BUFFER_LEN
 /// \return Error message
 parser_error_t json_parse(parsed_json_t *parsed_json,
+                          const json_token_arena_t *arena,
                           const char *transaction,
-                          uint16_t transaction_length);
+                          uint32_t transaction_length);
+
+/// Count the tokens of a json input without storing them
+/// Use it to size the arena passed to json_parse, an arena may point to storage larger
+/// than its capacity. Mismatched brackets are only
+/// detected by json_parse.
+/// \param transaction
+/// \param transaction_length: up to JSON_MAX_BUFFER_LEN
+/// \param num_tokens (out)
+/// \return Error message
+parser_error_t json_count_tokens(const char *transaction,
+                                 uint32_t transaction_length,
+                                 uint16_t *num_tokens);
+
+/// Continue a FNV-1a hash
+/// \param hash: JSON_HASH_INIT or the result of a previous call
+/// \param data
+/// \param len
+/// \return updated hash
+uint64_t json_hash(uint64_t hash, const void *data, uint32_t len);
+
+/// Find the first character that belongs to any of the given classes
+/// \param buffer
+/// \param len
+/// \param char_class: JSON_CHAR_* flags
+/// \return offset of the character or len if there is none
+uint32_t json_find_char_class(const char *buffer, uint32_t len, uint8_t char_class);
+
+/// Check that a string is well formed UTF-8 and all its escapes are valid
+/// \param buffer: string contents, without quotes
+/// \param len
+/// \param is_ascii (out): true if there are no escapes and all characters are ASCII
+/// \return Error message
+parser_error_t json_validate_string(const char *buffer, uint32_t len, bool *is_ascii);
+
+/// Decode a validated string into text that can be displayed
+/// Escapes are resolved, code points that are not printable ASCII become '.'. The
+/// output is never longer than the input and is not terminated.
+/// \param buffer: string contents, without quotes
+/// \param len
+/// \param out
+/// \param out_len
+/// \param out_written (out)
+/// \return Error message
+parser_error_t json_decode_string(const char *buffer,
+                                  uint32_t len,
+                                  char *out,
+                                  uint16_t out_len,
+                                  uint16_t *out_written);
+
+/// Read the 4 hex digits of a \u escape
+/// \param buffer: digits, after "\u"
+/// \param len: available bytes
+/// \param value (out)
+/// \return Error message
+parser_error_t json_read_hex4(const char *buffer, uint32_t len, uint16_t *value);
 
 /// Get the number of elements in the array
 /// \param json
@@ -117,6 +308,12 @@ parser_error_t object_get_nth_value(const parsed_json_t *json,
                                     uint16_t object_element_index,
                                     uint16_t *token_index);
 
+/// Get the index of the first token after the given token and all its children
+/// \param json
+/// \param token_index
+/// \return token index of the next sibling (or json->numberOfTokens if there are none)
+uint16_t json_skip_token(const parsed_json_t *json, uint16_t token_index);
+
 /// Get the token index of the value that matches the given key
 /// \param json
 /// \param object_token_index: token index of the parent object
@@ -127,6 +324,31 @@ parser_error_t object_get_value(const parsed_json_t *json,
                                 const char *key_name,
                                 uint16_t *token_index);
 
+/// Compile a set of '/' separated key paths for json_projection_resolve
+/// A '*' segment matches every object value or array element, a numeric segment
+/// matches that array element. Path strings must outlive the projection.
+/// \param projection (out)
+/// \param paths
+/// \param num_paths
+/// \return Error message
+parser_error_t json_projection_compile(json_projection_t *projection,
+                                       const char *const *paths,
+                                       uint8_t num_paths);
+
+/// Resolve all the paths of a projection with a single traversal
+/// Matches are reported in document order.
+/// \param json
+/// \param projection
+/// \param matches (out)
+/// \param max_matches: capacity of matches
+/// \param num_matches (out)
+/// \return Error message
+parser_error_t json_projection_resolve(const parsed_json_t *json,
+                                       const json_projection_t *projection,
+                                       json_projection_match_t *matches,
+                                       uint16_t max_matches,
+                                       uint16_t *num_matches);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,215 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include <zxmacros.h>
+#include "json_pointer.h"
+
+#define FNV_OFFSET_BASIS 0x811c9dc5
+#define FNV_PRIME        0x01000193
+
+__Z_INLINE uint32_t fnv1a_update(uint32_t hash, char c) {
+    return (hash ^ (uint8_t) c) * FNV_PRIME;
+}
+
+void json_pointer_ctx_init(json_pointer_ctx_t *ctx, const parsed_json_t *json) {
+    MEMZERO(ctx, sizeof(json_pointer_ctx_t));
+    ctx->json = json;
+    if (json != NULL) {
+        ctx->generation = json->generation;
+    }
+}
+
+parser_error_t json_pointer_compile(json_pointer_t *pointer, const char *str) {
+    MEMZERO(pointer, sizeof(json_pointer_t));
+
+    const size_t str_len = strlen(str);
+    if (str_len > JSON_POINTER_MAX_LEN) {
+        return parser_value_out_of_range;
+    }
+    if (str_len == 0) {
+        // The whole document
+        return parser_ok;
+    }
+    if (str[0] != '/') {
+        return parser_unexpected_characters;
+    }
+    MEMCPY(pointer->str, str, str_len);
+
+    uint32_t hash = FNV_OFFSET_BASIS;
+    uint8_t buffer_len = 0;
+    json_pointer_step_t *step = NULL;
+
+    for (uint8_t i = 0; i <= str_len; i++) {
+        if (i == str_len || str[i] == '/') {
+            if (step != NULL) {
+                // Close the current step
+                step->prefix_hash = hash;
+                step->prefix_len = i;
+            }
+            if (i == str_len) {
+                break;
+            }
+            if (pointer->num_steps >= JSON_POINTER_MAX_STEPS) {
+                return parser_value_out_of_range;
+            }
+            step = &pointer->steps[pointer->num_steps++];
+            step->offset = buffer_len;
+            hash = fnv1a_update(hash, str[i]);
+            continue;
+        }
+
+        char c = str[i];
+        hash = fnv1a_update(hash, c);
+        if (c == '~') {
+            if ((size_t) i + 1 >= str_len || (str[i + 1] != '0' && str[i + 1] != '1')) {
+                return parser_unexpected_characters;
+            }
+            i++;
+            hash = fnv1a_update(hash, str[i]);
+            c = str[i] == '0' ? '~' : '/';
+        }
+        pointer->buffer[buffer_len++] = c;
+        step->len++;
+    }
+
+    // Array indices are "0" or digits without leading zeros
+    for (uint8_t s = 0; s < pointer->num_steps; s++) {
+        json_pointer_step_t *st = &pointer->steps[s];
+        const char *ref = pointer->buffer + st->offset;
+        st->index = JSON_POINTER_NO_INDEX;
+        if (st->len == 0 || st->len > 4 || (st->len > 1 && ref[0] == '0')) {
+            continue;
+        }
+        uint16_t index = 0;
+        uint8_t j = 0;
+        for (; j < st->len && ref[j] >= '0' && ref[j] <= '9'; j++) {
+            index = index * 10 + (ref[j] - '0');
+        }
+        if (j == st->len) {
+            st->index = index;
+        }
+    }
+
+    return parser_ok;
+}
+
+static const json_pointer_cache_entry_t *cache_find(const json_pointer_ctx_t *ctx,
+                                                    const json_pointer_t *pointer,
+                                                    uint8_t step) {
+    const json_pointer_step_t *st = &pointer->steps[step];
+    for (uint8_t i = 0; i < ctx->num_entries; i++) {
+        const json_pointer_cache_entry_t *entry = &ctx->entries[i];
+        if (entry->hash == st->prefix_hash && entry->len == st->prefix_len &&
+            !MEMCMP(entry->str, pointer->str, st->prefix_len)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void cache_insert(json_pointer_ctx_t *ctx,
+                         const json_pointer_t *pointer,
+                         uint8_t step,
+                         uint16_t token_index) {
+    const json_pointer_step_t *st = &pointer->steps[step];
+    json_pointer_cache_entry_t *entry = &ctx->entries[ctx->next_entry];
+    entry->hash = st->prefix_hash;
+    entry->len = st->prefix_len;
+    MEMCPY(entry->str, pointer->str, st->prefix_len);
+    entry->token_index = token_index;
+
+    ctx->next_entry = (ctx->next_entry + 1) % JSON_POINTER_CACHE_SIZE;
+    if (ctx->num_entries < JSON_POINTER_CACHE_SIZE) {
+        ctx->num_entries++;
+    }
+}
+
+// Find the child of container_index that a reference token refers to
+static parser_error_t resolve_step(const parsed_json_t *json,
+                                   const json_pointer_t *pointer,
+                                   uint8_t step,
+                                   uint16_t container_index,
+                                   uint16_t *token_index) {
+    const json_pointer_step_t *st = &pointer->steps[step];
+    const jsmntype_t container_type = JSON_TOKEN_TYPE(json, container_index);
+
+    if (container_type == JSMN_ARRAY) {
+        if (st->index == JSON_POINTER_NO_INDEX) {
+            return parser_no_data;
+        }
+        return array_get_nth_element(json, container_index, st->index, token_index);
+    }
+
+    if (container_type != JSMN_OBJECT) {
+        return parser_no_data;
+    }
+
+    const char *ref = pointer->buffer + st->offset;
+    const jsmnint_t container_end = JSON_TOKEN_END(json, container_index);
+    uint16_t key_index = container_index + 1;
+    while ((uint32_t) key_index + 1 < json->numberOfTokens &&
+           JSON_TOKEN_START(json, key_index) < container_end) {
+        if (JSON_TOKEN_LEN(json, key_index) == st->len &&
+            !MEMCMP(json->buffer + JSON_TOKEN_START(json, key_index), ref, st->len)) {
+            *token_index = key_index + 1;
+            return parser_ok;
+        }
+        key_index = json_skip_token(json, key_index + 1);
+    }
+
+    return parser_no_data;
+}
+
+parser_error_t json_pointer_resolve(json_pointer_ctx_t *ctx,
+                                    const json_pointer_t *pointer,
+                                    uint16_t *token_index) {
+    const parsed_json_t *json = ctx->json;
+    if (json == NULL || !json->isValid || json->numberOfTokens == 0) {
+        return parser_json_zero_tokens;
+    }
+
+    // Token indices of a previous parse mean nothing in the current one
+    if (ctx->generation != json->generation) {
+        ctx->num_entries = 0;
+        ctx->next_entry = 0;
+        ctx->generation = json->generation;
+    }
+
+    // Start from the longest prefix that was already resolved
+    *token_index = ROOT_TOKEN_INDEX;
+    uint8_t step = pointer->num_steps;
+    while (step > 0) {
+        const json_pointer_cache_entry_t *entry = cache_find(ctx, pointer, step - 1);
+        if (entry != NULL) {
+            *token_index = entry->token_index;
+            break;
+        }
+        step--;
+    }
+
+    for (; step < pointer->num_steps; step++) {
+        CHECK_PARSER_ERR(resolve_step(json, pointer, step, *token_index, token_index))
+        cache_insert(ctx, pointer, step, *token_index);
+    }
+
+    return parser_ok;
+}
+
+parser_error_t json_pointer_get(json_pointer_ctx_t *ctx, const char *str, uint16_t *token_index) {
+    json_pointer_t pointer;
+    CHECK_PARSER_ERR(json_pointer_compile(&pointer, str))
+    return json_pointer_resolve(ctx, &pointer, token_index);
+}
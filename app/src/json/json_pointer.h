@@ -0,0 +1,102 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include "json_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Max length of a JSON pointer (RFC 6901) string
+#define JSON_POINTER_MAX_LEN 64
+/// Max number of reference tokens in a JSON pointer
+#define JSON_POINTER_MAX_STEPS 8
+/// Number of resolved pointers kept per context
+#define JSON_POINTER_CACHE_SIZE 16
+
+#define JSON_POINTER_NO_INDEX 0xFFFF
+
+typedef struct {
+    // offset of the unescaped reference token in buffer
+    uint8_t offset;
+    uint8_t len;
+    // array index if the reference token is a valid one, otherwise JSON_POINTER_NO_INDEX
+    uint16_t index;
+    // hash of the pointer string up to and including this step
+    uint32_t prefix_hash;
+    // length of the pointer string up to and including this step
+    uint8_t prefix_len;
+} json_pointer_step_t;
+
+// Pointer split into unescaped reference tokens, e.g. "/msgs/0/value/coins/1/amount"
+typedef struct {
+    char str[JSON_POINTER_MAX_LEN + 1];
+    char buffer[JSON_POINTER_MAX_LEN];
+    uint8_t num_steps;
+    json_pointer_step_t steps[JSON_POINTER_MAX_STEPS];
+} json_pointer_t;
+
+typedef struct {
+    uint32_t hash;
+    uint8_t len;
+    char str[JSON_POINTER_MAX_LEN];
+    uint16_t token_index;
+} json_pointer_cache_entry_t;
+
+// Resolved pointers (and their prefixes) for one parsed json
+typedef struct {
+    const parsed_json_t *json;
+    // generation of json the entries were resolved in
+    uint32_t generation;
+    uint8_t num_entries;
+    uint8_t next_entry;
+    json_pointer_cache_entry_t entries[JSON_POINTER_CACHE_SIZE];
+} json_pointer_ctx_t;
+
+/// Initialize a pointer context, the cache is bound to the given json and dropped when it is
+/// parsed again
+/// \param ctx
+/// \param json
+void json_pointer_ctx_init(json_pointer_ctx_t *ctx, const parsed_json_t *json);
+
+/// Compile a JSON pointer (RFC 6901), "~0" and "~1" escapes are resolved here
+/// \param pointer (out)
+/// \param str: pointer string, "" refers to the whole document
+/// \return Error message
+parser_error_t json_pointer_compile(json_pointer_t *pointer, const char *str);
+
+/// Resolve a compiled pointer, reusing the longest cached prefix
+/// \param ctx
+/// \param pointer
+/// \param token_index (out) token of the referenced value
+/// \return Error message
+parser_error_t json_pointer_resolve(json_pointer_ctx_t *ctx,
+                                    const json_pointer_t *pointer,
+                                    uint16_t *token_index);
+
+/// Compile and resolve a JSON pointer
+/// \param ctx
+/// \param str: pointer string
+/// \param token_index (out) token of the referenced value
+/// \return Error message
+parser_error_t json_pointer_get(json_pointer_ctx_t *ctx, const char *str, uint16_t *token_index);
+
+#ifdef __cplusplus
+}
+#endif
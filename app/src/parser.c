@@ -20,6 +20,8 @@
 #include <zxtypes.h>
 #include "tx_parser.h"
 #include "tx_display.h"
+#include "tx_msgs.h"
+#include "tx_summary.h"
 #include "parser_impl.h"
 #include "common/parser.h"
 
@@ -29,16 +31,17 @@ parser_error_t parser_parse(parser_context_t *ctx, const uint8_t *data, size_t d
 }
 
 parser_error_t parser_validate(const parser_context_t *ctx) {
-    CHECK_PARSER_ERR(tx_validate(&parser_tx_obj.json))
+    // The root fields located here are reused when the tx is indexed
+    CHECK_PARSER_ERR(tx_validate(&parser_tx_obj.json, &parser_tx_obj.root_fields))
 
     // Iterate through all items to check that all can be shown and are valid
-    uint8_t numItems = 0;
+    uint16_t numItems = 0;
     CHECK_PARSER_ERR(parser_getNumItems(ctx, &numItems));
 
     char tmpKey[40];
     char tmpVal[40];
 
-    for (uint8_t idx = 0; idx < numItems; idx++) {
+    for (uint16_t idx = 0; idx < numItems; idx++) {
         uint8_t pageCount = 0;
         CHECK_PARSER_ERR(
             parser_getItem(ctx, idx, tmpKey, sizeof(tmpKey), tmpVal, sizeof(tmpVal), 0, &pageCount))
@@ -47,76 +50,62 @@ parser_error_t parser_validate(const parser_context_t *ctx) {
     return parser_ok;
 }
 
-parser_error_t parser_getNumItems(const parser_context_t *ctx, uint8_t *num_items) {
-    *num_items = 0;
-    return tx_display_numItems(num_items);
+__Z_INLINE parser_error_t parser_getSummaryOffset(uint16_t *summary_items) {
+    *summary_items = 0;
+    const tx_summary_t *summary = NULL;
+    CHECK_PARSER_ERR(tx_display_summary(&summary))
+    if (summary != NULL) {
+        CHECK_PARSER_ERR(parser_getSummaryNumItems(summary, summary_items))
+    }
+    return parser_ok;
 }
 
-// This should always query for the direct JSMN_STRING type
-// and THORChain always sends in long format, eg "100000000" for "1.0 RUNE"
-__Z_INLINE bool_t parser_isAmount(char *key) {
-    if (strcmp(key, "msgs/value/coins") == 0) return bool_true;
-
-    if (strcmp(key, "msgs/value/amount") == 0) return bool_true;
-
-    return bool_false;
+parser_error_t parser_getNumMsgs(const parser_context_t *ctx, uint16_t *num_msgs) {
+    (void) ctx;
+    return tx_display_numMsgs(num_msgs);
 }
 
-__Z_INLINE parser_error_t parser_formatAmount(uint16_t amountToken,
-                                              char *outVal,
-                                              uint16_t outValLen,
-                                              uint8_t pageIdx,
-                                              uint8_t *pageCount) {
-    if (parser_tx_obj.json.tokens[amountToken].type == JSMN_ARRAY) {
-        amountToken++;  // get first element of array
-    }
+parser_error_t parser_getMsgFirstItem(const parser_context_t *ctx,
+                                      uint16_t msg_idx,
+                                      uint16_t *display_idx) {
+    (void) ctx;
+    CHECK_PARSER_ERR(tx_display_msgFirstItem(msg_idx, display_idx))
 
-    *pageCount = 0;
+    uint16_t summary_items = 0;
+    CHECK_PARSER_ERR(parser_getSummaryOffset(&summary_items))
+    *display_idx += summary_items;
+    return parser_ok;
+}
 
-    uint16_t numElements;
-    CHECK_PARSER_ERR(array_get_element_count(&parser_tx_obj.json, amountToken, &numElements));
+parser_error_t parser_getNumItems(const parser_context_t *ctx, uint16_t *num_items) {
+    (void) ctx;
+    *num_items = 0;
+    CHECK_PARSER_ERR(tx_display_numItems(num_items))
 
-    if (numElements == 0) {
-        *pageCount = 1;
-        snprintf(outVal, outValLen, "Empty");
-        return parser_ok;
+    // The summary items go first
+    uint16_t summary_items = 0;
+    CHECK_PARSER_ERR(parser_getSummaryOffset(&summary_items))
+    if (*num_items + summary_items > UINT16_MAX) {
+        return parser_unexpected_number_items;
     }
+    *num_items += summary_items;
 
-    if (numElements != 4) return parser_unexpected_field;
-
-    if (parser_tx_obj.json.tokens[amountToken].type != JSMN_OBJECT) return parser_unexpected_field;
-
-    // Point at the correct JSMN_STRING.
-    // {"amount": "2000","asset": "THOR.RUNE"} where we want "2000" (+2) and "THOR.RUNE" (+4)
-    amountToken += 2;
-
-    // Should now be a String, e.g. "2000" ready to format
-    if (parser_tx_obj.json.tokens[amountToken].type != JSMN_STRING) return parser_unexpected_field;
-
-    // We also parse "asset", e.g. "THOR.RUNE" or "BTC/BTC" synths.
-    if (parser_tx_obj.json.tokens[amountToken + 2].type != JSMN_STRING) {
-        return parser_unexpected_field;
-    }
+    return parser_ok;
+}
 
+// THORChain always sends amounts in long format, eg "100000000" for "1.0 RUNE"
+static parser_error_t parser_formatCoin(const char *amountPtr,
+                                        int16_t amountLen,
+                                        const char *assetNamePtr,
+                                        int16_t assetNameLen,
+                                        char *outVal,
+                                        uint16_t outValLen,
+                                        uint8_t pageIdx,
+                                        uint8_t *pageCount) {
     char bufferUI[160];
     MEMZERO(outVal, outValLen);
     MEMZERO(bufferUI, sizeof(bufferUI));
 
-    const char *amountPtr = parser_tx_obj.tx + parser_tx_obj.json.tokens[amountToken].start;
-    if (parser_tx_obj.json.tokens[amountToken].start < 0) {
-        return parser_unexpected_buffer_end;
-    }
-    if (parser_tx_obj.json.tokens[amountToken + 2].start < 0) return parser_unexpected_buffer_end;
-
-    const char *assetNamePtr =
-        parser_tx_obj.tx + parser_tx_obj.json.tokens[amountToken + 2].start;  // "THOR.RUNE" etc.
-
-    const int16_t amountLen =
-        parser_tx_obj.json.tokens[amountToken].end - parser_tx_obj.json.tokens[amountToken].start;
-
-    const int16_t assetNameLen = parser_tx_obj.json.tokens[amountToken + 2].end -
-                                 parser_tx_obj.json.tokens[amountToken + 2].start;
-
     if (amountLen <= 0 || assetNameLen <= 0) {
         return parser_unexpected_buffer_end;
     }
@@ -173,6 +162,92 @@ __Z_INLINE parser_error_t parser_formatAmount(uint16_t amountToken,
     return parser_ok;
 }
 
+__Z_INLINE parser_error_t parser_formatAmount(uint16_t amountToken,
+                                              char *outVal,
+                                              uint16_t outValLen,
+                                              uint8_t pageIdx,
+                                              uint8_t *pageCount) {
+    const parsed_json_t *json = &parser_tx_obj.json;
+    if (JSON_TOKEN_TYPE(json, amountToken) == JSMN_ARRAY) {
+        amountToken++;  // get first element of array
+    }
+
+    *pageCount = 0;
+
+    uint16_t numElements;
+    CHECK_PARSER_ERR(array_get_element_count(json, amountToken, &numElements));
+
+    if (numElements == 0) {
+        *pageCount = 1;
+        snprintf(outVal, outValLen, "Empty");
+        return parser_ok;
+    }
+
+    if (numElements != 4) return parser_unexpected_field;
+
+    if (JSON_TOKEN_TYPE(json, amountToken) != JSMN_OBJECT) return parser_unexpected_field;
+
+    // Point at the correct JSMN_STRING.
+    // {"amount": "2000","asset": "THOR.RUNE"} where we want "2000" (+2) and "THOR.RUNE" (+4)
+    amountToken += 2;
+
+    // Should now be a String, e.g. "2000" ready to format
+    if (JSON_TOKEN_TYPE(json, amountToken) != JSMN_STRING) return parser_unexpected_field;
+
+    // We also parse "asset", e.g. "THOR.RUNE" or "BTC/BTC" synths.
+    if (JSON_TOKEN_TYPE(json, amountToken + 2) != JSMN_STRING) {
+        return parser_unexpected_field;
+    }
+
+    const char *amountPtr = parser_tx_obj.tx + JSON_TOKEN_START(json, amountToken);
+    if (JSON_TOKEN_START(json, amountToken) < 0) {
+        return parser_unexpected_buffer_end;
+    }
+    if (JSON_TOKEN_START(json, amountToken + 2) < 0) return parser_unexpected_buffer_end;
+
+    const char *assetNamePtr =
+        parser_tx_obj.tx + JSON_TOKEN_START(json, amountToken + 2);  // "THOR.RUNE" etc.
+
+    jsmnint_t amountLen = JSON_TOKEN_LEN(json, amountToken);
+    const jsmnint_t assetNameLen = JSON_TOKEN_LEN(json, amountToken + 2);
+
+    // Amounts were converted while indexing, format the integer instead of the raw text
+    char amountDigits[24];
+    const tx_numbers_t *numbers = NULL;
+    CHECK_PARSER_ERR(tx_display_numbers(&numbers))
+    const tx_amount_t *amount = tx_numbers_find_amount(numbers, amountToken);
+    if (amount != NULL) {
+        if (uint64_to_str(amountDigits, sizeof(amountDigits), amount->value) != NULL) {
+            return parser_unexpected_value;
+        }
+        amountPtr = amountDigits;
+        amountLen = (jsmnint_t) strlen(amountDigits);
+    }
+
+    return parser_formatCoin(amountPtr,
+                             amountLen,
+                             assetNamePtr,
+                             assetNameLen,
+                             outVal,
+                             outValLen,
+                             pageIdx,
+                             pageCount);
+}
+
+// Values decoded while indexing are paged from their decoded copy, others from the tx
+__Z_INLINE parser_error_t parser_getItemValue(uint16_t valueToken,
+                                              const char *decoded,
+                                              uint16_t decodedLen,
+                                              char *outVal,
+                                              uint16_t outValLen,
+                                              uint8_t pageIdx,
+                                              uint8_t *pageCount) {
+    if (decoded != NULL) {
+        return tx_getDecodedToken(decoded, decodedLen, outVal, outValLen, pageIdx, pageCount);
+    }
+    return tx_getToken(valueToken, outVal, outValLen, pageIdx, pageCount);
+}
+
 parser_error_t parser_getItem(const parser_context_t *ctx,
                               uint16_t displayIdx,
                               char *outKey,
@@ -186,7 +261,7 @@ parser_error_t parser_getItem(const parser_context_t *ctx,
     MEMZERO(outKey, outKeyLen);
     MEMZERO(outVal, outValLen);
 
-    uint8_t numItems;
+    uint16_t numItems;
     CHECK_PARSER_ERR(parser_getNumItems(ctx, &numItems))
     CHECK_APP_CANARY()
 
@@ -194,19 +269,59 @@ parser_error_t parser_getItem(const parser_context_t *ctx,
         return parser_unexpected_number_items;
     }
 
-    if (displayIdx < 0 || displayIdx >= numItems) {
+    if (displayIdx >= numItems) {
         return parser_display_idx_out_of_range;
     }
 
+    const tx_summary_t *summary = NULL;
+    CHECK_PARSER_ERR(tx_display_summary(&summary))
+    if (summary != NULL) {
+        uint16_t summary_items = 0;
+        CHECK_PARSER_ERR(parser_getSummaryNumItems(summary, &summary_items))
+        if (displayIdx < summary_items) {
+            return parser_getSummaryItem(
+                summary, displayIdx, outKey, outKeyLen, outVal, outValLen, pageIdx, pageCount);
+        }
+        displayIdx -= summary_items;
+    }
+
     uint16_t ret_value_token_index = 0;
-    CHECK_PARSER_ERR(tx_display_query(displayIdx, outKey, outKeyLen, &ret_value_token_index));
+    uint8_t format = msg_format_text;
+    uint8_t msg_type = MSG_TYPE_UNKNOWN;
+    const char *decoded = NULL;
+    uint16_t decoded_len = 0;
+    CHECK_PARSER_ERR(tx_display_query(displayIdx,
+                                      outKey,
+                                      outKeyLen,
+                                      &ret_value_token_index,
+                                      &format,
+                                      &msg_type,
+                                      &decoded,
+                                      &decoded_len));
     CHECK_APP_CANARY()
 
-    if (parser_isAmount(outKey)) {
-        CHECK_PARSER_ERR(
-            parser_formatAmount(ret_value_token_index, outVal, outValLen, pageIdx, pageCount))
-    } else {
-        CHECK_PARSER_ERR(tx_getToken(ret_value_token_index, outVal, outValLen, pageIdx, pageCount))
+    switch (format) {
+        case msg_format_amount:
+            CHECK_PARSER_ERR(
+                parser_formatAmount(ret_value_token_index, outVal, outValLen, pageIdx, pageCount))
+            break;
+        case msg_format_type: {
+            const msg_descriptor_t *desc = tx_msgs_descriptor(msg_type);
+            if (desc != NULL) {
+                pageString(outVal, outValLen, desc->name, pageIdx, pageCount);
+                if (pageIdx >= *pageCount) {
+                    return parser_display_page_out_of_range;
+                }
+                break;
+            }
+            CHECK_PARSER_ERR(parser_getItemValue(
+                ret_value_token_index, decoded, decoded_len, outVal, outValLen, pageIdx, pageCount))
+            break;
+        }
+        default:
+            CHECK_PARSER_ERR(parser_getItemValue(
+                ret_value_token_index, decoded, decoded_len, outVal, outValLen, pageIdx, pageCount))
+            break;
     }
     CHECK_APP_CANARY()
 
@@ -223,3 +338,150 @@ parser_error_t parser_getItem(const parser_context_t *ctx,
     CHECK_APP_CANARY()
     return parser_ok;
 }
+
+parser_error_t parser_getSummaryNumItems(const tx_summary_t *summary, uint16_t *num_items) {
+    // number of transactions and chain id (batches only), messages per type
+    uint16_t count = summary->num_txs > 0 ? 3 : 1;
+    for (uint8_t i = 0; i < summary->num_assets; i++) {
+        count += summary->assets[i].amount[0] != '\0';
+        count += summary->assets[i].fee[0] != '\0';
+    }
+    count += summary->num_destinations;
+
+    *num_items = count;
+    return parser_ok;
+}
+
+// e.g. "2 Deposit, 1 Send"
+__Z_INLINE parser_error_t parser_formatMsgCounts(const tx_summary_t *summary,
+                                                 char *outVal,
+                                                 uint16_t outValLen,
+                                                 uint8_t pageIdx,
+                                                 uint8_t *pageCount) {
+    char bufferUI[64];
+    MEMZERO(bufferUI, sizeof(bufferUI));
+
+    uint16_t len = 0;
+    for (uint8_t i = 0; i < TX_SUMMARY_MAX_MSG_TYPES; i++) {
+        const msg_descriptor_t *desc = tx_msgs_descriptor(i);
+        if (summary->msg_counts[i] == 0 || desc == NULL) {
+            continue;
+        }
+        const int written = snprintf(bufferUI + len,
+                                     sizeof(bufferUI) - len,
+                                     "%s%d %s",
+                                     len > 0 ? ", " : "",
+                                     summary->msg_counts[i],
+                                     desc->name);
+        if (written < 0 || (size_t) written >= sizeof(bufferUI) - len) {
+            return parser_unexpected_buffer_end;
+        }
+        len += written;
+    }
+
+    pageString(outVal, outValLen, bufferUI, pageIdx, pageCount);
+    return parser_ok;
+}
+
+__Z_INLINE const tx_summary_asset_t *parser_summaryAsset(const tx_summary_t *summary,
+                                                          bool fee,
+                                                          uint16_t *displayIdx) {
+    for (uint8_t i = 0; i < summary->num_assets; i++) {
+        const tx_summary_asset_t *asset = &summary->assets[i];
+        if ((fee ? asset->fee : asset->amount)[0] == '\0') {
+            continue;
+        }
+        if (*displayIdx == 0) {
+            return asset;
+        }
+        (*displayIdx)--;
+    }
+    return NULL;
+}
+
+parser_error_t parser_getSummaryItem(const tx_summary_t *summary,
+                                     uint16_t displayIdx,
+                                     char *outKey,
+                                     uint16_t outKeyLen,
+                                     char *outVal,
+                                     uint16_t outValLen,
+                                     uint8_t pageIdx,
+                                     uint8_t *pageCount) {
+    *pageCount = 0;
+
+    MEMZERO(outKey, outKeyLen);
+    MEMZERO(outVal, outValLen);
+
+    uint16_t numItems = 0;
+    CHECK_PARSER_ERR(parser_getSummaryNumItems(summary, &numItems))
+    if (displayIdx >= numItems) {
+        return parser_display_idx_out_of_range;
+    }
+
+    // Batches start with the number of transactions and the chain id
+    if (summary->num_txs == 0) {
+        displayIdx += 2;
+    }
+
+    // Transactions, Chain ID, Messages, Total per asset, Fee per asset, destinations
+    if (displayIdx == 0) {
+        char tmp[8];
+        snprintf(tmp, sizeof(tmp), "%d", summary->num_txs);
+        snprintf(outKey, outKeyLen, "Transactions");
+        pageString(outVal, outValLen, tmp, pageIdx, pageCount);
+    } else if (displayIdx == 1) {
+        snprintf(outKey, outKeyLen, "Chain ID");
+        pageStringExt(
+            outVal, outValLen, summary->chain_id, summary->chain_id_len, pageIdx, pageCount);
+    } else if (displayIdx == 2) {
+        snprintf(outKey, outKeyLen, "Messages");
+        CHECK_PARSER_ERR(parser_formatMsgCounts(summary, outVal, outValLen, pageIdx, pageCount))
+    } else {
+        displayIdx -= 3;
+
+        const tx_summary_asset_t *total = parser_summaryAsset(summary, false, &displayIdx);
+        const tx_summary_asset_t *fee = NULL;
+        if (total == NULL) {
+            fee = parser_summaryAsset(summary, true, &displayIdx);
+        }
+
+        if (total != NULL || fee != NULL) {
+            const tx_summary_asset_t *asset = total != NULL ? total : fee;
+            const char *amount = total != NULL ? total->amount : fee->fee;
+            snprintf(outKey, outKeyLen, total != NULL ? "Total" : "Fee");
+            CHECK_PARSER_ERR(parser_formatCoin(amount,
+                                               (int16_t) strlen(amount),
+                                               asset->asset,
+                                               (int16_t) strlen(asset->asset),
+                                               outVal,
+                                               outValLen,
+                                               pageIdx,
+                                               pageCount))
+        } else {
+            const tx_summary_destination_t *dest = &summary->destinations[displayIdx];
+            if (dest->msg_type == MSG_TYPE_UNKNOWN) {
+                snprintf(outKey, outKeyLen, "Memo");
+            } else {
+                const msg_descriptor_t *desc = tx_msgs_descriptor(dest->msg_type);
+                if (desc == NULL || dest->field >= desc->num_fields) {
+                    return parser_unexpected_error;
+                }
+                snprintf(outKey, outKeyLen, "%s", desc->fields[dest->field].label);
+            }
+            pageStringExt(outVal, outValLen, dest->value, dest->value_len, pageIdx, pageCount);
+        }
+    }
+
+    if (pageIdx >= *pageCount) {
+        return parser_display_page_out_of_range;
+    }
+
+    if (*pageCount > 1) {
+        size_t keyLen = strlen(outKey);
+        if (keyLen < outKeyLen) {
+            snprintf(outKey + keyLen, outKeyLen - keyLen, " [%d/%d]", pageIdx + 1, *pageCount);
+        }
+    }
+
+    return parser_ok;
+}
@@ -14,13 +14,15 @@
  *  limitations under the License.
  ********************************************************************************/
 
+#include <zxmacros.h>
 #include "parser_impl.h"
 
 parser_tx_t parser_tx_obj;
+JSON_TOKEN_ARENA(parser_tokens, MAX_NUMBER_OF_TOKENS);
 
 parser_error_t parser_init_context(parser_context_t *ctx,
                                    const uint8_t *buffer,
-                                   uint16_t bufferSize) {
+                                   size_t bufferSize) {
     ctx->offset = 0;
 
     if (bufferSize == 0 || buffer == NULL) {
@@ -30,6 +32,12 @@ parser_error_t parser_init_context(parser_context_t *ctx,
         return parser_init_context_empty;
     }
 
+    if (bufferSize > JSON_MAX_BUFFER_LEN) {
+        ctx->buffer = NULL;
+        ctx->bufferLen = 0;
+        return parser_value_out_of_range;
+    }
+
     ctx->buffer = buffer;
     ctx->bufferLen = bufferSize;
 
@@ -83,6 +91,12 @@ const char *parser_getErrorDescription(parser_error_t err) {
             return "JSON string is not complete";
         case parser_json_contains_whitespace:
             return "JSON Contains whitespace in the corpus";
+        case parser_json_contains_control_char:
+            return "JSON Contains control characters in a string";
+        case parser_json_invalid_utf8:
+            return "JSON string is not valid UTF-8";
+        case parser_json_invalid_escape:
+            return "JSON string has an invalid escape";
         case parser_json_is_not_sorted:
             return "JSON Dictionaries are not sorted";
         case parser_json_missing_chain_id:
@@ -106,13 +120,40 @@ const char *parser_getErrorDescription(parser_error_t err) {
 }
 
 parser_error_t _readTx(parser_context_t *c, parser_tx_t *v) {
-    parser_error_t err = json_parse(&parser_tx_obj.json, (const char *) c->buffer, c->bufferLen);
+    parser_error_t err =
+        json_parse(&v->json, &parser_tokens, (const char *) c->buffer, c->bufferLen);
     if (err != parser_ok) {
         return err;
     }
 
-    parser_tx_obj.tx = (const char *) c->buffer;
-    parser_tx_obj.flags.cache_valid = 0;
+    v->tx = (const char *) c->buffer;
+    v->flags.cache_valid = 0;
 
     return parser_ok;
 }
+
+uint8_t key_subst_find(const key_subst_t *table,
+                       uint8_t table_len,
+                       const char *str,
+                       uint16_t str_len) {
+    const key_subst_t *t = (const key_subst_t *) PIC(table);
+
+    // First entry of the bucket with this length
+    uint8_t lo = 0;
+    uint8_t hi = table_len;
+    while (lo < hi) {
+        const uint8_t mid = lo + (hi - lo) / 2;
+        if (t[mid].str1_len < str_len) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    for (uint8_t i = lo; i < table_len && t[i].str1_len == str_len; i++) {
+        if (!MEMCMP(t[i].str1, str, str_len)) {
+            return i;
+        }
+    }
+    return KEY_SUBST_NONE;
+}
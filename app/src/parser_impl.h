@@ -25,15 +25,34 @@ extern "C" {
 
 typedef struct {
     char str1[50];
+    uint8_t str1_len;
     char str2[50];
+    uint8_t str2_len;
 } key_subst_t;
 
+// Lengths are resolved at compile time so lookups can reject most entries with a single compare
+#define KEY_SUBST(_STR1, _STR2) \
+    { _STR1, sizeof(_STR1) - 1, _STR2, sizeof(_STR2) - 1 }
+
+#define KEY_SUBST_NONE 0xFF
+
 extern parser_tx_t parser_tx_obj;
 
 parser_error_t parser_init(parser_context_t *ctx, const uint8_t *buffer, size_t bufferSize);
 
 parser_error_t _readTx(parser_context_t *c, parser_tx_t *v);
 
+/// Find a substitution entry, only the entries with the length of str are compared
+/// \param table: sorted by str1_len
+/// \param table_len
+/// \param str: string to look up (does not need to be terminated)
+/// \param str_len
+/// \return index of the matching entry or KEY_SUBST_NONE
+uint8_t key_subst_find(const key_subst_t *table,
+                       uint8_t table_len,
+                       const char *str,
+                       uint16_t str_len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -24,6 +24,27 @@ extern "C" {
 
 #include <json/json_parser.h>
 
+typedef enum {
+    root_item_account_number = 0,
+    root_item_chain_id,
+    root_item_fee,
+    root_item_memo,
+    root_item_msgs,
+    root_item_sequence,
+} root_item_e;
+
+#define NUM_REQUIRED_ROOT_PAGES 6
+
+// Required root fields, located with a single walk over the root object
+typedef struct {
+    // value token of each root item, only meaningful if its bit is set in found
+    uint16_t value_token_idx[NUM_REQUIRED_ROOT_PAGES];
+    // bitmask of the root items that were found (1 << root_item_e)
+    uint8_t found;
+    // generation of the json the fields were located in
+    uint32_t json_generation;
+} tx_root_fields_t;
+
 typedef struct {
     // These are internal values used for tracking the state of the query/search
     uint16_t _item_index_current;
@@ -53,6 +74,9 @@ typedef struct {
     // parsed data (tokens, etc.)
     parsed_json_t json;
 
+    // required root fields
+    tx_root_fields_t root_fields;
+
     // internal flags
     struct {
         unsigned int cache_valid : 1;
@@ -17,31 +17,13 @@
 #include "coin.h"
 #include "app_mode.h"
 #include "tx_display.h"
+#include "tx_plan_cache.h"
 #include "tx_parser.h"
 #include "parser_impl.h"
+#include "tx_msgs.h"
+#include "tx_summary.h"
 #include <zxmacros.h>
 
-#define NUM_REQUIRED_ROOT_PAGES 6
-
-const char *get_required_root_item(root_item_e i) {
-    switch (i) {
-        case root_item_account_number:
-            return "account_number";
-        case root_item_chain_id:
-            return "chain_id";
-        case root_item_fee:
-            return "fee";
-        case root_item_memo:
-            return "memo";
-        case root_item_msgs:
-            return "msgs";
-        case root_item_sequence:
-            return "sequence";
-        default:
-            return "?";
-    }
-}
-
 __Z_INLINE uint8_t get_root_max_level(root_item_e i) {
     switch (i) {
         case root_item_account_number:
@@ -61,21 +43,92 @@ __Z_INLINE uint8_t get_root_max_level(root_item_e i) {
     }
 }
 
-typedef struct {
-    bool root_item_start_token_valid[NUM_REQUIRED_ROOT_PAGES];
-    // token where the root_item starts (negative for non-existing)
-    uint16_t root_item_start_token_idx[NUM_REQUIRED_ROOT_PAGES];
+// Sorted by key length, see key_subst_find (checked by the unit tests)
+static const key_subst_t key_substitutions[] = {
+    // Common
+    KEY_SUBST("memo", "Memo"),
+    KEY_SUBST("fee/gas", "Gas"),
+    KEY_SUBST("chain_id", "Chain ID"),
+    KEY_SUBST("sequence", "Sequence"),
+    KEY_SUBST("fee/amount", "Fee"),
+    KEY_SUBST("account_number", "Account"),
+    // msgs/type and msgs/value/* are resolved through the message registry (tx_msgs.c)
+};
+
+// Sorted by value length, see key_subst_find (checked by the unit tests)
+static const key_subst_t value_substitutions[] = {
+    KEY_SUBST("[]", "Empty"),
+};
+
+const key_subst_t *tx_display_keySubstitutions(uint8_t *count) {
+    *count = array_length(key_substitutions);
+    return (const key_subst_t *) PIC(key_substitutions);
+}
+
+const key_subst_t *tx_display_valueSubstitutions(uint8_t *count) {
+    *count = array_length(value_substitutions);
+    return (const key_subst_t *) PIC(value_substitutions);
+}
+
+#define MSG_TYPE_KEY   "msgs/type"
+#define MSG_TYPE_LABEL "Type"
+#define FEE_AMOUNT_KEY "fee/amount"
+
+#define MSG_FIELD_TYPE 0xFE
+
+#define MSG_FIRST_ITEM_NONE 0xFFFF
 
-    // total items
-    uint16_t total_item_count;
-    // number of items the root_item contains
-    uint8_t root_item_number_subitems[NUM_REQUIRED_ROOT_PAGES];
+typedef struct {
+    display_plan_t plan;
 
     uint8_t is_default_chain;
+
+    // item resolved by the last tx_display_query
+    uint16_t query_item_idx;
+
+    // decoded values of the items with escapes or non ASCII text, decoded once per tx
+    char decoded[DECODED_BUFFER_SIZE];
+    uint16_t decoded_used;
+
+    // account_number, sequence, gas and coin amounts as integers
+    tx_numbers_t numbers;
+
+    // aggregated view of txs with several messages, filled while indexing. A batch of txs
+    // holds the same storage for its own summary, single txs get none meanwhile.
+    tx_summary_t summary;
+    bool summary_valid;
+    bool summary_held;
+
+    // generation of parser_tx_obj.json the cache was built for
+    uint32_t json_generation;
 } display_cache_t;
 
 display_cache_t display_cache;
 
+// The plan arrays are written up to their counters before being read, so only the
+// counters and the per root item fields need to be cleared
+__Z_INLINE void display_cache_reset() {
+    MEMZERO(display_cache.plan.root_item_start_token_valid,
+            sizeof(display_cache.plan.root_item_start_token_valid));
+    MEMZERO(display_cache.plan.root_item_start_token_idx,
+            sizeof(display_cache.plan.root_item_start_token_idx));
+    MEMZERO(display_cache.plan.root_item_number_subitems,
+            sizeof(display_cache.plan.root_item_number_subitems));
+    MEMZERO(display_cache.plan.root_item_first_item,
+            sizeof(display_cache.plan.root_item_first_item));
+    MEMZERO(display_cache.plan.root_item_expert_subitems,
+            sizeof(display_cache.plan.root_item_expert_subitems));
+    display_cache.plan.total_item_count = 0;
+    display_cache.is_default_chain = false;
+    display_cache.plan.normal_item_count = 0;
+    display_cache.query_item_idx = 0;
+    display_cache.plan.num_msgs = 0;
+    display_cache.plan.loaded_msgs = 0;
+    display_cache.decoded_used = 0;
+    display_cache.summary_valid = false;
+    display_cache.json_generation = parser_tx_obj.json.generation;
+}
+
 parser_error_t tx_display_readTx(parser_context_t *ctx, const uint8_t *data, size_t dataLen) {
     CHECK_PARSER_ERR(parser_init(ctx, data, dataLen))
     CHECK_PARSER_ERR(_readTx(ctx, &parser_tx_obj))
@@ -99,8 +152,9 @@ __Z_INLINE parser_error_t calculate_is_default_chainid() {
     parser_tx_obj.query._item_index_current = 0;
 
     uint16_t ret_value_token_index;
-    CHECK_PARSER_ERR(tx_traverse_find(display_cache.root_item_start_token_idx[root_item_chain_id],
-                                      &ret_value_token_index))
+    CHECK_PARSER_ERR(
+        tx_traverse_find(display_cache.plan.root_item_start_token_idx[root_item_chain_id],
+                         &ret_value_token_index))
 
     CHECK_PARSER_ERR(tx_getToken(ret_value_token_index, outVal, sizeof(outVal), 0, &pageCount))
 
@@ -112,37 +166,254 @@ __Z_INLINE parser_error_t calculate_is_default_chainid() {
     return parser_ok;
 }
 
-parser_error_t tx_indexRootFields() {
-    if (parser_tx_obj.flags.cache_valid) {
+__Z_INLINE const msg_field_t *get_msg_field(const display_item_t *item) {
+    const msg_descriptor_t *desc = tx_msgs_descriptor(item->msg_type);
+    if (desc == NULL || item->msg_field >= desc->num_fields) {
+        return NULL;
+    }
+    return &desc->fields[item->msg_field];
+}
+
+__Z_INLINE uint8_t get_msg_field_rank(const display_item_t *item) {
+    if (item->msg_field == MSG_FIELD_TYPE) {
+        return 0;
+    }
+    if (item->msg_field == MSG_FIELD_NONE) {
+        return 0xFF;
+    }
+    return 1 + item->msg_field;
+}
+
+__Z_INLINE uint8_t get_msg_type(uint16_t msg_token_idx) {
+    uint16_t type_token_idx;
+    const parsed_json_t *json = &parser_tx_obj.json;
+    if (JSON_TOKEN_TYPE(json, msg_token_idx) != JSMN_OBJECT ||
+        object_get_value(json, msg_token_idx, "type", &type_token_idx) != parser_ok ||
+        JSON_TOKEN_TYPE(json, type_token_idx) != JSMN_STRING) {
+        return MSG_TYPE_UNKNOWN;
+    }
+
+    return tx_msgs_find_type(parser_tx_obj.tx + JSON_TOKEN_START(json, type_token_idx),
+                             JSON_TOKEN_LEN(json, type_token_idx));
+}
+
+// Tracks the message that the msgs items belong to while indexing
+typedef struct {
+    uint16_t msg_idx;
+    uint16_t msg_token_idx;
+    uint8_t msg_type;
+    // index in items of the first item of the message
+    uint16_t first_item;
+    bool valid;
+} msg_cursor_t;
+
+__Z_INLINE void msg_cursor_load(msg_cursor_t *cursor, uint16_t msgs_token_idx) {
+    cursor->valid = false;
+    cursor->msg_type = MSG_TYPE_UNKNOWN;
+    cursor->first_item = display_cache.plan.total_item_count;
+
+    if (array_get_nth_element(&parser_tx_obj.json,
+                              msgs_token_idx,
+                              cursor->msg_idx,
+                              &cursor->msg_token_idx) != parser_ok) {
+        return;
+    }
+    cursor->valid = true;
+
+    // Jump index, messages without items are resolved once indexing is done
+    if (cursor->msg_idx < display_cache.plan.num_msgs) {
+        display_cache.plan.msg_first_item[cursor->msg_idx] = cursor->first_item;
+    }
+
+    // Dispatch on the message type once per message
+    cursor->msg_type = get_msg_type(cursor->msg_token_idx);
+    display_cache.plan.loaded_msgs++;
+}
+
+// Sort the known fields of the current message in descriptor order (stable).
+// Unknown fields keep their position so they can still be found by traversal.
+__Z_INLINE void msg_cursor_finish(const msg_cursor_t *cursor) {
+    display_item_t *items = display_cache.plan.items;
+    const uint16_t last_item = display_cache.plan.total_item_count;
+
+    bool swapped = true;
+    while (swapped) {
+        swapped = false;
+        int32_t prev = -1;
+        for (uint16_t i = cursor->first_item; i < last_item; i++) {
+            if (items[i].msg_field == MSG_FIELD_NONE) {
+                continue;
+            }
+            if (prev >= 0 && get_msg_field_rank(&items[prev]) > get_msg_field_rank(&items[i])) {
+                const display_item_t tmp = items[prev];
+                items[prev] = items[i];
+                items[i] = tmp;
+                swapped = true;
+            }
+            prev = i;
+        }
+    }
+}
+
+__Z_INLINE void msg_cursor_advance(msg_cursor_t *cursor,
+                                   uint16_t msgs_token_idx,
+                                   uint16_t value_token_idx) {
+    const parsed_json_t *json = &parser_tx_obj.json;
+    while (cursor->valid &&
+           JSON_TOKEN_START(json, value_token_idx) >= JSON_TOKEN_END(json, cursor->msg_token_idx)) {
+        msg_cursor_finish(cursor);
+        cursor->msg_idx++;
+        msg_cursor_load(cursor, msgs_token_idx);
+    }
+}
+
+__Z_INLINE void resolve_item_key(display_item_t *item, const char *key, uint16_t key_len) {
+    item->key_subst_idx = KEY_SUBST_NONE;
+    item->msg_field = MSG_FIELD_NONE;
+
+    if (item->root_item == root_item_msgs) {
+        const uint16_t prefix_len = strlen(MSG_VALUE_KEY_PREFIX);
+        if (key_len == strlen(MSG_TYPE_KEY) && !MEMCMP(key, MSG_TYPE_KEY, key_len)) {
+            item->msg_field = MSG_FIELD_TYPE;
+            return;
+        }
+        if (key_len > prefix_len && !MEMCMP(key, MSG_VALUE_KEY_PREFIX, prefix_len)) {
+            item->msg_field =
+                tx_msgs_find_field(item->msg_type, key + prefix_len, key_len - prefix_len);
+            return;
+        }
+    }
+
+    item->key_subst_idx =
+        key_subst_find(key_substitutions, array_length(key_substitutions), key, key_len);
+}
+
+// Plain ASCII values are displayed straight from the tx, other values are decoded into the
+// side buffer. Values that do not fit keep being displayed from the raw token.
+__Z_INLINE void decode_item_value(display_item_t *item) {
+    const parsed_json_t *json = &parser_tx_obj.json;
+    const uint16_t token_idx = item->value_token_idx;
+    item->decoded_offset = DECODED_NONE;
+    item->decoded_len = 0;
+
+    const jsmntype_t type = JSON_TOKEN_TYPE(json, token_idx);
+    if (JSON_TOKEN_IS_ASCII(json, token_idx) || (type != JSMN_STRING && type != JSMN_PRIMITIVE)) {
+        return;
+    }
+
+    uint16_t decoded_len = 0;
+    if (json_decode_string(parser_tx_obj.tx + JSON_TOKEN_START(json, token_idx),
+                           JSON_TOKEN_LEN(json, token_idx),
+                           display_cache.decoded + display_cache.decoded_used,
+                           DECODED_BUFFER_SIZE - display_cache.decoded_used,
+                           &decoded_len) != parser_ok) {
+        return;
+    }
+
+    item->decoded_offset = (decoded_pos_t) display_cache.decoded_used;
+    item->decoded_len = (decoded_pos_t) decoded_len;
+    display_cache.decoded_used += decoded_len;
+}
+
+// Values with a friendlier text are matched once here instead of on every page request
+__Z_INLINE void substitute_item_value(display_item_t *item) {
+    const parsed_json_t *json = &parser_tx_obj.json;
+    const char *value = parser_tx_obj.tx + JSON_TOKEN_START(json, item->value_token_idx);
+    uint16_t value_len = JSON_TOKEN_LEN(json, item->value_token_idx);
+    if (item->decoded_offset != DECODED_NONE) {
+        value = display_cache.decoded + item->decoded_offset;
+        value_len = item->decoded_len;
+    }
+
+    item->value_subst_idx =
+        key_subst_find(value_substitutions, array_length(value_substitutions), value, value_len);
+}
+
+// Add the amounts, fees and destinations of an item to the summary
+__Z_INLINE parser_error_t summarize_item(const display_item_t *item) {
+    tx_summary_t *summary = &display_cache.summary;
+
+    if (item->root_item == root_item_fee) {
+        if (item->key_subst_idx != KEY_SUBST_NONE &&
+            !strcmp(key_substitutions[item->key_subst_idx].str1, FEE_AMOUNT_KEY)) {
+            CHECK_PARSER_ERR(
+                tx_summary_add_coins(summary, &parser_tx_obj.json, item->value_token_idx, true))
+        }
         return parser_ok;
     }
 
-    // Clear cache
-    MEMZERO(&display_cache, sizeof(display_cache_t));
+    const msg_field_t *field = get_msg_field(item);
+    if (item->root_item != root_item_msgs || field == NULL) {
+        return parser_ok;
+    }
+    if (field->format == msg_format_amount) {
+        CHECK_PARSER_ERR(
+            tx_summary_add_coins(summary, &parser_tx_obj.json, item->value_token_idx, false))
+    }
+    if (field->destination) {
+        CHECK_PARSER_ERR(tx_summary_add_destination(summary,
+                                                    &parser_tx_obj.json,
+                                                    item->value_token_idx,
+                                                    item->msg_type,
+                                                    item->msg_field))
+    }
+    return parser_ok;
+}
+
+// Messages that have no items (e.g. at the end of msgs) jump to where the next one would start
+__Z_INLINE void finish_msg_index() {
+    uint16_t next_first_item = display_cache.plan.root_item_first_item[root_item_msgs] +
+                               display_cache.plan.root_item_number_subitems[root_item_msgs];
+
+    for (uint16_t i = display_cache.plan.num_msgs; i > 0; i--) {
+        if (display_cache.plan.msg_first_item[i - 1] == MSG_FIRST_ITEM_NONE) {
+            display_cache.plan.msg_first_item[i - 1] = next_first_item;
+        }
+        next_first_item = display_cache.plan.msg_first_item[i - 1];
+    }
+}
+
+// Items of the tx in display order. Only the structure, the keys and the message types are
+// looked at, values are handled by apply_item_values.
+__Z_INLINE parser_error_t build_display_plan() {
+    // INIT_QUERY_CONTEXT terminates both buffers before each query
     char tmp_key[70];
     char tmp_val[70];
-    MEMZERO(&tmp_key, sizeof(tmp_key));
-    MEMZERO(&tmp_val, sizeof(tmp_val));
 
-    for (root_item_e root_item_idx = 0; root_item_idx < NUM_REQUIRED_ROOT_PAGES; root_item_idx++) {
-        uint16_t req_root_item_key_token_idx = 0;
-
-        parser_error_t err = object_get_value(&parser_tx_obj.json,
-                                              ROOT_TOKEN_INDEX,
-                                              get_required_root_item(root_item_idx),
-                                              &req_root_item_key_token_idx);
+    uint16_t num_msgs = 0;
+    if ((parser_tx_obj.root_fields.found & (1u << root_item_msgs)) &&
+        array_get_element_count(&parser_tx_obj.json,
+                                parser_tx_obj.root_fields.value_token_idx[root_item_msgs],
+                                &num_msgs) == parser_ok) {
+        display_cache.plan.num_msgs = num_msgs < MAX_DISPLAY_ITEMS ? num_msgs : MAX_DISPLAY_ITEMS;
+        for (uint16_t i = 0; i < display_cache.plan.num_msgs; i++) {
+            display_cache.plan.msg_first_item[i] = MSG_FIRST_ITEM_NONE;
+        }
+    }
 
-        if (err == parser_no_data) {
+    for (root_item_e root_item_idx = 0; root_item_idx < NUM_REQUIRED_ROOT_PAGES; root_item_idx++) {
+        if (!(parser_tx_obj.root_fields.found & (1u << root_item_idx))) {
             continue;
         }
-        CHECK_PARSER_ERR(err)
+        const uint16_t req_root_item_key_token_idx =
+            parser_tx_obj.root_fields.value_token_idx[root_item_idx];
 
         // Remember root item start token
-        display_cache.root_item_start_token_valid[root_item_idx] = 1;
-        display_cache.root_item_start_token_idx[root_item_idx] = req_root_item_key_token_idx;
+        display_cache.plan.root_item_start_token_valid[root_item_idx] = 1;
+        display_cache.plan.root_item_start_token_idx[root_item_idx] = req_root_item_key_token_idx;
+        display_cache.plan.root_item_first_item[root_item_idx] =
+            display_cache.plan.total_item_count;
+
+        msg_cursor_t msg_cursor;
+        msg_cursor.msg_idx = 0;
+        msg_cursor.valid = false;
+        if (root_item_idx == root_item_msgs) {
+            msg_cursor_load(&msg_cursor, req_root_item_key_token_idx);
+        }
 
         // Now count how many items can be found in this root item
         int32_t current_item_idx = 0;
+        parser_error_t err = parser_ok;
         while (err == parser_ok) {
             INIT_QUERY_CONTEXT(tmp_key,
                                sizeof(tmp_key),
@@ -157,7 +428,7 @@ parser_error_t tx_indexRootFields() {
 
             uint16_t ret_value_token_index;
 
-            err = tx_traverse_find(display_cache.root_item_start_token_idx[root_item_idx],
+            err = tx_traverse_find(display_cache.plan.root_item_start_token_idx[root_item_idx],
                                    &ret_value_token_index);
 
             if (err != parser_ok) {
@@ -177,7 +448,29 @@ parser_error_t tx_indexRootFields() {
                 continue;
             }
 
-            display_cache.root_item_number_subitems[root_item_idx]++;
+            if (display_cache.plan.total_item_count >= MAX_DISPLAY_ITEMS) {
+                return parser_unexpected_number_items;
+            }
+
+            msg_cursor_advance(&msg_cursor, req_root_item_key_token_idx, ret_value_token_index);
+
+            // Add the item to the display plan, resolving its friendly key only once
+            display_item_t *item = &display_cache.plan.items[display_cache.plan.total_item_count];
+            item->value_token_idx = ret_value_token_index;
+            item->root_item = root_item_idx;
+            item->msg_type = msg_cursor.valid ? msg_cursor.msg_type : MSG_TYPE_UNKNOWN;
+            resolve_item_key(
+                item, parser_tx_obj.query.out_key, strlen(parser_tx_obj.query.out_key));
+            item->decoded_offset = DECODED_NONE;
+            item->decoded_len = 0;
+
+            const msg_field_t *field = get_msg_field(item);
+            if (field != NULL && field->expert_only) {
+                display_cache.plan.root_item_expert_subitems[root_item_idx]++;
+            }
+
+            display_cache.plan.total_item_count++;
+            display_cache.plan.root_item_number_subitems[root_item_idx]++;
             current_item_idx++;
         }
 
@@ -185,8 +478,125 @@ parser_error_t tx_indexRootFields() {
             return err;
         }
 
-        display_cache.total_item_count += display_cache.root_item_number_subitems[root_item_idx];
+        if (msg_cursor.valid) {
+            msg_cursor_finish(&msg_cursor);
+        }
+        if (root_item_idx == root_item_msgs) {
+            finish_msg_index();
+        }
+    }
+
+    // Items shown outside expert mode, the plan is final once messages were sorted
+    for (uint16_t i = 0; i < display_cache.plan.total_item_count; i++) {
+        const display_item_t *item = &display_cache.plan.items[i];
+        const msg_field_t *field = get_msg_field(item);
+        if ((item->root_item == root_item_memo || item->root_item == root_item_msgs) &&
+            (field == NULL || !field->expert_only)) {
+            display_cache.plan.normal_items[display_cache.plan.normal_item_count++] = i;
+        }
+    }
+
+    return parser_ok;
+}
+
+// Values the plan depends on besides the shape of the tx: the message types, that sort the
+// message fields, and an empty memo, that is not displayed
+__Z_INLINE uint64_t plan_values_key() {
+    const parsed_json_t *json = &parser_tx_obj.json;
+    const tx_root_fields_t *fields = &parser_tx_obj.root_fields;
+    uint64_t values_key = JSON_HASH_INIT;
+
+    if (fields->found & (1u << root_item_memo)) {
+        const uint8_t memo_empty =
+            JSON_TOKEN_LEN(json, fields->value_token_idx[root_item_memo]) == 0;
+        values_key = json_hash(values_key, &memo_empty, sizeof(memo_empty));
+    }
+
+    uint16_t num_msgs = 0;
+    const uint16_t msgs_token_idx = fields->value_token_idx[root_item_msgs];
+    if (!(fields->found & (1u << root_item_msgs)) ||
+        array_get_element_count(json, msgs_token_idx, &num_msgs) != parser_ok) {
+        return values_key;
+    }
+    for (uint16_t i = 0; i < num_msgs; i++) {
+        uint16_t msg_token_idx;
+        if (array_get_nth_element(json, msgs_token_idx, i, &msg_token_idx) != parser_ok) {
+            break;
+        }
+        const uint8_t msg_type = get_msg_type(msg_token_idx);
+        values_key = json_hash(values_key, &msg_type, sizeof(msg_type));
+    }
+
+    return values_key;
+}
+
+// Summary and decoded values of the items, these change with every tx
+__Z_INLINE void apply_item_values() {
+    const uint16_t msgs_token_idx = parser_tx_obj.root_fields.value_token_idx[root_item_msgs];
+    uint16_t num_msgs = 0;
+
+    // Only txs with several messages get a summary
+    if (!display_cache.summary_held &&
+        (parser_tx_obj.root_fields.found & (1u << root_item_msgs)) &&
+        array_get_element_count(&parser_tx_obj.json, msgs_token_idx, &num_msgs) == parser_ok &&
+        num_msgs > 1) {
+        tx_summary_init(&display_cache.summary);
+        display_cache.summary_valid = true;
+
+        // Amounts of unknown messages cannot be added up, the summary is not shown then
+        for (uint16_t i = 0; i < display_cache.plan.loaded_msgs && display_cache.summary_valid;
+             i++) {
+            uint16_t msg_token_idx;
+            if (array_get_nth_element(&parser_tx_obj.json, msgs_token_idx, i, &msg_token_idx) !=
+                    parser_ok ||
+                tx_summary_add_msg_type(&display_cache.summary, get_msg_type(msg_token_idx)) !=
+                    parser_ok) {
+                display_cache.summary_valid = false;
+            }
+        }
+    }
+
+    for (uint16_t i = 0; i < display_cache.plan.total_item_count; i++) {
+        display_item_t *item = &display_cache.plan.items[i];
+        decode_item_value(item);
+        substitute_item_value(item);
+
+        // Too many assets or destinations only disable the summary
+        if (display_cache.summary_valid && summarize_item(item) != parser_ok) {
+            display_cache.summary_valid = false;
+        }
     }
+}
+
+parser_error_t tx_indexRootFields() {
+    if (parser_tx_obj.flags.cache_valid &&
+        display_cache.json_generation == parser_tx_obj.json.generation) {
+        return parser_ok;
+    }
+
+    display_cache_reset();
+
+    // Locate all root fields with one walk, unless tx_validate already did it for this parse.
+    // They are kept while the cache is valid.
+    if (parser_tx_obj.root_fields.json_generation != parser_tx_obj.json.generation) {
+        CHECK_PARSER_ERR(tx_root_fields_match(&parser_tx_obj.json, &parser_tx_obj.root_fields))
+    }
+
+    // Non numeric amounts are rejected here, before anything tries to format them
+    CHECK_PARSER_ERR(
+        tx_numbers_read(&parser_tx_obj.json, &parser_tx_obj.root_fields, &display_cache.numbers))
+
+#if defined(DISPLAY_PLAN_CACHE)
+    const uint64_t values_key = plan_values_key();
+    if (!tx_plan_cache_load(&parser_tx_obj.json, values_key, &display_cache.plan)) {
+        CHECK_PARSER_ERR(build_display_plan())
+        tx_plan_cache_store(&parser_tx_obj.json, values_key, &display_cache.plan);
+    }
+#else
+    CHECK_PARSER_ERR(build_display_plan())
+#endif
+
+    apply_item_values();
 
     parser_tx_obj.flags.cache_valid = 1;
 
@@ -204,11 +614,12 @@ bool tx_is_expert_mode() {
     return app_mode_expert() || is_default_chainid();
 }
 
-__Z_INLINE uint8_t get_subitem_count(root_item_e root_item) {
-    CHECK_PARSER_ERR(tx_indexRootFields())
-    if (display_cache.total_item_count == 0) return 0;
+__Z_INLINE uint16_t get_subitem_count(root_item_e root_item) {
+    if (tx_indexRootFields() != parser_ok || display_cache.plan.total_item_count == 0) {
+        return 0;
+    }
 
-    int16_t tmp_num_items = display_cache.root_item_number_subitems[root_item];
+    int32_t tmp_num_items = display_cache.plan.root_item_number_subitems[root_item];
 
     // Correct for expert_mode (show/hide some root items)
     switch (root_item) {
@@ -222,51 +633,111 @@ __Z_INLINE uint8_t get_subitem_count(root_item_e root_item) {
             }
             break;
         default:
+            if (!tx_is_expert_mode()) {
+                tmp_num_items -= display_cache.plan.root_item_expert_subitems[root_item];
+            }
             break;
     }
 
     return tmp_num_items;
 }
 
-__Z_INLINE parser_error_t retrieve_tree_indexes(uint8_t display_index,
-                                                root_item_e *root_item,
-                                                uint8_t *subitem_index) {
-    // Find root index | display_index idx -> item_index
-    // consume indexed subpages until we get the item index in the subpage
-    *root_item = 0;
-    *subitem_index = 0;
-    while (get_subitem_count(*root_item) == 0) {
-        (*root_item)++;
-    }
-
-    for (uint16_t i = 0; i < display_index; i++) {
-        (*subitem_index)++;
-        const uint8_t subitem_count = get_subitem_count(*root_item);
-        if (*subitem_index >= subitem_count) {
-            // Advance root index and skip empty items
-            *subitem_index = 0;
-            (*root_item)++;
-            while (get_subitem_count(*root_item) == 0) {
-                (*root_item)++;
-            }
+__Z_INLINE parser_error_t retrieve_item_index(uint16_t display_index, uint16_t *item_idx) {
+    // Every item is shown in expert mode, so display and plan indices are the same
+    if (tx_is_expert_mode()) {
+        if (display_index >= display_cache.plan.total_item_count) {
+            return parser_no_data;
         }
+        *item_idx = display_index;
+        return parser_ok;
     }
 
-    if (*root_item > NUM_REQUIRED_ROOT_PAGES) {
+    if (display_index >= display_cache.plan.normal_item_count) {
         return parser_no_data;
     }
+    *item_idx = display_cache.plan.normal_items[display_index];
+    return parser_ok;
+}
+
+parser_error_t tx_display_summary(const tx_summary_t **summary) {
+    *summary = NULL;
+    CHECK_PARSER_ERR(tx_indexRootFields())
+
+    if (display_cache.summary_valid) {
+        *summary = &display_cache.summary;
+    }
+    return parser_ok;
+}
+
+tx_summary_t *tx_display_holdSummary() {
+    display_cache.summary_held = true;
+    display_cache.summary_valid = false;
+    tx_summary_init(&display_cache.summary);
+    return &display_cache.summary;
+}
 
+void tx_display_releaseSummary() {
+    if (display_cache.summary_held) {
+        display_cache.summary_held = false;
+        // Indexed txs skipped their summary while it was held
+        parser_tx_obj.flags.cache_valid = 0;
+    }
+}
+
+parser_error_t tx_display_numbers(const tx_numbers_t **numbers) {
+    *numbers = NULL;
+    CHECK_PARSER_ERR(tx_indexRootFields())
+    *numbers = &display_cache.numbers;
     return parser_ok;
 }
 
-parser_error_t tx_display_numItems(uint8_t *num_items) {
+parser_error_t tx_display_numItems(uint16_t *num_items) {
     *num_items = 0;
     CHECK_PARSER_ERR(tx_indexRootFields())
 
-    *num_items = 0;
-    for (root_item_e root_item = 0; root_item < NUM_REQUIRED_ROOT_PAGES; root_item++) {
-        *num_items += get_subitem_count(root_item);
+    *num_items = tx_is_expert_mode() ? display_cache.plan.total_item_count
+                                     : display_cache.plan.normal_item_count;
+
+    return parser_ok;
+}
+
+parser_error_t tx_display_numMsgs(uint16_t *num_msgs) {
+    *num_msgs = 0;
+    CHECK_PARSER_ERR(tx_indexRootFields())
+    *num_msgs = display_cache.plan.num_msgs;
+    return parser_ok;
+}
+
+parser_error_t tx_display_msgFirstItem(uint16_t msg_idx, uint16_t *display_idx) {
+    *display_idx = 0;
+    CHECK_PARSER_ERR(tx_indexRootFields())
+
+    if (msg_idx >= display_cache.plan.num_msgs) {
+        return parser_display_idx_out_of_range;
+    }
+    const uint16_t first_item = display_cache.plan.msg_first_item[msg_idx];
+
+    if (!tx_is_expert_mode()) {
+        // Normal items are in plan order, the message starts after the ones before its first item
+        uint16_t lo = 0;
+        uint16_t hi = display_cache.plan.normal_item_count;
+        while (lo < hi) {
+            const uint16_t mid = lo + (hi - lo) / 2;
+            if (display_cache.plan.normal_items[mid] < first_item) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        *display_idx = lo;
+        return parser_ok;
+    }
+
+    // Visible items of the root items before msgs
+    for (root_item_e root_item = 0; root_item < root_item_msgs; root_item++) {
+        *display_idx += get_subitem_count(root_item);
     }
+    *display_idx += first_item - display_cache.plan.root_item_first_item[root_item_msgs];
 
     return parser_ok;
 }
@@ -275,19 +746,36 @@ parser_error_t tx_display_numItems(uint8_t *num_items) {
 parser_error_t tx_display_query(uint16_t displayIdx,
                                 char *outKey,
                                 uint16_t outKeyLen,
-                                uint16_t *ret_value_token_index) {
+                                uint16_t *ret_value_token_index,
+                                uint8_t *ret_format,
+                                uint8_t *ret_msg_type,
+                                const char **ret_decoded,
+                                uint16_t *ret_decoded_len) {
+    *ret_decoded = NULL;
+    *ret_decoded_len = 0;
     CHECK_PARSER_ERR(tx_indexRootFields())
 
-    uint8_t num_items;
+    uint16_t num_items;
     CHECK_PARSER_ERR(tx_display_numItems(&num_items));
 
-    if (displayIdx < 0 || displayIdx >= num_items) {
+    if (displayIdx >= num_items) {
         return parser_display_idx_out_of_range;
     }
 
-    root_item_e root_index = 0;
-    uint8_t subitem_index = 0;
-    CHECK_PARSER_ERR(retrieve_tree_indexes(displayIdx, &root_index, &subitem_index));
+    uint16_t item_idx = 0;
+    CHECK_PARSER_ERR(retrieve_item_index(displayIdx, &item_idx));
+    const display_item_t *item = &display_cache.plan.items[item_idx];
+    display_cache.query_item_idx = item_idx;
+    *ret_value_token_index = item->value_token_idx;
+    *ret_msg_type = item->msg_type;
+    *ret_format = msg_format_text;
+    if (item->value_subst_idx != KEY_SUBST_NONE) {
+        *ret_decoded = value_substitutions[item->value_subst_idx].str2;
+        *ret_decoded_len = value_substitutions[item->value_subst_idx].str2_len;
+    } else if (item->decoded_offset != DECODED_NONE) {
+        *ret_decoded = display_cache.decoded + item->decoded_offset;
+        *ret_decoded_len = item->decoded_len;
+    }
 
     // Prepare query
     static char tmp_val[2];
@@ -296,17 +784,39 @@ parser_error_t tx_display_query(uint16_t displayIdx,
                        tmp_val,
                        sizeof(tmp_val),
                        0,
-                       get_root_max_level(root_index))
-    parser_tx_obj.query.item_index = subitem_index;
+                       get_root_max_level(item->root_item))
+
+    if (item->key_subst_idx != KEY_SUBST_NONE) {
+        // A matching substitution means the raw key is already known
+        strncpy_s(outKey, key_substitutions[item->key_subst_idx].str1, outKeyLen);
+        return parser_ok;
+    }
+
+    if (item->msg_field == MSG_FIELD_TYPE) {
+        strncpy_s(outKey, MSG_TYPE_KEY, outKeyLen);
+        *ret_format = msg_format_type;
+        return parser_ok;
+    }
+
+    const msg_field_t *field = get_msg_field(item);
+    if (field != NULL) {
+        snprintf(outKey, outKeyLen, "%s%s", MSG_VALUE_KEY_PREFIX, field->key);
+        *ret_format = field->format;
+        return parser_ok;
+    }
+
+    // Unknown keys are rebuilt by traversing the root item again
+    parser_tx_obj.query.item_index =
+        item_idx - display_cache.plan.root_item_first_item[item->root_item];
     parser_tx_obj.query._item_index_current = 0;
 
-    strncpy_s(outKey, get_required_root_item(root_index), outKeyLen);
+    strncpy_s(outKey, get_required_root_item(item->root_item), outKeyLen);
 
-    if (!display_cache.root_item_start_token_valid[root_index]) {
+    if (!display_cache.plan.root_item_start_token_valid[item->root_item]) {
         return parser_no_data;
     }
 
-    CHECK_PARSER_ERR(tx_traverse_find(display_cache.root_item_start_token_idx[root_index],
+    CHECK_PARSER_ERR(tx_traverse_find(display_cache.plan.root_item_start_token_idx[item->root_item],
                                       ret_value_token_index))
 
     return parser_ok;
@@ -326,38 +836,24 @@ parser_error_t tx_display_query(uint16_t displayIdx,
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-static const key_subst_t key_substitutions[] = {
-    // Common
-    {"account_number", "Account"},
-    {"chain_id", "Chain ID"},
-    {"fee/gas", "Gas"},
-    {"fee/amount", "Fee"},
-    {"sequence", "Sequence"},
-    {"memo", "Memo"},
-    {"msgs/type", "Type"},
-
-    // MsgSend
-    {"msgs/value/from_address", "From"},
-    {"msgs/value/to_address", "To"},
-    {"msgs/value/amount", "Amount"},
-
-    // MsgDeposit
-    {"msgs/value/signer", "Sender"},
-    {"msgs/value/memo", "Memo"},
-    {"msgs/value/coins", "Amount"},
-};
 
 parser_error_t tx_display_make_friendly() {
     CHECK_PARSER_ERR(tx_indexRootFields())
 
-    // post process keys
-    for (size_t i = 0; i < array_length(key_substitutions); i++) {
-        if (!strcmp(parser_tx_obj.query.out_key, key_substitutions[i].str1)) {
-            strncpy_s(parser_tx_obj.query.out_key,
-                      key_substitutions[i].str2,
-                      parser_tx_obj.query.out_key_len);
-            break;
-        }
+    // post process keys, the substitution was already resolved when indexing
+    const display_item_t *item = &display_cache.plan.items[display_cache.query_item_idx];
+    const char *friendly_key = NULL;
+
+    if (item->key_subst_idx != KEY_SUBST_NONE) {
+        friendly_key = key_substitutions[item->key_subst_idx].str2;
+    } else if (item->msg_field == MSG_FIELD_TYPE) {
+        friendly_key = MSG_TYPE_LABEL;
+    } else if (get_msg_field(item) != NULL) {
+        friendly_key = get_msg_field(item)->label;
+    }
+
+    if (friendly_key != NULL) {
+        strncpy_s(parser_tx_obj.query.out_key, friendly_key, parser_tx_obj.query.out_key_len);
     }
 
     return parser_ok;
@@ -19,32 +19,148 @@
 #include <stdint.h>
 #include <common/parser_common.h>
 #include "parser_txdef.h"
+#include "parser_impl.h"
+#include "tx_summary.h"
+#include "tx_numbers.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-typedef enum {
-    root_item_account_number = 0,
-    root_item_chain_id,
-    root_item_fee,
-    root_item_memo,
-    root_item_msgs,
-    root_item_sequence,
-} root_item_e;
+// Capacity of the display plan. Nano S txs have at most 128 tokens, which real txs spread over
+// about 30 items.
+#if defined(TARGET_NANOS)
+#define MAX_DISPLAY_ITEMS 32
+#elif defined(TARGET_NANOX) || defined(TARGET_NANOS2)
+#define MAX_DISPLAY_ITEMS 255
+#else
+// Host builds, every item needs a key and a value token
+#define MAX_DISPLAY_ITEMS (MAX_NUMBER_OF_TOKENS / 2)
+#endif
 
-bool tx_is_expert_mode();
+// Capacity of the buffer with the decoded values of escaped or non ASCII items. Positions in
+// the buffer take a byte where it is small enough.
+#if defined(TARGET_NANOS)
+#define DECODED_BUFFER_SIZE 128
+#define DECODED_NONE 0xFF
+typedef uint8_t decoded_pos_t;
+#elif defined(TARGET_NANOX) || defined(TARGET_NANOS2)
+#define DECODED_BUFFER_SIZE 1024
+#define DECODED_NONE 0xFFFF
+typedef uint16_t decoded_pos_t;
+#else
+#define DECODED_BUFFER_SIZE 4096
+#define DECODED_NONE 0xFFFF
+typedef uint16_t decoded_pos_t;
+#endif
+
+typedef struct {
+    // token that holds the value to display
+    uint16_t value_token_idx;
+    uint8_t root_item;
+    // matching entry in key_substitutions or KEY_SUBST_NONE
+    uint8_t key_subst_idx;
+    // matching entry in value_substitutions or KEY_SUBST_NONE, set for every tx
+    uint8_t value_subst_idx;
+    // registry entry of the message the item belongs to or MSG_TYPE_UNKNOWN
+    uint8_t msg_type;
+    // field in the message descriptor, MSG_FIELD_TYPE or MSG_FIELD_NONE
+    uint8_t msg_field;
+    // value in the decoded buffer, DECODED_NONE if the raw token is displayed
+    decoded_pos_t decoded_offset;
+    decoded_pos_t decoded_len;
+} display_item_t;
+
+// Items of a tx in display order. The plan only depends on the structure of the tx, its
+// keys and its message types, so txs that only differ in their values share it.
+typedef struct {
+    bool root_item_start_token_valid[NUM_REQUIRED_ROOT_PAGES];
+    // token where the root_item starts (negative for non-existing)
+    uint16_t root_item_start_token_idx[NUM_REQUIRED_ROOT_PAGES];
 
-const char *get_required_root_item(root_item_e i);
+    // total items
+    uint16_t total_item_count;
+    // number of items the root_item contains
+    uint16_t root_item_number_subitems[NUM_REQUIRED_ROOT_PAGES];
+    // index in items of the first item of each root_item
+    uint16_t root_item_first_item[NUM_REQUIRED_ROOT_PAGES];
+    // number of items that are only shown in expert mode
+    uint16_t root_item_expert_subitems[NUM_REQUIRED_ROOT_PAGES];
+
+    // all items (including expert ones) in display order
+    display_item_t items[MAX_DISPLAY_ITEMS];
+    // items shown outside expert mode, in expert mode the display index is the item index
+    uint16_t normal_items[MAX_DISPLAY_ITEMS];
+    uint16_t normal_item_count;
+
+    // entries in msgs that have a jump index, at most MAX_DISPLAY_ITEMS
+    uint16_t num_msgs;
+    // index in items of the first item of each message
+    uint16_t msg_first_item[MAX_DISPLAY_ITEMS];
+    // messages reached by the items, their types are added to the summary
+    uint16_t loaded_msgs;
+} display_plan_t;
+
+bool tx_is_expert_mode();
 
+/// Resolve a display item
+/// \param displayIdx
+/// \param outKey: raw key of the item
+/// \param outKeyLen
+/// \param ret_value_token_index: token that holds the value
+/// \param ret_format: how the value should be rendered (msg_format_e)
+/// \param ret_msg_type: message type the item belongs to or MSG_TYPE_UNKNOWN
+/// \param ret_decoded: value decoded or substituted while indexing, not terminated. NULL if the
+/// raw token is displayed
+/// \param ret_decoded_len
+/// \return Error message
 parser_error_t tx_display_query(uint16_t displayIdx,
                                 char *outKey,
                                 uint16_t outKeyLen,
-                                uint16_t *ret_value_token_index);
+                                uint16_t *ret_value_token_index,
+                                uint8_t *ret_format,
+                                uint8_t *ret_msg_type,
+                                const char **ret_decoded,
+                                uint16_t *ret_decoded_len);
 
 parser_error_t tx_display_readTx(parser_context_t *c, const uint8_t *data, size_t dataLen);
 
-parser_error_t tx_display_numItems(uint8_t *num_items);
+/// Friendly labels of the raw keys, sorted by key length for key_subst_find (checked by the
+/// unit tests)
+/// \param count (out) number of entries
+const key_subst_t *tx_display_keySubstitutions(uint8_t *count);
+
+/// Friendly texts of raw values, sorted by value length like tx_display_keySubstitutions
+/// \param count (out) number of entries
+const key_subst_t *tx_display_valueSubstitutions(uint8_t *count);
+
+parser_error_t tx_display_numItems(uint16_t *num_items);
+
+/// Number of messages that can be jumped to with tx_display_msgFirstItem
+parser_error_t tx_display_numMsgs(uint16_t *num_msgs);
+
+/// Display index of the first item of a message, logarithmic in the number of items
+/// \param msg_idx: index in msgs
+/// \param display_idx (out) index among the detailed items (tx_display_numItems)
+/// \return Error message
+parser_error_t tx_display_msgFirstItem(uint16_t msg_idx, uint16_t *display_idx);
+
+/// Summary of the messages (count per type, totals, fees and destinations) computed while
+/// indexing the display items
+/// \param summary (out) NULL unless the tx has several messages that could be summarized
+/// \return Error message
+parser_error_t tx_display_summary(const tx_summary_t **summary);
+
+/// Take the summary storage for a batch of txs, single txs get no summary until it is released
+/// \return initialized summary
+tx_summary_t *tx_display_holdSummary();
+
+void tx_display_releaseSummary();
+
+/// Numeric fields of the tx, converted while indexing
+/// \param numbers (out)
+/// \return Error message
+parser_error_t tx_display_numbers(const tx_numbers_t **numbers);
 
 parser_error_t tx_display_make_friendly();
 
@@ -0,0 +1,94 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "tx_msgs.h"
+#include <zxmacros.h>
+
+#define MSG_FIELD(_KEY, _LABEL, _FORMAT, _EXPERT, _DESTINATION) \
+    { _KEY, sizeof(_KEY) - 1, _LABEL, _FORMAT, _EXPERT, _DESTINATION }
+
+#define MSG_TYPE(_HASH, _TYPE, _NAME) _HASH, _TYPE, sizeof(_TYPE) - 1, _NAME
+
+// New message types only need an entry here. Fields are listed in display order.
+static const msg_descriptor_t msg_registry[] = {
+    {
+        MSG_TYPE(0xdaff3439, "thorchain/MsgSend", "Send"),
+        3,
+        {
+            MSG_FIELD("amount", "Amount", msg_format_amount, false, false),
+            MSG_FIELD("from_address", "From", msg_format_address, false, false),
+            MSG_FIELD("to_address", "To", msg_format_address, false, true),
+        },
+    },
+    {
+        MSG_TYPE(0xe5aa0cfb, "thorchain/MsgDeposit", "Deposit"),
+        3,
+        {
+            MSG_FIELD("coins", "Amount", msg_format_amount, false, false),
+            MSG_FIELD("memo", "Memo", msg_format_memo, false, true),
+            MSG_FIELD("signer", "Sender", msg_format_address, false, false),
+        },
+    },
+};
+
+uint32_t tx_msgs_hash(const char *str, uint16_t str_len) {
+    uint32_t hash = 0x811c9dc5;
+    for (uint16_t i = 0; i < str_len; i++) {
+        hash ^= (uint8_t) str[i];
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
+uint8_t tx_msgs_count() {
+    return array_length(msg_registry);
+}
+
+const msg_descriptor_t *tx_msgs_descriptor(uint8_t msg_type) {
+    if (msg_type >= array_length(msg_registry)) {
+        return NULL;
+    }
+    return (const msg_descriptor_t *) PIC(&msg_registry[msg_type]);
+}
+
+uint8_t tx_msgs_find_type(const char *type, uint16_t type_len) {
+    const uint32_t hash = tx_msgs_hash(type, type_len);
+
+    for (uint8_t i = 0; i < array_length(msg_registry); i++) {
+        const msg_descriptor_t *desc = tx_msgs_descriptor(i);
+        if (desc->type_hash == hash && desc->type_len == type_len &&
+            !MEMCMP(desc->type, type, type_len)) {
+            return i;
+        }
+    }
+
+    return MSG_TYPE_UNKNOWN;
+}
+
+uint8_t tx_msgs_find_field(uint8_t msg_type, const char *key, uint16_t key_len) {
+    const msg_descriptor_t *desc = tx_msgs_descriptor(msg_type);
+    if (desc == NULL) {
+        return MSG_FIELD_NONE;
+    }
+
+    for (uint8_t i = 0; i < desc->num_fields; i++) {
+        if (desc->fields[i].key_len == key_len && !MEMCMP(desc->fields[i].key, key, key_len)) {
+            return i;
+        }
+    }
+
+    return MSG_FIELD_NONE;
+}
@@ -0,0 +1,90 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MSG_TYPE_UNKNOWN  0xFF
+#define MSG_FIELD_NONE    0xFF
+#define MSG_MAX_FIELDS    4
+#define MSG_VALUE_KEY_PREFIX "msgs/value/"
+
+typedef enum {
+    msg_format_text = 0,
+    msg_format_address,
+    msg_format_amount,
+    msg_format_memo,
+    msg_format_type,
+} msg_format_e;
+
+typedef struct {
+    // key inside the message "value" object
+    char key[24];
+    uint8_t key_len;
+    char label[12];
+    uint8_t format;
+    uint8_t expert_only;
+    // where the funds go, listed in aggregated summaries
+    uint8_t destination;
+} msg_field_t;
+
+typedef struct {
+    // FNV-1a hash of type, checked by the unit tests
+    uint32_t type_hash;
+    char type[32];
+    uint8_t type_len;
+    char name[12];
+    uint8_t num_fields;
+    // fields in display order
+    msg_field_t fields[MSG_MAX_FIELDS];
+} msg_descriptor_t;
+
+/// Hash used to dispatch message types
+/// \param str: does not need to be terminated
+/// \param str_len
+/// \return FNV-1a hash
+uint32_t tx_msgs_hash(const char *str, uint16_t str_len);
+
+/// Number of registered message types
+uint8_t tx_msgs_count();
+
+/// Descriptor of a registered message type
+/// \param msg_type: index in the registry
+/// \return descriptor or NULL if out of range
+const msg_descriptor_t *tx_msgs_descriptor(uint8_t msg_type);
+
+/// Find a message type in the registry
+/// \param type: does not need to be terminated
+/// \param type_len
+/// \return index in the registry or MSG_TYPE_UNKNOWN
+uint8_t tx_msgs_find_type(const char *type, uint16_t type_len);
+
+/// Find a field of a message type
+/// \param msg_type: index in the registry
+/// \param key: key inside the message value object, does not need to be terminated
+/// \param key_len
+/// \return index of the field or MSG_FIELD_NONE
+uint8_t tx_msgs_find_field(uint8_t msg_type, const char *key, uint16_t key_len);
+
+#ifdef __cplusplus
+}
+#endif
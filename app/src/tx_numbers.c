@@ -0,0 +1,192 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "tx_numbers.h"
+#include "tx_msgs.h"
+#include <zxmacros.h>
+
+parser_error_t tx_numbers_parse_uint64(const char *str, uint16_t str_len, uint64_t *value) {
+    *value = 0;
+    if (str == NULL || str_len == 0) {
+        return parser_unexpected_value;
+    }
+
+    for (uint16_t i = 0; i < str_len; i++) {
+        if (str[i] < '0' || str[i] > '9') {
+            return parser_unexpected_characters;
+        }
+        const uint8_t digit = (uint8_t) (str[i] - '0');
+        if (*value > (UINT64_MAX - digit) / 10) {
+            return parser_value_out_of_range;
+        }
+        *value = *value * 10 + digit;
+    }
+
+    return parser_ok;
+}
+
+// Numbers are sent as strings, e.g. "588"
+__Z_INLINE parser_error_t numbers_read_token(const parsed_json_t *json,
+                                             uint16_t token_idx,
+                                             uint64_t *value) {
+    if (JSON_TOKEN_TYPE(json, token_idx) != JSMN_STRING &&
+        JSON_TOKEN_TYPE(json, token_idx) != JSMN_PRIMITIVE) {
+        return parser_unexpected_type;
+    }
+    return tx_numbers_parse_uint64(json->buffer + JSON_TOKEN_START(json, token_idx),
+                                   (uint16_t) JSON_TOKEN_LEN(json, token_idx),
+                                   value);
+}
+
+// Coin objects look like {"amount":"2000","denom":"rune"} or {"amount":"2000","asset":"THOR.RUNE"}
+static parser_error_t numbers_add_coin(const parsed_json_t *json,
+                                       uint16_t coin_token,
+                                       bool is_fee,
+                                       tx_numbers_t *numbers) {
+    uint16_t amount_token = 0;
+    if (JSON_TOKEN_TYPE(json, coin_token) != JSMN_OBJECT ||
+        object_get_value(json, coin_token, "amount", &amount_token) != parser_ok) {
+        // Not a coin, the display code reports it
+        return parser_ok;
+    }
+
+    uint64_t value = 0;
+    CHECK_PARSER_ERR(numbers_read_token(json, amount_token, &value))
+
+    if (numbers->num_amounts < TX_NUMBERS_MAX_AMOUNTS) {
+        tx_amount_t *amount = &numbers->amounts[numbers->num_amounts++];
+        amount->token_idx = amount_token;
+        amount->value = value;
+        amount->is_fee = is_fee;
+    }
+    return parser_ok;
+}
+
+// A single coin or an array of them
+static parser_error_t numbers_add_coins(const parsed_json_t *json,
+                                        uint16_t token_idx,
+                                        bool is_fee,
+                                        tx_numbers_t *numbers) {
+    if (JSON_TOKEN_TYPE(json, token_idx) != JSMN_ARRAY) {
+        return numbers_add_coin(json, token_idx, is_fee, numbers);
+    }
+
+    uint16_t num_coins = 0;
+    CHECK_PARSER_ERR(array_get_element_count(json, token_idx, &num_coins))
+    for (uint16_t i = 0; i < num_coins; i++) {
+        uint16_t coin_token = 0;
+        CHECK_PARSER_ERR(array_get_nth_element(json, token_idx, i, &coin_token))
+        CHECK_PARSER_ERR(numbers_add_coin(json, coin_token, is_fee, numbers))
+    }
+    return parser_ok;
+}
+
+// Amount fields are taken from the message registry, unknown messages have none
+static parser_error_t numbers_add_msg(const parsed_json_t *json,
+                                      uint16_t msg_token,
+                                      tx_numbers_t *numbers) {
+    uint16_t type_token = 0;
+    uint16_t value_token = 0;
+    if (JSON_TOKEN_TYPE(json, msg_token) != JSMN_OBJECT ||
+        object_get_value(json, msg_token, "type", &type_token) != parser_ok ||
+        object_get_value(json, msg_token, "value", &value_token) != parser_ok ||
+        JSON_TOKEN_TYPE(json, type_token) != JSMN_STRING ||
+        JSON_TOKEN_TYPE(json, value_token) != JSMN_OBJECT) {
+        return parser_ok;
+    }
+
+    const uint8_t msg_type = tx_msgs_find_type(json->buffer + JSON_TOKEN_START(json, type_token),
+                                               JSON_TOKEN_LEN(json, type_token));
+    const msg_descriptor_t *desc = tx_msgs_descriptor(msg_type);
+    if (desc == NULL) {
+        return parser_ok;
+    }
+
+    uint16_t num_elements = 0;
+    CHECK_PARSER_ERR(object_get_element_count(json, value_token, &num_elements))
+    for (uint16_t i = 0; i < num_elements; i++) {
+        uint16_t key_token = 0;
+        CHECK_PARSER_ERR(object_get_nth_key(json, value_token, i, &key_token))
+
+        const uint8_t field = tx_msgs_find_field(msg_type,
+                                                 json->buffer + JSON_TOKEN_START(json, key_token),
+                                                 JSON_TOKEN_LEN(json, key_token));
+        if (field != MSG_FIELD_NONE && desc->fields[field].format == msg_format_amount) {
+            CHECK_PARSER_ERR(numbers_add_coins(json, key_token + 1, false, numbers))
+        }
+    }
+    return parser_ok;
+}
+
+parser_error_t tx_numbers_read(const parsed_json_t *json,
+                               const tx_root_fields_t *root_fields,
+                               tx_numbers_t *numbers) {
+    MEMZERO(numbers, sizeof(tx_numbers_t));
+
+    if (root_fields->found & (1u << root_item_account_number)) {
+        CHECK_PARSER_ERR(numbers_read_token(json,
+                                            root_fields->value_token_idx[root_item_account_number],
+                                            &numbers->account_number))
+    }
+    if (root_fields->found & (1u << root_item_sequence)) {
+        CHECK_PARSER_ERR(numbers_read_token(
+            json, root_fields->value_token_idx[root_item_sequence], &numbers->sequence))
+    }
+
+    // Keys are sorted, so fee amounts come before the message amounts
+    if (root_fields->found & (1u << root_item_fee)) {
+        const uint16_t fee_token = root_fields->value_token_idx[root_item_fee];
+        uint16_t token_idx = 0;
+        if (object_get_value(json, fee_token, "amount", &token_idx) == parser_ok) {
+            CHECK_PARSER_ERR(numbers_add_coins(json, token_idx, true, numbers))
+        }
+        if (object_get_value(json, fee_token, "gas", &token_idx) == parser_ok) {
+            CHECK_PARSER_ERR(numbers_read_token(json, token_idx, &numbers->gas))
+            numbers->has_gas = true;
+        }
+    }
+
+    if (root_fields->found & (1u << root_item_msgs)) {
+        const uint16_t msgs_token = root_fields->value_token_idx[root_item_msgs];
+        uint16_t num_msgs = 0;
+        CHECK_PARSER_ERR(array_get_element_count(json, msgs_token, &num_msgs))
+        for (uint16_t i = 0; i < num_msgs; i++) {
+            uint16_t msg_token = 0;
+            CHECK_PARSER_ERR(array_get_nth_element(json, msgs_token, i, &msg_token))
+            CHECK_PARSER_ERR(numbers_add_msg(json, msg_token, numbers))
+        }
+    }
+
+    return parser_ok;
+}
+
+const tx_amount_t *tx_numbers_find_amount(const tx_numbers_t *numbers, uint16_t token_idx) {
+    // Amounts are stored in document order
+    uint16_t low = 0;
+    uint16_t high = numbers->num_amounts;
+    while (low < high) {
+        const uint16_t mid = low + (high - low) / 2;
+        if (numbers->amounts[mid].token_idx == token_idx) {
+            return &numbers->amounts[mid];
+        }
+        if (numbers->amounts[mid].token_idx < token_idx) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,82 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "json/json_parser.h"
+#include "parser_txdef.h"
+#include "common/parser_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(TARGET_NANOS)
+#define TX_NUMBERS_MAX_AMOUNTS 8
+#else
+#define TX_NUMBERS_MAX_AMOUNTS 64
+#endif
+
+// Fields are ordered by size, the 64-bit ones would leave padding otherwise
+typedef struct {
+    uint64_t value;
+    // "amount" token of the coin
+    uint16_t token_idx;
+    bool is_fee;
+} tx_amount_t;
+
+// Numeric fields of a transaction, validated and converted once
+typedef struct {
+    // only meaningful if the root item was found
+    uint64_t account_number;
+    uint64_t sequence;
+    uint64_t gas;
+    bool has_gas;
+
+    // coin amounts of fee/amount and the amount fields of known messages, in document order.
+    // Amounts beyond the capacity are validated but not stored.
+    uint16_t num_amounts;
+    tx_amount_t amounts[TX_NUMBERS_MAX_AMOUNTS];
+} tx_numbers_t;
+
+/// Convert a decimal number
+/// \param str: digits only, does not need to be terminated
+/// \param str_len
+/// \param value (out)
+/// \return parser_unexpected_characters if there is anything but digits,
+///         parser_value_out_of_range if the number does not fit in 64 bits
+parser_error_t tx_numbers_parse_uint64(const char *str, uint16_t str_len, uint64_t *value);
+
+/// Validate and convert account_number, sequence, fee/gas and all coin amounts
+/// \param json
+/// \param root_fields: from tx_root_fields_match, missing root items are skipped
+/// \param numbers (out)
+/// \return Error message
+parser_error_t tx_numbers_read(const parsed_json_t *json,
+                               const tx_root_fields_t *root_fields,
+                               tx_numbers_t *numbers);
+
+/// Find the converted value of a coin amount
+/// \param numbers
+/// \param token_idx: "amount" token of the coin
+/// \return amount or NULL if it was not stored
+const tx_amount_t *tx_numbers_find_amount(const tx_numbers_t *numbers, uint16_t token_idx);
+
+#ifdef __cplusplus
+}
+#endif
@@ -19,6 +19,7 @@
 #include "tx_parser.h"
 #include "zxmacros.h"
 #include "parser_impl.h"
+#include "tx_display.h"
 
 // strcat but source does not need to be terminated (a chunk from a bigger string is concatenated)
 // dst_max is measured in bytes including the space for NULL termination
@@ -44,6 +45,84 @@ __Z_INLINE void strcat_chunk_s(char *dst,
     }
 }
 
+typedef struct {
+    char name[16];
+    uint8_t len;
+} root_field_name_t;
+
+#define ROOT_FIELD(_NAME) { _NAME, sizeof(_NAME) - 1 }
+
+// Indexed by root_item_e, in canonical (sorted) order
+static const root_field_name_t required_root_fields[NUM_REQUIRED_ROOT_PAGES] = {
+    ROOT_FIELD("account_number"),
+    ROOT_FIELD("chain_id"),
+    ROOT_FIELD("fee"),
+    ROOT_FIELD("memo"),
+    ROOT_FIELD("msgs"),
+    ROOT_FIELD("sequence"),
+};
+
+const char *get_required_root_item(root_item_e i) {
+    if (i >= NUM_REQUIRED_ROOT_PAGES) {
+        return "?";
+    }
+    const root_field_name_t *fields = (const root_field_name_t *) PIC(required_root_fields);
+    return fields[i].name;
+}
+
+__Z_INLINE bool root_field_equals(const root_field_name_t *field,
+                                  const char *key,
+                                  uint16_t key_len) {
+    return field->len == key_len && !MEMCMP(field->name, key, key_len);
+}
+
+parser_error_t tx_root_fields_match(const parsed_json_t *json, tx_root_fields_t *fields) {
+    MEMZERO(fields, sizeof(tx_root_fields_t));
+    fields->json_generation = json->generation;
+
+    if (json->numberOfTokens == 0 || JSON_TOKEN_TYPE(json, ROOT_TOKEN_INDEX) != JSMN_OBJECT) {
+        return parser_ok;
+    }
+
+    const root_field_name_t *names = (const root_field_name_t *) PIC(required_root_fields);
+    const jsmnint_t root_end = JSON_TOKEN_END(json, ROOT_TOKEN_INDEX);
+
+    // Required item expected next if keys are sorted
+    uint8_t expected = 0;
+
+    uint16_t key_token_idx = ROOT_TOKEN_INDEX + 1;
+    while ((uint32_t) key_token_idx + 1 < json->numberOfTokens &&
+           JSON_TOKEN_START(json, key_token_idx) < root_end) {
+        const char *key = json->buffer + JSON_TOKEN_START(json, key_token_idx);
+        const uint16_t key_len = JSON_TOKEN_LEN(json, key_token_idx);
+
+        uint8_t match = NUM_REQUIRED_ROOT_PAGES;
+        if (expected < NUM_REQUIRED_ROOT_PAGES &&
+            root_field_equals(&names[expected], key, key_len)) {
+            match = expected;
+        } else {
+            // Missing fields or unsorted keys, compare against all of them
+            for (uint8_t i = 0; i < NUM_REQUIRED_ROOT_PAGES; i++) {
+                if (root_field_equals(&names[i], key, key_len)) {
+                    match = i;
+                    break;
+                }
+            }
+        }
+
+        // Other root keys are ignored. Like object_get_value, the first occurrence of a key wins
+        if (match < NUM_REQUIRED_ROOT_PAGES && !(fields->found & (1u << match))) {
+            fields->found |= (uint8_t)(1u << match);
+            fields->value_token_idx[match] = key_token_idx + 1;
+            expected = match + 1;
+        }
+
+        key_token_idx = json_skip_token(json, key_token_idx + 1);
+    }
+
+    return parser_ok;
+}
+
 ///////////////////////////
 ///////////////////////////
 ///////////////////////////
@@ -52,44 +131,32 @@ __Z_INLINE void strcat_chunk_s(char *dst,
 ///////////////////////////
 ///////////////////////////
 
-static const key_subst_t value_substitutions[] = {
-    {"thorchain/MsgSend", "Send"},
-    {"thorchain/MsgDeposit", "Deposit"},
-    {"[]", "Empty"},
-};
-
-parser_error_t tx_getToken(uint16_t token_index,
-                           char *out_val,
-                           uint16_t out_val_len,
-                           uint8_t pageIdx,
-                           uint8_t *pageCount) {
+__Z_INLINE parser_error_t get_value(const char *inValue,
+                                    uint16_t inLen,
+                                    bool is_ascii,
+                                    char *out_val,
+                                    uint16_t out_val_len,
+                                    uint8_t pageIdx,
+                                    uint8_t *pageCount) {
     *pageCount = 0;
-    MEMZERO(out_val, out_val_len);
-
-    const int16_t token_start = parser_tx_obj.json.tokens[token_index].start;
-    const int16_t token_end = parser_tx_obj.json.tokens[token_index].end;
-
-    if (token_start > token_end) {
-        return parser_unexpected_buffer_end;
+    // pageStringExt clears out_val, only empty values need to be terminated here
+    if (out_val_len > 0) {
+        out_val[0] = 0;
     }
 
-    const char *inValue = parser_tx_obj.tx + token_start;
-    uint16_t inLen = token_end - token_start;
-
     // empty strings are considered the first page
     *pageCount = 1;
     if (inLen > 0) {
-        for (uint8_t i = 0; i < array_length(value_substitutions); i++) {
-            const char *substStr = value_substitutions[i].str1;
-            const size_t substStrLen = strlen(substStr);
-            if (inLen == substStrLen && !MEMCMP(inValue, substStr, substStrLen)) {
-                inValue = value_substitutions[i].str2;
-                inLen = strlen(value_substitutions[i].str2);
-                break;
+        pageStringExt(out_val, out_val_len, inValue, inLen, pageIdx, pageCount);
+
+        // Values that could not be decoded, the screen can only show ASCII
+        if (out_val_len > 0 && !is_ascii) {
+            for (char *c = out_val; *c != 0; c++) {
+                if ((uint8_t) *c >= 0x80) {
+                    *c = '.';
+                }
             }
         }
-
-        pageStringExt(out_val, out_val_len, inValue, inLen, pageIdx, pageCount);
     }
 
     if (pageIdx >= *pageCount) {
@@ -99,16 +166,51 @@ parser_error_t tx_getToken(uint16_t token_index,
     return parser_ok;
 }
 
+parser_error_t tx_getToken(uint16_t token_index,
+                           char *out_val,
+                           uint16_t out_val_len,
+                           uint8_t pageIdx,
+                           uint8_t *pageCount) {
+    *pageCount = 0;
+    if (out_val_len > 0) {
+        out_val[0] = 0;
+    }
+
+    const jsmnint_t token_start = JSON_TOKEN_START(&parser_tx_obj.json, token_index);
+    const jsmnint_t token_end = JSON_TOKEN_END(&parser_tx_obj.json, token_index);
+
+    if (token_start > token_end) {
+        return parser_unexpected_buffer_end;
+    }
+
+    return get_value(parser_tx_obj.tx + token_start,
+                     (uint16_t) (token_end - token_start),
+                     JSON_TOKEN_IS_ASCII(&parser_tx_obj.json, token_index),
+                     out_val,
+                     out_val_len,
+                     pageIdx,
+                     pageCount);
+}
+
+parser_error_t tx_getDecodedToken(const char *value,
+                                  uint16_t value_len,
+                                  char *out_val,
+                                  uint16_t out_val_len,
+                                  uint8_t pageIdx,
+                                  uint8_t *pageCount) {
+    return get_value(value, value_len, true, out_val, out_val_len, pageIdx, pageCount);
+}
+
 __Z_INLINE void append_key_item(int16_t token_index) {
     if (*parser_tx_obj.query.out_key > 0) {
         // There is already something there, add separator
         strcat_chunk_s(parser_tx_obj.query.out_key, parser_tx_obj.query.out_key_len, "/", 1);
     }
 
-    const int16_t token_start = parser_tx_obj.json.tokens[token_index].start;
-    const int16_t token_end = parser_tx_obj.json.tokens[token_index].end;
+    const jsmnint_t token_start = JSON_TOKEN_START(&parser_tx_obj.json, token_index);
+    const jsmnint_t token_end = JSON_TOKEN_END(&parser_tx_obj.json, token_index);
     const char *address_ptr = parser_tx_obj.tx + token_start;
-    const int16_t new_item_size = token_end - token_start;
+    const jsmnint_t new_item_size = token_end - token_start;
 
     strcat_chunk_s(parser_tx_obj.query.out_key,
                    parser_tx_obj.query.out_key_len,
@@ -123,7 +225,7 @@ __Z_INLINE void append_key_item(int16_t token_index) {
 ///////////////////////////
 
 parser_error_t tx_traverse_find(int16_t root_token_index, uint16_t *ret_value_token_index) {
-    const jsmntype_t token_type = parser_tx_obj.json.tokens[root_token_index].type;
+    const jsmntype_t token_type = JSON_TOKEN_TYPE(&parser_tx_obj.json, root_token_index);
 
     CHECK_APP_CANARY()
 
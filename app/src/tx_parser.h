@@ -17,6 +17,7 @@
 #pragma once
 
 #include "json/json_parser.h"
+#include "parser_txdef.h"
 #include <stdint.h>
 #include <common/parser_common.h>
 #include "zxmacros.h"
@@ -35,13 +36,24 @@ extern "C" {
     parser_tx_obj.query.item_index = 0;                                           \
     parser_tx_obj.query.page_index = (_PAGE_IDX);                                 \
                                                                                   \
-    MEMZERO(_KEY, (_KEY_LEN));                                                    \
-    MEMZERO(_VAL, (_VAL_LEN));                                                    \
+    /* outputs are always kept terminated, clearing the first byte is enough */   \
+    (_KEY)[0] = 0;                                                                \
+    (_VAL)[0] = 0;                                                                \
     parser_tx_obj.query.out_key = _KEY;                                           \
     parser_tx_obj.query.out_val = _VAL;                                           \
     parser_tx_obj.query.out_key_len = (_KEY_LEN);                                 \
     parser_tx_obj.query.out_val_len = (_VAL_LEN);
 
+/// Key of a required root item
+const char *get_required_root_item(root_item_e i);
+
+/// Locate all required root fields with a single walk over the root object
+/// Canonical txs have sorted keys, so each key is usually matched with one comparison.
+/// \param json
+/// \param fields (out)
+/// \return Error message
+parser_error_t tx_root_fields_match(const parsed_json_t *json, tx_root_fields_t *fields);
+
 parser_error_t tx_traverse_find(int16_t root_token_index, uint16_t *ret_value_token_index);
 
 // Traverses transaction data and fills tx_context
@@ -55,6 +67,14 @@ parser_error_t tx_getToken(uint16_t token_index,
                            uint8_t pageIdx,
                            uint8_t *pageCount);
 
+// Same as tx_getToken for a value that was decoded while indexing (escapes or non ASCII text)
+parser_error_t tx_getDecodedToken(const char *value,
+                                  uint16_t value_len,
+                                  char *out_val,
+                                  uint16_t out_val_len,
+                                  uint8_t pageIdx,
+                                  uint8_t *pageCount);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,247 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+
+#include "tx_plan_cache.h"
+#include <zxmacros.h>
+
+#if defined(DISPLAY_PLAN_CACHE)
+
+// Shape of a tx: type | structure (4 bytes) | key length (2 bytes) | key, per token
+#define SHAPE_HEADER_SIZE 7
+#define SHAPE_TYPE_KEY 0x80u
+
+// The structure word is the number of children, or the number of tokens of the subtree when
+// the tokens are split. Either one fixes the tree together with the token order.
+#if defined(JSON_SOA_TOKENS)
+#define SHAPE_TOKEN_STRUCTURE(_JSON, _IDX) ((uint32_t) (JSON_TOKEN_SKIP(_JSON, _IDX) - (_IDX)))
+#else
+#define SHAPE_TOKEN_STRUCTURE(_JSON, _IDX) ((uint32_t) (_JSON)->tokens[_IDX].size)
+#endif
+
+// Keys are the strings followed by a colon, string tokens end at their closing quote
+static bool shape_token_is_key(const parsed_json_t *json, uint32_t token_index) {
+    if (JSON_TOKEN_TYPE(json, token_index) != JSMN_STRING) {
+        return false;
+    }
+    uint32_t pos = JSON_TOKEN_END(json, token_index) + 1;
+    while (pos < json->bufferLen &&
+           (json_char_class[(uint8_t) json->buffer[pos]] & JSON_CHAR_SPACE) != 0) {
+        pos++;
+    }
+    return pos < json->bufferLen && json->buffer[pos] == ':';
+}
+
+typedef struct {
+    bool used;
+    uint64_t fingerprint;
+    uint16_t num_tokens;
+    // the fingerprint is not collision resistant, hits are confirmed against the stored shape
+    uint8_t shape[TX_PLAN_CACHE_SHAPE_SIZE];
+    uint32_t shape_len;
+    // last lookup or store, the entry with the lowest tick is evicted first
+    uint32_t tick;
+
+    bool keys_sorted_valid;
+    bool keys_sorted;
+
+    bool plan_valid;
+    uint64_t values_key;
+    display_plan_t plan;
+} plan_cache_entry_t;
+
+static struct {
+    plan_cache_entry_t entries[TX_PLAN_CACHE_SIZE];
+    uint32_t tick;
+    uint32_t hits;
+    uint32_t misses;
+} plan_cache;
+
+// Compare the shape of json with the stored one or store it. Shapes that do not fit are
+// never stored, so they never match.
+static bool shape_visit(const parsed_json_t *json,
+                        uint8_t *shape,
+                        uint32_t *shape_len,
+                        bool store) {
+    uint32_t pos = 0;
+    for (uint32_t i = 0; i < json->numberOfTokens; i++) {
+        const bool is_key = shape_token_is_key(json, i);
+        const uint8_t type = (uint8_t) JSON_TOKEN_TYPE(json, i) | (is_key ? SHAPE_TYPE_KEY : 0);
+        const uint32_t size = SHAPE_TOKEN_STRUCTURE(json, i);
+        const uint16_t key_len = is_key ? (uint16_t) JSON_TOKEN_LEN(json, i) : 0;
+        const uint8_t header[SHAPE_HEADER_SIZE] = {type,
+                                                   (uint8_t) (size & 0xFF),
+                                                   (uint8_t) ((size >> 8) & 0xFF),
+                                                   (uint8_t) ((size >> 16) & 0xFF),
+                                                   (uint8_t) ((size >> 24) & 0xFF),
+                                                   (uint8_t) (key_len & 0xFF),
+                                                   (uint8_t) (key_len >> 8)};
+        const char *key = json->buffer + JSON_TOKEN_START(json, i);
+
+        const uint32_t limit = store ? TX_PLAN_CACHE_SHAPE_SIZE : *shape_len;
+        if (limit - pos < SHAPE_HEADER_SIZE + (uint32_t) key_len) {
+            return false;
+        }
+        if (store) {
+            MEMCPY(shape + pos, header, SHAPE_HEADER_SIZE);
+            MEMCPY(shape + pos + SHAPE_HEADER_SIZE, key, key_len);
+        } else if (MEMCMP(shape + pos, header, SHAPE_HEADER_SIZE) != 0 ||
+                   MEMCMP(shape + pos + SHAPE_HEADER_SIZE, key, key_len) != 0) {
+            return false;
+        }
+        pos += SHAPE_HEADER_SIZE + key_len;
+    }
+
+    if (store) {
+        *shape_len = pos;
+        return true;
+    }
+    return pos == *shape_len;
+}
+
+__Z_INLINE bool entry_matches(plan_cache_entry_t *entry, const parsed_json_t *json) {
+    return entry->used && entry->fingerprint == json->fingerprint &&
+           entry->num_tokens == json->numberOfTokens &&
+           shape_visit(json, entry->shape, &entry->shape_len, false);
+}
+
+__Z_INLINE plan_cache_entry_t *find_entry(const parsed_json_t *json) {
+    for (uint8_t i = 0; i < TX_PLAN_CACHE_SIZE; i++) {
+        if (entry_matches(&plan_cache.entries[i], json)) {
+            return &plan_cache.entries[i];
+        }
+    }
+    return NULL;
+}
+
+__Z_INLINE plan_cache_entry_t *find_plan(const parsed_json_t *json, uint64_t values_key) {
+    for (uint8_t i = 0; i < TX_PLAN_CACHE_SIZE; i++) {
+        plan_cache_entry_t *entry = &plan_cache.entries[i];
+        if (entry->plan_valid && entry->values_key == values_key && entry_matches(entry, json)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// NULL if the shape of json is too large to be cached
+__Z_INLINE plan_cache_entry_t *evict_entry(const parsed_json_t *json) {
+    plan_cache_entry_t *victim = &plan_cache.entries[0];
+    for (uint8_t i = 0; i < TX_PLAN_CACHE_SIZE; i++) {
+        plan_cache_entry_t *entry = &plan_cache.entries[i];
+        if (!entry->used) {
+            victim = entry;
+            break;
+        }
+        if (entry->tick < victim->tick) {
+            victim = entry;
+        }
+    }
+
+    victim->used = false;
+    if (!shape_visit(json, victim->shape, &victim->shape_len, true)) {
+        return NULL;
+    }
+    victim->used = true;
+    victim->fingerprint = json->fingerprint;
+    victim->num_tokens = json->numberOfTokens;
+    victim->keys_sorted_valid = false;
+    victim->plan_valid = false;
+    return victim;
+}
+
+bool tx_plan_cache_getKeysSorted(const parsed_json_t *json, bool *sorted) {
+    plan_cache_entry_t *entry = find_entry(json);
+    if (entry == NULL || !entry->keys_sorted_valid) {
+        return false;
+    }
+    entry->tick = ++plan_cache.tick;
+    *sorted = entry->keys_sorted;
+    return true;
+}
+
+void tx_plan_cache_setKeysSorted(const parsed_json_t *json, bool sorted) {
+    // Every entry of this shape shares the verdict
+    bool found = false;
+    for (uint8_t i = 0; i < TX_PLAN_CACHE_SIZE; i++) {
+        plan_cache_entry_t *entry = &plan_cache.entries[i];
+        if (entry_matches(entry, json)) {
+            entry->keys_sorted_valid = true;
+            entry->keys_sorted = sorted;
+            found = true;
+        }
+    }
+    if (!found) {
+        plan_cache_entry_t *entry = evict_entry(json);
+        if (entry == NULL) {
+            return;
+        }
+        entry->keys_sorted_valid = true;
+        entry->keys_sorted = sorted;
+        entry->tick = ++plan_cache.tick;
+    }
+}
+
+bool tx_plan_cache_load(const parsed_json_t *json, uint64_t values_key, display_plan_t *plan) {
+    plan_cache_entry_t *entry = find_plan(json, values_key);
+    if (entry == NULL) {
+        plan_cache.misses++;
+        return false;
+    }
+    plan_cache.hits++;
+    entry->tick = ++plan_cache.tick;
+    MEMCPY(plan, &entry->plan, sizeof(display_plan_t));
+    return true;
+}
+
+void tx_plan_cache_store(const parsed_json_t *json,
+                         uint64_t values_key,
+                         const display_plan_t *plan) {
+    // Reuse the entry of this shape that has no plan yet, other message types get their own
+    plan_cache_entry_t *entry = find_entry(json);
+    if (entry != NULL && entry->plan_valid && entry->values_key != values_key) {
+        const bool keys_sorted_valid = entry->keys_sorted_valid;
+        const bool keys_sorted = entry->keys_sorted;
+        entry = evict_entry(json);
+        if (entry == NULL) {
+            return;
+        }
+        entry->keys_sorted_valid = keys_sorted_valid;
+        entry->keys_sorted = keys_sorted;
+    }
+    if (entry == NULL) {
+        entry = evict_entry(json);
+    }
+    if (entry == NULL) {
+        return;
+    }
+
+    entry->plan_valid = true;
+    entry->values_key = values_key;
+    entry->tick = ++plan_cache.tick;
+    MEMCPY(&entry->plan, plan, sizeof(display_plan_t));
+}
+
+void tx_plan_cache_clear() {
+    MEMZERO(&plan_cache, sizeof(plan_cache));
+}
+
+void tx_plan_cache_stats(uint32_t *hits, uint32_t *misses) {
+    *hits = plan_cache.hits;
+    *misses = plan_cache.misses;
+}
+
+#endif
@@ -0,0 +1,69 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "json/json_parser.h"
+#include "tx_display.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Txs with the same shape (same fingerprint) share their key order verdict and display plan.
+// The cache is only built for host services (DISPLAY_PLAN_CACHE), devices sign one tx at a time.
+#define TX_PLAN_CACHE_SIZE 8
+// Txs with a larger shape (token types, sizes and keys) are not cached
+#define TX_PLAN_CACHE_SHAPE_SIZE 8192
+
+/// Key order verdict of a tx with the same shape
+/// \param json: parsed tx
+/// \param sorted: verdict of dictionaries_sorted
+/// \return true if the verdict was cached
+bool tx_plan_cache_getKeysSorted(const parsed_json_t *json, bool *sorted);
+
+/// Remember the key order verdict of a tx
+/// \param json: parsed tx
+/// \param sorted: verdict of dictionaries_sorted
+void tx_plan_cache_setKeysSorted(const parsed_json_t *json, bool sorted);
+
+/// Display plan of a tx with the same shape
+/// \param json: parsed tx
+/// \param values_key: hash of the values the plan depends on (message types, empty memo)
+/// \param plan: filled on a hit
+/// \return true if the plan was cached
+bool tx_plan_cache_load(const parsed_json_t *json, uint64_t values_key, display_plan_t *plan);
+
+/// Remember the display plan of a tx
+/// \param json: parsed tx
+/// \param values_key: hash of the values the plan depends on (message types, empty memo)
+/// \param plan
+void tx_plan_cache_store(const parsed_json_t *json, uint64_t values_key, const display_plan_t *plan);
+
+/// Drop all entries and reset the counters
+void tx_plan_cache_clear();
+
+/// Plan lookups since the last clear
+/// \param hits
+/// \param misses
+void tx_plan_cache_stats(uint32_t *hits, uint32_t *misses);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,301 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "tx_summary.h"
+#include "tx_parser.h"
+#include "tx_msgs.h"
+#include <zxmacros.h>
+
+void tx_summary_init(tx_summary_t *summary) {
+    MEMZERO(summary, sizeof(tx_summary_t));
+}
+
+parser_error_t tx_summary_add_decimal(char *acc,
+                                      uint16_t accSize,
+                                      const char *value,
+                                      uint16_t valueLen) {
+    if (acc == NULL || value == NULL || valueLen == 0) {
+        return parser_unexpected_value;
+    }
+    for (uint16_t i = 0; i < valueLen; i++) {
+        if (value[i] < '0' || value[i] > '9') {
+            return parser_unexpected_characters;
+        }
+    }
+    while (valueLen > 1 && value[0] == '0') {
+        value++;
+        valueLen--;
+    }
+
+    uint16_t accLen = 0;
+    while (accLen < accSize && acc[accLen] != '\0') {
+        accLen++;
+    }
+    if (accLen == accSize) {
+        return parser_unexpected_buffer_end;
+    }
+
+    // Right align both numbers with one extra digit for the carry
+    const uint16_t width = (accLen > valueLen ? accLen : valueLen) + 1;
+    if (width >= accSize) {
+        return parser_value_out_of_range;
+    }
+    MEMMOVE(acc + width - accLen, acc, accLen);
+    MEMSET(acc, '0', width - accLen);
+    acc[width] = '\0';
+
+    uint8_t carry = 0;
+    for (uint16_t i = 0; i < width; i++) {
+        const uint16_t pos = width - 1 - i;
+        uint8_t digit = (uint8_t)(acc[pos] - '0') + carry;
+        if (i < valueLen) {
+            digit += (uint8_t)(value[valueLen - 1 - i] - '0');
+        }
+        carry = digit / 10;
+        acc[pos] = (char) ('0' + digit % 10);
+    }
+
+    uint16_t leadingZeros = 0;
+    while (leadingZeros + 1 < width && acc[leadingZeros] == '0') {
+        leadingZeros++;
+    }
+    MEMMOVE(acc, acc + leadingZeros, width - leadingZeros + 1);
+
+    return parser_ok;
+}
+
+__Z_INLINE parser_error_t summary_get_string(const parsed_json_t *json,
+                                             uint16_t token_index,
+                                             const char **str,
+                                             uint16_t *str_len) {
+    if (JSON_TOKEN_TYPE(json, token_index) != JSMN_STRING ||
+        JSON_TOKEN_START(json, token_index) < 0 ||
+        JSON_TOKEN_END(json, token_index) < JSON_TOKEN_START(json, token_index)) {
+        return parser_unexpected_field;
+    }
+    *str = json->buffer + JSON_TOKEN_START(json, token_index);
+    *str_len = (uint16_t) JSON_TOKEN_LEN(json, token_index);
+    return parser_ok;
+}
+
+static parser_error_t summary_find_asset(tx_summary_t *summary,
+                                         const char *asset,
+                                         uint16_t asset_len,
+                                         tx_summary_asset_t **entry) {
+    if (asset_len == 0 || asset_len > TX_SUMMARY_MAX_ASSET_LEN) {
+        return parser_value_out_of_range;
+    }
+
+    for (uint8_t i = 0; i < summary->num_assets; i++) {
+        tx_summary_asset_t *candidate = &summary->assets[i];
+        if (strlen(candidate->asset) == asset_len && !MEMCMP(candidate->asset, asset, asset_len)) {
+            *entry = candidate;
+            return parser_ok;
+        }
+    }
+
+    if (summary->num_assets >= TX_SUMMARY_MAX_ASSETS) {
+        return parser_value_out_of_range;
+    }
+
+    *entry = &summary->assets[summary->num_assets++];
+    MEMCPY((*entry)->asset, asset, asset_len);
+    (*entry)->asset[asset_len] = '\0';
+    return parser_ok;
+}
+
+// Coin objects look like {"amount":"2000","denom":"rune"} or {"amount":"2000","asset":"THOR.RUNE"}
+static parser_error_t summary_add_coin(tx_summary_t *summary,
+                                       const parsed_json_t *json,
+                                       uint16_t coin_token,
+                                       bool is_fee) {
+    if (JSON_TOKEN_TYPE(json, coin_token) != JSMN_OBJECT) {
+        return parser_unexpected_field;
+    }
+
+    uint16_t amount_token = 0;
+    uint16_t asset_token = 0;
+    CHECK_PARSER_ERR(object_get_value(json, coin_token, "amount", &amount_token))
+    if (object_get_value(json, coin_token, "denom", &asset_token) != parser_ok) {
+        CHECK_PARSER_ERR(object_get_value(json, coin_token, "asset", &asset_token))
+    }
+
+    const char *amount = NULL;
+    uint16_t amount_len = 0;
+    const char *asset = NULL;
+    uint16_t asset_len = 0;
+    CHECK_PARSER_ERR(summary_get_string(json, amount_token, &amount, &amount_len))
+    CHECK_PARSER_ERR(summary_get_string(json, asset_token, &asset, &asset_len))
+
+    tx_summary_asset_t *entry = NULL;
+    CHECK_PARSER_ERR(summary_find_asset(summary, asset, asset_len, &entry))
+
+    if (is_fee) {
+        return tx_summary_add_decimal(entry->fee, sizeof(entry->fee), amount, amount_len);
+    }
+    return tx_summary_add_decimal(entry->amount, sizeof(entry->amount), amount, amount_len);
+}
+
+parser_error_t tx_summary_add_msg_type(tx_summary_t *summary, uint8_t msg_type) {
+    if (msg_type >= TX_SUMMARY_MAX_MSG_TYPES || msg_type >= tx_msgs_count()) {
+        return parser_unexpected_type;
+    }
+    summary->msg_counts[msg_type]++;
+    summary->num_msgs++;
+    return parser_ok;
+}
+
+parser_error_t tx_summary_add_coins(tx_summary_t *summary,
+                                    const parsed_json_t *json,
+                                    uint16_t token_index,
+                                    bool is_fee) {
+    if (JSON_TOKEN_TYPE(json, token_index) != JSMN_ARRAY) {
+        return summary_add_coin(summary, json, token_index, is_fee);
+    }
+
+    uint16_t num_coins = 0;
+    CHECK_PARSER_ERR(array_get_element_count(json, token_index, &num_coins))
+    for (uint16_t i = 0; i < num_coins; i++) {
+        uint16_t coin_token = 0;
+        CHECK_PARSER_ERR(array_get_nth_element(json, token_index, i, &coin_token))
+        CHECK_PARSER_ERR(summary_add_coin(summary, json, coin_token, is_fee))
+    }
+
+    return parser_ok;
+}
+
+parser_error_t tx_summary_add_destination(tx_summary_t *summary,
+                                          const parsed_json_t *json,
+                                          uint16_t token_index,
+                                          uint8_t msg_type,
+                                          uint8_t field) {
+    const char *value = NULL;
+    uint16_t value_len = 0;
+    CHECK_PARSER_ERR(summary_get_string(json, token_index, &value, &value_len))
+
+    for (uint8_t i = 0; i < summary->num_destinations; i++) {
+        const tx_summary_destination_t *dest = &summary->destinations[i];
+        if (dest->value_len == value_len && !MEMCMP(dest->value, value, value_len)) {
+            return parser_ok;
+        }
+    }
+
+    if (summary->num_destinations >= TX_SUMMARY_MAX_DESTINATIONS) {
+        return parser_value_out_of_range;
+    }
+
+    tx_summary_destination_t *dest = &summary->destinations[summary->num_destinations++];
+    dest->value = value;
+    dest->value_len = value_len;
+    dest->msg_type = msg_type;
+    dest->field = field;
+    return parser_ok;
+}
+
+static parser_error_t summary_add_msg(tx_summary_t *summary,
+                                      const parsed_json_t *json,
+                                      uint16_t msg_token) {
+    uint16_t type_token = 0;
+    uint16_t value_token = 0;
+    CHECK_PARSER_ERR(object_get_value(json, msg_token, "type", &type_token))
+    CHECK_PARSER_ERR(object_get_value(json, msg_token, "value", &value_token))
+
+    const char *type = NULL;
+    uint16_t type_len = 0;
+    CHECK_PARSER_ERR(summary_get_string(json, type_token, &type, &type_len))
+
+    // Amounts of unknown messages cannot be added up, they have to be reviewed one by one
+    const uint8_t msg_type = tx_msgs_find_type(type, type_len);
+    CHECK_PARSER_ERR(tx_summary_add_msg_type(summary, msg_type))
+    const msg_descriptor_t *desc = tx_msgs_descriptor(msg_type);
+
+    uint16_t num_elements = 0;
+    CHECK_PARSER_ERR(object_get_element_count(json, value_token, &num_elements))
+    for (uint16_t i = 0; i < num_elements; i++) {
+        uint16_t key_token = 0;
+        uint16_t field_value_token = 0;
+        CHECK_PARSER_ERR(object_get_nth_key(json, value_token, i, &key_token))
+        CHECK_PARSER_ERR(object_get_nth_value(json, value_token, i, &field_value_token))
+
+        const char *key = NULL;
+        uint16_t key_len = 0;
+        CHECK_PARSER_ERR(summary_get_string(json, key_token, &key, &key_len))
+
+        const uint8_t field = tx_msgs_find_field(msg_type, key, key_len);
+        if (field == MSG_FIELD_NONE) {
+            continue;
+        }
+
+        if (desc->fields[field].format == msg_format_amount) {
+            CHECK_PARSER_ERR(tx_summary_add_coins(summary, json, field_value_token, false))
+        }
+        if (desc->fields[field].destination) {
+            CHECK_PARSER_ERR(
+                tx_summary_add_destination(summary, json, field_value_token, msg_type, field))
+        }
+    }
+
+    return parser_ok;
+}
+
+parser_error_t tx_summary_add_tx(tx_summary_t *summary, const parsed_json_t *json) {
+    tx_root_fields_t root_fields;
+    CHECK_PARSER_ERR(tx_root_fields_match(json, &root_fields))
+
+    const uint8_t required =
+        (1u << root_item_chain_id) | (1u << root_item_fee) | (1u << root_item_msgs);
+    if ((root_fields.found & required) != required) {
+        return parser_missing_field;
+    }
+
+    const char *chain_id = NULL;
+    uint16_t chain_id_len = 0;
+    CHECK_PARSER_ERR(summary_get_string(
+        json, root_fields.value_token_idx[root_item_chain_id], &chain_id, &chain_id_len))
+    if (summary->num_txs == 0) {
+        summary->chain_id = chain_id;
+        summary->chain_id_len = chain_id_len;
+    } else if (summary->chain_id_len != chain_id_len ||
+               MEMCMP(summary->chain_id, chain_id, chain_id_len)) {
+        return parser_unexpected_chain;
+    }
+
+    uint16_t fee_amount_token = 0;
+    CHECK_PARSER_ERR(object_get_value(
+        json, root_fields.value_token_idx[root_item_fee], "amount", &fee_amount_token))
+    CHECK_PARSER_ERR(tx_summary_add_coins(summary, json, fee_amount_token, true))
+
+    // A batch only shows the summary, so every memo has to be listed in it
+    if (root_fields.found & (1u << root_item_memo)) {
+        const uint16_t memo_token = root_fields.value_token_idx[root_item_memo];
+        if (JSON_TOKEN_LEN(json, memo_token) > 0) {
+            CHECK_PARSER_ERR(tx_summary_add_destination(
+                summary, json, memo_token, MSG_TYPE_UNKNOWN, MSG_FIELD_NONE))
+        }
+    }
+
+    const uint16_t msgs_token = root_fields.value_token_idx[root_item_msgs];
+    uint16_t num_msgs = 0;
+    CHECK_PARSER_ERR(array_get_element_count(json, msgs_token, &num_msgs))
+    for (uint16_t i = 0; i < num_msgs; i++) {
+        uint16_t msg_token = 0;
+        CHECK_PARSER_ERR(array_get_nth_element(json, msgs_token, i, &msg_token))
+        CHECK_PARSER_ERR(summary_add_msg(summary, json, msg_token))
+    }
+
+    summary->num_txs++;
+    return parser_ok;
+}
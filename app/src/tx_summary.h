@@ -0,0 +1,130 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "json/json_parser.h"
+#include "common/parser_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(TARGET_NANOS)
+#define TX_SUMMARY_MAX_ASSETS       2
+#define TX_SUMMARY_MAX_DESTINATIONS 4
+#else
+#define TX_SUMMARY_MAX_ASSETS       4
+#define TX_SUMMARY_MAX_DESTINATIONS 8
+#endif
+
+#define TX_SUMMARY_MAX_MSG_TYPES  4
+#define TX_SUMMARY_MAX_ASSET_LEN  24
+#define TX_SUMMARY_MAX_AMOUNT_LEN 40
+
+typedef struct {
+    char asset[TX_SUMMARY_MAX_ASSET_LEN + 1];
+    // decimal strings without leading zeros, empty if nothing was added
+    char amount[TX_SUMMARY_MAX_AMOUNT_LEN + 1];
+    char fee[TX_SUMMARY_MAX_AMOUNT_LEN + 1];
+} tx_summary_asset_t;
+
+typedef struct {
+    // points into the transaction buffer, which must outlive the summary
+    const char *value;
+    uint16_t value_len;
+    // registry entry of the field, used for the label, MSG_TYPE_UNKNOWN for the root memo
+    uint8_t msg_type;
+    uint8_t field;
+} tx_summary_destination_t;
+
+// Aggregated view of one or more transactions
+typedef struct {
+    // transactions added with tx_summary_add_tx, zero when summarizing a single transaction
+    uint16_t num_txs;
+    uint16_t num_msgs;
+    // messages per registry entry
+    uint16_t msg_counts[TX_SUMMARY_MAX_MSG_TYPES];
+
+    // all transactions must use the same chain
+    const char *chain_id;
+    uint16_t chain_id_len;
+
+    uint8_t num_assets;
+    tx_summary_asset_t assets[TX_SUMMARY_MAX_ASSETS];
+
+    uint8_t num_destinations;
+    tx_summary_destination_t destinations[TX_SUMMARY_MAX_DESTINATIONS];
+} tx_summary_t;
+
+void tx_summary_init(tx_summary_t *summary);
+
+/// Add a decimal number to an accumulator
+/// \param acc: terminated decimal string, empty counts as zero
+/// \param accSize: size of the acc buffer
+/// \param value: digits only, does not need to be terminated
+/// \param valueLen
+/// \return parser_value_out_of_range if the sum does not fit in acc
+parser_error_t tx_summary_add_decimal(char *acc,
+                                      uint16_t accSize,
+                                      const char *value,
+                                      uint16_t valueLen);
+
+/// Count a message
+/// \param summary
+/// \param msg_type: registry entry of the message
+/// \return parser_unexpected_type for unregistered messages
+parser_error_t tx_summary_add_msg_type(tx_summary_t *summary, uint8_t msg_type);
+
+/// Add a coin object or an array of them to the totals or the fees
+/// \param summary
+/// \param json
+/// \param token_index: e.g. the value of "amount" or "fee/amount"
+/// \param is_fee
+/// \return Error message
+parser_error_t tx_summary_add_coins(tx_summary_t *summary,
+                                    const parsed_json_t *json,
+                                    uint16_t token_index,
+                                    bool is_fee);
+
+/// Add a destination if it was not seen before
+/// \param summary
+/// \param json
+/// \param token_index: string token, the tx buffer must outlive the summary
+/// \param msg_type: registry entry of the message, MSG_TYPE_UNKNOWN for the root memo
+/// \param field: field of the message, provides the label
+/// \return parser_value_out_of_range if there are too many destinations
+parser_error_t tx_summary_add_destination(tx_summary_t *summary,
+                                          const parsed_json_t *json,
+                                          uint16_t token_index,
+                                          uint8_t msg_type,
+                                          uint8_t field);
+
+/// Add the messages and fee of a parsed transaction to the summary
+/// Amounts and destinations are taken from the fields flagged in the message registry,
+/// a non-empty root memo is listed with the destinations.
+/// \param summary
+/// \param json: must stay valid only during the call, the tx buffer must outlive the summary
+/// \return parser_unexpected_type for unregistered messages (they cannot be summarized),
+///         parser_unexpected_chain if the chain differs from previous transactions,
+///         parser_value_out_of_range if the destinations and memos do not fit
+parser_error_t tx_summary_add_tx(tx_summary_t *summary, const parsed_json_t *json);
+
+#ifdef __cplusplus
+}
+#endif
@@ -17,50 +17,58 @@
 #include <jsmn.h>
 #include <common/parser_common.h>
 #include "json/json_parser.h"
+#include "tx_parser.h"
+#include "tx_plan_cache.h"
 
-const char whitespaces[] = {
-    0x20,  // space ' '
-    0x0c,  // form_feed '\f'
-    0x0a,  // line_feed, '\n'
-    0x0d,  // carriage_return, '\r'
-    0x09,  // horizontal_tab, '\t'
-    0x0b   // vertical_tab, '\v'
-};
+// Whitespace between tokens and raw control characters inside strings are checked in a
+// single pass over the buffer, classifying each byte with json_char_class
+static parser_error_t check_whitespace(parsed_json_t *json) {
+    uint32_t start = 0;
 
-int8_t is_space(char c) {
-    for (uint16_t i = 0; i < sizeof(whitespaces); i++) {
-        if (whitespaces[i] == c) {
-            return 1;
+    // Starting at token 1 because token 0 contains full tx
+    for (uint32_t i = 1; i < json->numberOfTokens; i++) {
+        const uint32_t token_start = JSON_TOKEN_START(json, i);
+        const uint32_t token_end = JSON_TOKEN_END(json, i);
+
+        if (JSON_TOKEN_TYPE(json, i) == JSMN_UNDEFINED) {
+            return parser_ok;
         }
-    }
-    return 0;
-}
 
-int8_t contains_whitespace(parsed_json_t *json) {
-    int start = 0;
-    const int last_element_index = json->tokens[0].end;
+        if (token_start > start &&
+            json_find_char_class(json->buffer + start, token_start - start,
+                                 JSON_CHAR_SPACE) < token_start - start) {
+            return parser_json_contains_whitespace;
+        }
 
-    // Starting at token 1 because token 0 contains full tx
-    for (uint32_t i = 1; i < json->numberOfTokens; i++) {
-        if (json->tokens[i].type != JSMN_UNDEFINED) {
-            const int end = json->tokens[i].start;
-            for (int j = start; j < end; j++) {
-                if (is_space(json->buffer[j]) == 1) {
-                    return 1;
+        switch (JSON_TOKEN_TYPE(json, i)) {
+            case JSMN_STRING:
+                if (json_find_char_class(json->buffer + token_start, token_end - token_start,
+                                         JSON_CHAR_CONTROL) < token_end - token_start) {
+                    return parser_json_contains_control_char;
                 }
-            }
-            start = json->tokens[i].end + 1;
-        } else {
-            return 0;
+                // skip the closing quote
+                start = token_end + 1;
+                break;
+            case JSMN_OBJECT:
+            case JSMN_ARRAY:
+                // children follow the opening bracket
+                start = token_start + 1;
+                break;
+            default:
+                start = token_end;
+                break;
         }
     }
-    while (start <= last_element_index && json->buffer[start] != '\0') {
-        if (is_space(json->buffer[start])) {
-            return 1;
-        }
-        start++;
+
+    uint32_t end = JSON_TOKEN_END(json, 0) + 1;
+    if (end > json->bufferLen) {
+        end = json->bufferLen;
     }
-    return 0;
+    if (end > start &&
+        json_find_char_class(json->buffer + start, end - start, JSON_CHAR_SPACE) < end - start) {
+        return parser_json_contains_whitespace;
+    }
+    return parser_ok;
 }
 
 int8_t is_sorted(int16_t first_index, int16_t second_index, parsed_json_t *json) {
@@ -76,8 +84,8 @@ int8_t is_sorted(int16_t first_index, int16_t second_index, parsed_json_t *json)
     second[size] = '\0';
 #endif
 
-    if (strcmp((json->buffer + json->tokens[first_index].start),
-               (json->buffer + json->tokens[second_index].start)) <= 0) {
+    if (strcmp((json->buffer + JSON_TOKEN_START(json, first_index)),
+               (json->buffer + JSON_TOKEN_START(json, second_index))) <= 0) {
         return 1;
     }
     return 0;
@@ -85,7 +93,7 @@ int8_t is_sorted(int16_t first_index, int16_t second_index, parsed_json_t *json)
 
 int8_t dictionaries_sorted(parsed_json_t *json) {
     for (uint32_t i = 0; i < json->numberOfTokens; i++) {
-        if (json->tokens[i].type == JSMN_OBJECT) {
+        if (JSON_TOKEN_TYPE(json, i) == JSMN_OBJECT) {
             uint16_t count;
 
             if (object_get_element_count(json, i, &count) != parser_ok) {
@@ -116,35 +124,81 @@ int8_t dictionaries_sorted(parsed_json_t *json) {
     return 1;
 }
 
-parser_error_t tx_validate(parsed_json_t *json) {
-    if (contains_whitespace(json) == 1) {
-        return parser_json_contains_whitespace;
-    }
+#if defined(DISPLAY_PLAN_CACHE)
+// Equal keys are compared up to their values, so only then the key order verdict is not given
+// by the shape of the tx
+static bool has_equal_adjacent_keys(const parsed_json_t *json) {
+    for (uint32_t i = 0; i < json->numberOfTokens; i++) {
+        uint16_t count;
+        if (JSON_TOKEN_TYPE(json, i) != JSMN_OBJECT ||
+            object_get_element_count(json, i, &count) != parser_ok) {
+            continue;
+        }
 
-    if (dictionaries_sorted(json) != 1) {
-        return parser_json_is_not_sorted;
+        for (uint16_t j = 1; j < count; j++) {
+            uint16_t prev_token_index;
+            uint16_t next_token_index;
+            if (object_get_nth_key(json, i, j - 1, &prev_token_index) != parser_ok ||
+                object_get_nth_key(json, i, j, &next_token_index) != parser_ok) {
+                return true;
+            }
+            const uint16_t len = JSON_TOKEN_LEN(json, prev_token_index);
+            if (len == JSON_TOKEN_LEN(json, next_token_index) &&
+                !MEMCMP(json->buffer + JSON_TOKEN_START(json, prev_token_index),
+                        json->buffer + JSON_TOKEN_START(json, next_token_index),
+                        len)) {
+                return true;
+            }
+        }
     }
+    return false;
+}
 
-    uint16_t token_index;
-    parser_error_t err;
+// Txs with the same shape share the verdict
+static bool keys_sorted(parsed_json_t *json) {
+    bool sorted = false;
+    if (tx_plan_cache_getKeysSorted(json, &sorted)) {
+        return sorted;
+    }
 
-    err = object_get_value(json, 0, "account_number", &token_index);
-    if (err != parser_ok) return parser_json_missing_account_number;
+    sorted = dictionaries_sorted(json) == 1;
+    if (!has_equal_adjacent_keys(json)) {
+        tx_plan_cache_setKeysSorted(json, sorted);
+    }
+    return sorted;
+}
+#else
+__Z_INLINE bool keys_sorted(parsed_json_t *json) {
+    return dictionaries_sorted(json) == 1;
+}
+#endif
 
-    err = object_get_value(json, 0, "chain_id", &token_index);
-    if (err != parser_ok) return parser_json_missing_chain_id;
+// Indexed by root_item_e
+static const parser_error_t missing_root_item_error[NUM_REQUIRED_ROOT_PAGES] = {
+    parser_json_missing_account_number,
+    parser_json_missing_chain_id,
+    parser_json_missing_fee,
+    parser_json_missing_memo,
+    parser_json_missing_msgs,
+    parser_json_missing_sequence,
+};
 
-    err = object_get_value(json, 0, "fee", &token_index);
-    if (err != parser_ok) return parser_json_missing_fee;
+parser_error_t tx_validate(parsed_json_t *json, tx_root_fields_t *root_fields) {
+    CHECK_PARSER_ERR(check_whitespace(json))
 
-    err = object_get_value(json, 0, "memo", &token_index);
-    if (err != parser_ok) return parser_json_missing_memo;
+    if (!keys_sorted(json)) {
+        return parser_json_is_not_sorted;
+    }
 
-    err = object_get_value(json, 0, "msgs", &token_index);
-    if (err != parser_ok) return parser_json_missing_msgs;
+    CHECK_PARSER_ERR(tx_root_fields_match(json, root_fields))
 
-    err = object_get_value(json, 0, "sequence", &token_index);
-    if (err != parser_ok) return parser_json_missing_sequence;
+    // Report the first missing field in canonical order
+    const parser_error_t *errors = (const parser_error_t *) PIC(missing_root_item_error);
+    for (uint8_t i = 0; i < NUM_REQUIRED_ROOT_PAGES; i++) {
+        if (!(root_fields->found & (1u << i))) {
+            return errors[i];
+        }
+    }
 
     return parser_ok;
 }
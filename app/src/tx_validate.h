@@ -19,6 +19,7 @@
 #include "json/json_parser.h"
 #include <stdint.h>
 #include <common/parser_common.h>
+#include "parser_txdef.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,9 +27,9 @@ extern "C" {
 
 /// Validate json transaction
 /// \param parsed_transacton
-/// \param transaction
+/// \param root_fields (out) required root fields, located while checking that none is missing
 /// \return
-parser_error_t tx_validate(parsed_json_t *json);
+parser_error_t tx_validate(parsed_json_t *json, tx_root_fields_t *root_fields);
 
 #ifdef __cplusplus
 }
@@ -22,7 +22,7 @@ static jsmntok_t *jsmn_alloc_token(jsmn_parser *parser,
  * Fills token type and boundaries.
  */
 static void jsmn_fill_token(jsmntok_t *token, jsmntype_t type,
-                            short int start, short int end) {
+                            jsmnint_t start, jsmnint_t end) {
     token->type = type;
     token->start = start;
     token->end = end;
@@ -35,7 +35,7 @@ static void jsmn_fill_token(jsmntok_t *token, jsmntype_t type,
 static int jsmn_parse_primitive(jsmn_parser *parser, const char *js,
                                 size_t len, jsmntok_t *tokens, size_t num_tokens) {
     jsmntok_t *token;
-    short int start;
+    jsmnint_t start;
 
     start = parser->pos;
 
@@ -90,7 +90,7 @@ static int jsmn_parse_string(jsmn_parser *parser, const char *js,
                              size_t len, jsmntok_t *tokens, size_t num_tokens) {
     jsmntok_t *token;
 
-    short int start = parser->pos;
+    jsmnint_t start = parser->pos;
 
     parser->pos++;
 
@@ -117,7 +117,7 @@ static int jsmn_parse_string(jsmn_parser *parser, const char *js,
 
         /* Backslash: Quoted symbol expected */
         if (c == '\\' && parser->pos + 1 < len) {
-            short int i;
+            jsmnint_t i;
             parser->pos++;
             switch (js[parser->pos]) {
                 /* Allowed escaped symbols */
@@ -161,10 +161,10 @@ static int jsmn_parse_string(jsmn_parser *parser, const char *js,
  */
 int jsmn_parse(jsmn_parser *parser, const char *js, size_t len,
                jsmntok_t *tokens, unsigned int num_tokens) {
-    short int r;
-    short int i;
+    jsmnint_t r;
+    jsmnint_t i;
     jsmntok_t *token;
-    short int count = parser->toknext;
+    jsmnint_t count = parser->toknext;
 
     for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++) {
         char c;
@@ -7,6 +7,18 @@
 extern "C" {
 #endif
 
+/**
+ * Integer types used for offsets and token indexes. Define JSMN_WIDE_TOKENS
+ * to parse inputs larger than 32 KB, at the cost of bigger tokens.
+ */
+#ifdef JSMN_WIDE_TOKENS
+typedef int jsmnint_t;
+typedef unsigned int jsmnuint_t;
+#else
+typedef short int jsmnint_t;
+typedef unsigned short int jsmnuint_t;
+#endif
+
 /**
  * JSON type identifier. Basic types are:
  * 	o Object
@@ -39,11 +51,11 @@ enum jsmnerr {
  */
 typedef struct {
 	jsmntype_t type;
-	short int start;
-	short int end;
-	short int size;
+	jsmnint_t start;
+	jsmnint_t end;
+	jsmnint_t size;
 #ifdef JSMN_PARENT_LINKS
-	short int parent;
+	jsmnint_t parent;
 #endif
 } jsmntok_t;
 
@@ -52,9 +64,9 @@ typedef struct {
  * the string being parsed now and current position in that string
  */
 typedef struct {
-	unsigned short int pos; /* offset in the JSON string */
-	unsigned short int toknext; /* next token to allocate */
-	short int toksuper; /* superior token node, e.g parent object or array */
+	jsmnuint_t pos; /* offset in the JSON string */
+	jsmnuint_t toknext; /* next token to allocate */
+	jsmnint_t toksuper; /* superior token node, e.g parent object or array */
 } jsmn_parser;
 
 /**
@@ -50,8 +50,8 @@ typedef struct {
         };
     };
     address_kind_e addrKind;
-    uint8_t itemIdx;
-    uint8_t itemCount;
+    uint16_t itemIdx;
+    uint16_t itemCount;
     uint8_t pageIdx;
     uint8_t pageCount;
 } view_t;
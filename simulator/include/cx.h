@@ -0,0 +1,50 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#pragma once
+
+// SHA-256 subset of the BOLOS cx API, backed by the host software implementation
+
+#include "host/sha2.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CX_LAST        1
+#define CX_SHA256_SIZE SW_SHA256_SIZE
+
+typedef struct {
+    sw_sha256_t header;
+} cx_sha256_t;
+
+int cx_sha256_init(cx_sha256_t *hash);
+
+int cx_hash(sw_sha256_t *hash,
+            int mode,
+            const unsigned char *in,
+            unsigned int len,
+            unsigned char *out,
+            unsigned int out_len);
+
+int cx_hash_sha256(const unsigned char *in,
+                   unsigned int len,
+                   unsigned char *out,
+                   unsigned int out_len);
+
+#ifdef __cplusplus
+}
+#endif
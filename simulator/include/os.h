@@ -0,0 +1,158 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#pragma once
+
+// Minimal stand-in for the BOLOS SDK so the APDU handling code runs on a host.
+// Only what the app uses is provided. Exceptions use setjmp/longjmp like the SDK.
+
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef LEDGER_MAJOR_VERSION
+#define LEDGER_MAJOR_VERSION 0
+#define LEDGER_MINOR_VERSION 0
+#define LEDGER_PATCH_VERSION 0
+#endif
+
+#define TARGET_ID     0x33000004
+#define IS_UX_ALLOWED 1
+
+////////////////////////////////////////
+// Exceptions
+////////////////////////////////////////
+
+typedef unsigned short exception_t;
+
+typedef struct try_context_s {
+    jmp_buf jmp_buf;
+    struct try_context_s *previous;
+    exception_t ex;
+} try_context_t;
+
+#define EXCEPTION         1
+#define INVALID_PARAMETER 2
+#define EXCEPTION_IO_RESET 0x10
+
+try_context_t *try_context_get();
+try_context_t *try_context_set(try_context_t *context);
+void os_longjmp(unsigned int exception) __attribute__((noreturn));
+
+#define BEGIN_TRY {                                                       \
+    try_context_t __try;
+
+#define TRY                                                               \
+    __try.ex = setjmp(__try.jmp_buf);                                     \
+    if (__try.ex == 0) {                                                  \
+        __try.previous = try_context_set(&__try);
+
+#define CATCH(x)                                                          \
+        goto __FINALLY;                                                   \
+    } else if (__try.ex == (x)) {                                         \
+        __try.ex = 0;                                                     \
+        try_context_set(__try.previous);
+
+#define CATCH_OTHER(e)                                                    \
+        goto __FINALLY;                                                   \
+    } else {                                                              \
+        exception_t e;                                                    \
+        e = __try.ex;                                                     \
+        __try.ex = 0;                                                     \
+        try_context_set(__try.previous);
+
+#define CATCH_ALL                                                         \
+        goto __FINALLY;                                                   \
+    } else {                                                              \
+        __try.ex = 0;                                                     \
+        try_context_set(__try.previous);
+
+#define FINALLY                                                           \
+        goto __FINALLY;                                                   \
+    }                                                                     \
+    __FINALLY:                                                            \
+    if (try_context_get() == &__try) {                                    \
+        try_context_set(__try.previous);                                  \
+    }
+
+#define END_TRY                                                           \
+    if (__try.ex != 0) {                                                  \
+        os_longjmp(__try.ex);                                             \
+    }                                                                     \
+    }
+
+#define THROW(x) os_longjmp(x)
+
+////////////////////////////////////////
+// IO
+////////////////////////////////////////
+
+#define IO_APDU_BUFFER_SIZE          (5 + 255)
+#define IO_SEPROXYHAL_BUFFER_SIZE_B  128
+
+#define CHANNEL_APDU           0
+#define CHANNEL_KEYBOARD       1
+#define CHANNEL_SPI            2
+#define IO_RESET_AFTER_REPLIED 0x80
+#define IO_RECEIVE_DATA        0x40
+#define IO_RETURN_AFTER_TX     0x20
+#define IO_ASYNCH_REPLY        0x10
+#define IO_FLAGS               0xF8
+
+#define SEPROXYHAL_TAG_BUTTON_PUSH_EVENT       0x05
+#define SEPROXYHAL_TAG_FINGER_EVENT            0x0C
+#define SEPROXYHAL_TAG_DISPLAY_PROCESSED_EVENT 0x0D
+#define SEPROXYHAL_TAG_TICKER_EVENT            0x0E
+
+extern unsigned char G_io_apdu_buffer[IO_APDU_BUFFER_SIZE];
+extern unsigned char G_io_seproxyhal_spi_buffer[IO_SEPROXYHAL_BUFFER_SIZE_B];
+
+unsigned short io_exchange(unsigned char channel_and_flags, unsigned short tx_len);
+
+void io_seproxyhal_init();
+void io_seproxyhal_general_status();
+unsigned int io_seproxyhal_spi_is_status_sent();
+void io_seproxyhal_spi_send(const unsigned char *buffer, unsigned short length);
+unsigned short io_seproxyhal_spi_recv(unsigned char *buffer,
+                                      unsigned short maxlength,
+                                      unsigned int flags);
+void USB_power(unsigned char enabled);
+void reset();
+
+unsigned int os_version(unsigned char *version, unsigned int maxlength);
+unsigned int os_seph_version(unsigned char *version, unsigned int maxlength);
+
+////////////////////////////////////////
+// UX (there is no screen, the simulator drives the review)
+////////////////////////////////////////
+
+#define UX_ALLOWED                                  1
+#define UX_DISPLAYED()                              1
+#define UX_DISPLAYED_EVENT()
+#define UX_REDISPLAY()
+#define UX_DEFAULT_EVENT()
+#define UX_FINGER_EVENT(seph_packet)
+#define UX_BUTTON_PUSH_EVENT(seph_packet)
+#define UX_TICKER_EVENT(seph_packet, callback)      callback
+
+#ifdef __cplusplus
+}
+#endif
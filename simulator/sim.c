@@ -0,0 +1,341 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "sim.h"
+
+#include <os.h>
+#include <cx.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "app_main.h"
+#include "app_mode.h"
+#include "actions.h"
+#include "buffering.h"
+#include "crypto.h"
+#include "tx.h"
+#include "view.h"
+
+unsigned char G_io_apdu_buffer[IO_APDU_BUFFER_SIZE];
+
+static try_context_t *current_context = NULL;
+static sim_result_t *current_result = NULL;
+static sim_pending_e pending = sim_pending_none;
+
+////////////////////////////////////////
+// SDK stubs
+////////////////////////////////////////
+
+try_context_t *try_context_get() {
+    return current_context;
+}
+
+try_context_t *try_context_set(try_context_t *context) {
+    try_context_t *previous = current_context;
+    current_context = context;
+    return previous;
+}
+
+void os_longjmp(unsigned int exception) {
+    if (current_context == NULL) {
+        fprintf(stderr, "uncaught exception 0x%04X\n", exception);
+        abort();
+    }
+    longjmp(current_context->jmp_buf, exception);
+}
+
+unsigned short io_exchange(unsigned char channel_and_flags, unsigned short tx_len) {
+    // Asynchronous replies (after a review) are captured here
+    if (current_result != NULL && tx_len <= sizeof(current_result->reply)) {
+        MEMCPY(current_result->reply, G_io_apdu_buffer, tx_len);
+        current_result->reply_len = tx_len;
+    }
+    return 0;
+}
+
+void io_seproxyhal_init() {}
+
+void io_seproxyhal_general_status() {}
+
+unsigned int io_seproxyhal_spi_is_status_sent() {
+    return 1;
+}
+
+void io_seproxyhal_spi_send(const unsigned char *buffer, unsigned short length) {}
+
+unsigned short io_seproxyhal_spi_recv(unsigned char *buffer,
+                                      unsigned short maxlength,
+                                      unsigned int flags) {
+    return 0;
+}
+
+void USB_power(unsigned char enabled) {}
+
+void reset() {}
+
+unsigned int os_version(unsigned char *version, unsigned int maxlength) {
+    return 0;
+}
+
+unsigned int os_seph_version(unsigned char *version, unsigned int maxlength) {
+    return 0;
+}
+
+int cx_sha256_init(cx_sha256_t *hash) {
+    sw_sha256_init(&hash->header);
+    return 0;
+}
+
+int cx_hash(sw_sha256_t *hash,
+            int mode,
+            const unsigned char *in,
+            unsigned int len,
+            unsigned char *out,
+            unsigned int out_len) {
+    if (in != NULL && len > 0) {
+        sw_sha256_update(hash, in, len);
+    }
+    if (mode & CX_LAST) {
+        sw_sha256_final(hash, out);
+        return CX_SHA256_SIZE;
+    }
+    return 0;
+}
+
+int cx_hash_sha256(const unsigned char *in,
+                   unsigned int len,
+                   unsigned char *out,
+                   unsigned int out_len) {
+    if (out_len < CX_SHA256_SIZE) {
+        return 0;
+    }
+    sw_sha256(in, len, out);
+    return CX_SHA256_SIZE;
+}
+
+void view_init() {}
+
+void view_idle_show(uint8_t item_idx) {}
+
+void view_error_show() {}
+
+void view_address_show(address_kind_e addressKind) {
+    pending = sim_pending_address;
+}
+
+void view_sign_show() {
+    pending = sim_pending_sign;
+}
+
+////////////////////////////////////////
+// Stack painting
+////////////////////////////////////////
+
+#if defined(__SANITIZE_ADDRESS__)
+#define SIM_MEASURE_STACK 0
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define SIM_MEASURE_STACK 0
+#endif
+#endif
+
+#ifndef SIM_MEASURE_STACK
+#define SIM_MEASURE_STACK 1
+#endif
+
+#define SIM_STACK_PAINT_SIZE (64 * 1024)
+#define SIM_STACK_PATTERN    0xA5
+
+static volatile uint8_t *painted_low = NULL;
+static bool measure_stack = false;
+
+void sim_set_stack_measurement(bool enabled) {
+    measure_stack = enabled && SIM_MEASURE_STACK;
+}
+
+// Fill the stack below the caller frame with a pattern
+__attribute__((noinline)) static void stack_paint() {
+    volatile uint8_t area[SIM_STACK_PAINT_SIZE];
+    for (size_t i = 0; i < sizeof(area); i++) {
+        area[i] = SIM_STACK_PATTERN;
+    }
+    painted_low = area;
+}
+
+// Distance from top to the deepest byte that was overwritten since stack_paint
+__attribute__((noinline)) static uint32_t stack_used(const volatile uint8_t *top) {
+    if (!measure_stack || painted_low == NULL) {
+        return 0;
+    }
+    for (const volatile uint8_t *p = painted_low; p < top; p++) {
+        if (*p != SIM_STACK_PATTERN) {
+            return (uint32_t)(top - p);
+        }
+    }
+    return 0;
+}
+
+////////////////////////////////////////
+// Simulator
+////////////////////////////////////////
+
+const char *sim_ins_name(uint8_t ins) {
+    switch (ins) {
+        case INS_GET_VERSION:
+            return "GET_VERSION";
+        case INS_SIGN_SECP256K1:
+            return "SIGN_SECP256K1";
+        case INS_GET_ADDR_SECP256K1:
+            return "GET_ADDR_SECP256K1";
+        case INS_GET_ADDR_BATCH:
+            return "GET_ADDR_BATCH";
+        case INS_GET_SIGN_STATS:
+            return "GET_SIGN_STATS";
+        default:
+            return NULL;
+    }
+}
+
+void sim_init() {
+    app_mode_reset();
+    crypto_clear_address_cache();
+    app_sign_review_end();
+    tx_initialize();
+    tx_reset();
+    pending = sim_pending_none;
+}
+
+// Same handling as app_main, one APDU at a time
+__attribute__((noinline)) void sim_exchange(const uint8_t *apdu,
+                                            uint16_t apdu_len,
+                                            sim_result_t *result) {
+    const volatile uint8_t *top = (const volatile uint8_t *) __builtin_frame_address(0);
+    MEMZERO(result, sizeof(sim_result_t));
+
+    volatile uint32_t rx = apdu_len, tx = 0, flags = 0;
+    if (apdu_len > IO_APDU_BUFFER_SIZE) {
+        rx = 0;
+    } else {
+        MEMCPY(G_io_apdu_buffer, apdu, apdu_len);
+    }
+    pending = sim_pending_none;
+
+    if (measure_stack) {
+        stack_paint();
+    }
+
+    BEGIN_TRY {
+        TRY {
+            if (rx == 0) {
+                THROW(APDU_CODE_EMPTY_BUFFER);
+            }
+            handleApdu(&flags, &tx, rx);
+        }
+        CATCH_OTHER(e) {
+            uint16_t sw;
+            switch (e & 0xF000) {
+                case 0x6000:
+                case 0x9000:
+                    sw = e;
+                    break;
+                default:
+                    sw = 0x6800 | (e & 0x7FF);
+                    break;
+            }
+            G_io_apdu_buffer[tx] = sw >> 8;
+            G_io_apdu_buffer[tx + 1] = sw;
+            tx += 2;
+        }
+        FINALLY {}
+    }
+    END_TRY;
+
+    result->stack_used = stack_used(top);
+
+    if (flags & IO_ASYNCH_REPLY) {
+        result->pending = pending;
+        return;
+    }
+    pending = sim_pending_none;
+    result->reply_len = tx;
+    MEMCPY(result->reply, G_io_apdu_buffer, tx);
+}
+
+__attribute__((noinline)) void sim_resolve(bool approve, sim_result_t *result) {
+    const volatile uint8_t *top = (const volatile uint8_t *) __builtin_frame_address(0);
+    MEMZERO(result, sizeof(sim_result_t));
+
+    if (measure_stack) {
+        stack_paint();
+    }
+
+    current_result = result;
+    BEGIN_TRY {
+        TRY {
+            if (!approve) {
+                app_reject();
+            } else if (pending == sim_pending_sign) {
+                app_sign();
+            } else if (pending == sim_pending_address) {
+                app_reply_address(addr_secp256k1);
+            }
+        }
+        CATCH_OTHER(e) {
+            fprintf(stderr, "exception 0x%04X while replying\n", e);
+        }
+        FINALLY {}
+    }
+    END_TRY;
+    current_result = NULL;
+    pending = sim_pending_none;
+
+    result->stack_used = stack_used(top);
+}
+
+void sim_tick(uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        app_sign_tick();
+    }
+}
+
+void sim_tx_buffer_usage(uint32_t *ram_bytes, uint32_t *flash_bytes) {
+    *ram_bytes = buffering_get_ram_buffer()->pos;
+    *flash_bytes = buffering_get_flash_buffer()->pos;
+}
+
+uint32_t sim_review_pages() {
+    char key[40];
+    char value[40];
+
+    uint16_t num_items = 0;
+    if (pending != sim_pending_sign || tx_getNumItems(&num_items) != tx_no_error) {
+        return 0;
+    }
+
+    uint32_t pages = 0;
+    for (uint16_t idx = 0; idx < num_items; idx++) {
+        uint8_t page_count = 1;
+        for (uint8_t page = 0; page < page_count; page++) {
+            if (tx_getItem(idx, key, sizeof(key), value, sizeof(value), page, &page_count) !=
+                tx_no_error) {
+                break;
+            }
+            pages++;
+        }
+    }
+    return pages;
+}
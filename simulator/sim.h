@@ -0,0 +1,71 @@
+/*******************************************************************************
+ *   (c) 2018, 2019 Zondax GmbH
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#pragma once
+
+// C side of the APDU simulator: runs the app handlers with the stubbed SDK
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    sim_pending_none = 0,
+    sim_pending_address,
+    sim_pending_sign,
+} sim_pending_e;
+
+typedef struct {
+    // reply (data and status word)
+    uint8_t reply[300];
+    uint16_t reply_len;
+    // user interaction requested by the last APDU
+    sim_pending_e pending;
+    // deepest stack use of the last call in bytes (0 if it cannot be measured)
+    uint32_t stack_used;
+} sim_result_t;
+
+/// Name of an instruction, NULL if the app does not support it
+const char *sim_ins_name(uint8_t ins);
+
+/// Paint the stack before every call to measure its use (slower)
+void sim_set_stack_measurement(bool enabled);
+
+/// Reset the app state (as after boot)
+void sim_init();
+
+/// Process one APDU like the app main loop does
+void sim_exchange(const uint8_t *apdu, uint16_t apdu_len, sim_result_t *result);
+
+/// Approve or reject the pending review, the reply is the asynchronous one
+void sim_resolve(bool approve, sim_result_t *result);
+
+/// Ticker events while the user reviews
+void sim_tick(uint32_t count);
+
+/// Bytes of the last transaction kept in RAM and in (emulated) flash
+void sim_tx_buffer_usage(uint32_t *ram_bytes, uint32_t *flash_bytes);
+
+/// Walk every page of the pending review, as the user would
+/// \return number of pages
+uint32_t sim_review_pages();
+
+#ifdef __cplusplus
+}
+#endif
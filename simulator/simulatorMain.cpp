@@ -0,0 +1,380 @@
+/*******************************************************************************
+*   (c) 2019 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "sim.h"
+
+///
+/// Replays APDU transcripts against the app handlers and reports latency and stack use.
+/// See simulator.md for the transcript format.
+///
+
+namespace {
+    const uint8_t CLA = 0x55;
+    const uint8_t INS_SIGN = 0x02;
+    const uint8_t SIGN_INIT = 0;
+    const uint8_t SIGN_ADD = 1;
+    const uint8_t SIGN_LAST = 2;
+    const uint32_t DEFAULT_PATH[5] = {0x8000002c, 0x800003a3, 0x80000000, 0, 0};
+
+    struct op_stats_t {
+        uint64_t count = 0;
+        uint64_t total_ns = 0;
+        uint64_t max_ns = 0;
+        uint32_t max_stack = 0;
+    };
+
+    struct options_t {
+        uint32_t repeat = 1;
+        uint32_t chunk = 250;
+        uint32_t ticks = 0;
+        bool review = false;
+        bool stack = false;
+        bool quiet = false;
+    };
+
+    std::map<std::string, op_stats_t> stats;
+    uint32_t max_ram_bytes = 0;
+    uint32_t max_flash_bytes = 0;
+    uint32_t failures = 0;
+
+    std::string to_hex(const uint8_t *data, size_t len) {
+        std::ostringstream out;
+        for (size_t i = 0; i < len; i++) {
+            out << std::hex << std::setw(2) << std::setfill('0') << (int) data[i];
+        }
+        return out.str();
+    }
+
+    bool from_hex(const std::string &hex, std::vector<uint8_t> *out) {
+        std::string digits;
+        for (char c : hex) {
+            if (!isspace(c)) {
+                digits += c;
+            }
+        }
+        if (digits.size() % 2 != 0) {
+            return false;
+        }
+        out->clear();
+        for (size_t i = 0; i < digits.size(); i += 2) {
+            if (!isxdigit(digits[i]) || !isxdigit(digits[i + 1])) {
+                return false;
+            }
+            out->push_back((uint8_t) std::stoul(digits.substr(i, 2), nullptr, 16));
+        }
+        return true;
+    }
+
+    std::string op_name(const std::vector<uint8_t> &apdu) {
+        if (apdu.size() < 4) {
+            return "invalid";
+        }
+        const char *name = sim_ins_name(apdu[1]);
+        std::string label = name != nullptr ? name : "INS_" + to_hex(&apdu[1], 1);
+        if (apdu[1] == INS_SIGN) {
+            label += "/" + std::to_string(apdu[2]);
+        }
+        return label;
+    }
+
+    template<typename F>
+    void measure(const std::string &op, F f, const uint32_t *stack_used) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const auto end = std::chrono::steady_clock::now();
+        const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        op_stats_t &s = stats[op];
+        s.count++;
+        s.total_ns += ns;
+        s.max_ns = std::max(s.max_ns, ns);
+        if (stack_used != nullptr) {
+            s.max_stack = std::max(s.max_stack, *stack_used);
+        }
+    }
+
+    void track_buffer_usage() {
+        uint32_t ram_bytes, flash_bytes;
+        sim_tx_buffer_usage(&ram_bytes, &flash_bytes);
+        max_ram_bytes = std::max(max_ram_bytes, ram_bytes);
+        max_flash_bytes = std::max(max_flash_bytes, flash_bytes);
+    }
+
+    // Expected replies can end with "..." to only check the beginning or start with it to
+    // only check the end (e.g. the status word)
+    bool reply_matches(const std::string &expected, const std::string &actual) {
+        const std::string ellipsis = "...";
+        if (expected.size() >= ellipsis.size() &&
+            expected.compare(expected.size() - ellipsis.size(), ellipsis.size(), ellipsis) == 0) {
+            const std::string prefix = expected.substr(0, expected.size() - ellipsis.size());
+            return actual.compare(0, prefix.size(), prefix) == 0;
+        }
+        if (expected.compare(0, ellipsis.size(), ellipsis) == 0) {
+            const std::string suffix = expected.substr(ellipsis.size());
+            return actual.size() >= suffix.size() &&
+                   actual.compare(actual.size() - suffix.size(), suffix.size(), suffix) == 0;
+        }
+        return expected == actual;
+    }
+
+    class session_t {
+     public:
+        explicit session_t(const options_t &options) : options_(options) {}
+
+        void exchange(const std::vector<uint8_t> &apdu) {
+            resolve_pending(true);
+
+            measure(
+                op_name(apdu),
+                [&]() { sim_exchange(apdu.data(), apdu.size(), &result_); },
+                &result_.stack_used);
+            track_buffer_usage();
+            pending_ = result_.pending;
+        }
+
+        void resolve_pending(bool approve) {
+            if (pending_ == sim_pending_none) {
+                return;
+            }
+            if (pending_ == sim_pending_sign && options_.review) {
+                measure("review", []() { sim_review_pages(); }, nullptr);
+            }
+            sim_tick(options_.ticks);
+            measure(
+                approve ? "approve" : "reject",
+                [&]() { sim_resolve(approve, &result_); },
+                &result_.stack_used);
+            pending_ = sim_pending_none;
+        }
+
+        void expect(const std::string &expected, const std::string &where) {
+            resolve_pending(true);
+
+            std::string wanted;
+            for (char c : expected) {
+                if (!isspace(c)) {
+                    wanted += (char) tolower(c);
+                }
+            }
+            const std::string actual = to_hex(result_.reply, result_.reply_len);
+            if (!reply_matches(wanted, actual)) {
+                failures++;
+                std::cerr << where << ": expected " << wanted << std::endl;
+                std::cerr << where << ":      got " << actual << std::endl;
+            }
+        }
+
+        void tick(uint32_t count) {
+            sim_tick(count);
+        }
+
+     private:
+        const options_t &options_;
+        sim_result_t result_{};
+        sim_pending_e pending_ = sim_pending_none;
+    };
+
+    bool run_transcript(const std::string &filename, const options_t &options) {
+        std::ifstream fin(filename);
+        if (!fin.is_open()) {
+            std::cerr << "cannot open " << filename << std::endl;
+            return false;
+        }
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(fin, line);) {
+            lines.push_back(line);
+        }
+
+        for (uint32_t r = 0; r < options.repeat; r++) {
+            sim_init();
+            session_t session(options);
+
+            for (size_t i = 0; i < lines.size(); i++) {
+                const std::string where = filename + ":" + std::to_string(i + 1);
+                std::istringstream line(lines[i]);
+                std::string cmd;
+                line >> cmd;
+                std::string rest;
+                std::getline(line, rest);
+
+                if (cmd.empty() || cmd[0] == '#') {
+                    continue;
+                }
+                if (cmd == "=>") {
+                    std::vector<uint8_t> apdu;
+                    if (!from_hex(rest, &apdu)) {
+                        std::cerr << where << ": invalid hex" << std::endl;
+                        return false;
+                    }
+                    session.exchange(apdu);
+                } else if (cmd == "<=") {
+                    session.expect(rest, where);
+                } else if (cmd == "approve" || cmd == "reject") {
+                    session.resolve_pending(cmd == "approve");
+                } else if (cmd == "tick") {
+                    session.tick(std::stoul(rest));
+                } else {
+                    std::cerr << where << ": unknown command " << cmd << std::endl;
+                    return false;
+                }
+            }
+            session.resolve_pending(true);
+        }
+        return true;
+    }
+
+    std::vector<uint8_t> make_apdu(uint8_t p1, const uint8_t *data, size_t len) {
+        std::vector<uint8_t> apdu(5 + len);
+        apdu[0] = CLA;
+        apdu[1] = INS_SIGN;
+        apdu[2] = p1;
+        apdu[3] = 0;
+        apdu[4] = (uint8_t) len;
+        memcpy(apdu.data() + 5, data, len);
+        return apdu;
+    }
+
+    // Sign flow for a transaction split in chunks of the given size
+    bool run_tx(const std::string &filename, const options_t &options) {
+        std::ifstream fin(filename);
+        if (!fin.is_open()) {
+            std::cerr << "cannot open " << filename << std::endl;
+            return false;
+        }
+        std::string tx((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+        while (!tx.empty() && isspace(tx.back())) {
+            tx.pop_back();
+        }
+        if (options.chunk == 0 || options.chunk > 255) {
+            std::cerr << "chunk size must be between 1 and 255" << std::endl;
+            return false;
+        }
+
+        uint8_t path[sizeof(DEFAULT_PATH)];
+        memcpy(path, DEFAULT_PATH, sizeof(path));
+
+        for (uint32_t r = 0; r < options.repeat; r++) {
+            sim_init();
+            session_t session(options);
+
+            session.exchange(make_apdu(SIGN_INIT, path, sizeof(path)));
+            for (size_t pos = 0; pos < tx.size(); pos += options.chunk) {
+                const size_t len = std::min<size_t>(options.chunk, tx.size() - pos);
+                const uint8_t p1 = pos + len < tx.size() ? SIGN_ADD : SIGN_LAST;
+                session.exchange(make_apdu(p1, (const uint8_t *) tx.data() + pos, len));
+            }
+            session.expect("...9000", filename);
+        }
+        return true;
+    }
+
+    void print_stats() {
+        std::cout << std::left << std::setw(24) << "operation" << std::right << std::setw(8)
+                  << "count" << std::setw(12) << "avg [us]" << std::setw(12) << "max [us]"
+                  << std::setw(12) << "stack [B]" << std::endl;
+        for (const auto &entry : stats) {
+            const op_stats_t &s = entry.second;
+            std::cout << std::left << std::setw(24) << entry.first << std::right << std::setw(8)
+                      << s.count << std::setw(12) << std::fixed << std::setprecision(1)
+                      << s.total_ns / 1000.0 / s.count << std::setw(12) << s.max_ns / 1000.0
+                      << std::setw(12);
+            if (s.max_stack > 0) {
+                std::cout << s.max_stack;
+            } else {
+                std::cout << "-";
+            }
+            std::cout << std::endl;
+        }
+        std::cout << "tx buffer: " << max_ram_bytes << " bytes in RAM, " << max_flash_bytes
+                  << " bytes in flash" << std::endl;
+    }
+
+    void usage() {
+        std::cerr << "usage: simulator [options] transcript..." << std::endl
+                  << "       simulator [options] --tx file.json" << std::endl
+                  << "  --repeat N   run every transcript N times" << std::endl
+                  << "  --chunk N    chunk size for --tx (default 250)" << std::endl
+                  << "  --ticks N    ticker events before each approval" << std::endl
+                  << "  --review     walk all review pages before each approval" << std::endl
+                  << "  --stack      measure the stack use (not with ASan)" << std::endl
+                  << "  --quiet      do not print the statistics" << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    options_t options;
+    std::vector<std::string> transcripts;
+    std::vector<std::string> txs;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--repeat" && has_value) {
+            options.repeat = std::stoul(argv[++i]);
+        } else if (arg == "--chunk" && has_value) {
+            options.chunk = std::stoul(argv[++i]);
+        } else if (arg == "--ticks" && has_value) {
+            options.ticks = std::stoul(argv[++i]);
+        } else if (arg == "--tx" && has_value) {
+            txs.emplace_back(argv[++i]);
+        } else if (arg == "--review") {
+            options.review = true;
+        } else if (arg == "--stack") {
+            options.stack = true;
+        } else if (arg == "--quiet") {
+            options.quiet = true;
+        } else if (!arg.empty() && arg[0] != '-') {
+            transcripts.push_back(arg);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (transcripts.empty() && txs.empty()) {
+        usage();
+        return 2;
+    }
+
+    sim_set_stack_measurement(options.stack);
+
+    for (const auto &transcript : transcripts) {
+        if (!run_transcript(transcript, options)) {
+            return 2;
+        }
+    }
+    for (const auto &tx : txs) {
+        if (!run_tx(tx, options)) {
+            return 2;
+        }
+    }
+
+    if (!options.quiet) {
+        print_stats();
+    }
+    if (failures > 0) {
+        std::cerr << failures << " unexpected replies" << std::endl;
+        return 1;
+    }
+    return 0;
+}
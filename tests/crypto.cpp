@@ -0,0 +1,255 @@
+/*******************************************************************************
+*   (c) 2018 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+
+#include "gtest/gtest.h"
+#include <crypto.h>
+#include <host/bip32.h>
+#include <host/ripemd160.h>
+#include <host/secp256k1.h>
+#include <host/sha2.h>
+#include <cstring>
+#include <string>
+
+namespace {
+    std::string to_hex(const uint8_t *data, size_t len) {
+        static const char digits[] = "0123456789abcdef";
+        std::string out;
+        for (size_t i = 0; i < len; i++) {
+            out += digits[data[i] >> 4];
+            out += digits[data[i] & 0x0F];
+        }
+        return out;
+    }
+
+    std::string from_hex(const std::string &hex) {
+        std::string out;
+        for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+            out += (char) std::stoul(hex.substr(i, 2), nullptr, 16);
+        }
+        return out;
+    }
+
+    const uint8_t *bytes(const std::string &s) {
+        return reinterpret_cast<const uint8_t *>(s.data());
+    }
+
+    void set_default_path() {
+        hdPath[0] = HDPATH_0_DEFAULT;
+        hdPath[1] = HDPATH_1_DEFAULT;
+        hdPath[2] = HDPATH_2_DEFAULT;
+        hdPath[3] = HDPATH_3_DEFAULT;
+        hdPath[4] = HDPATH_4_DEFAULT;
+    }
+
+    TEST(CryptoHost, Hashes) {
+        const std::string abc = "abc";
+        uint8_t out[SW_SHA512_SIZE];
+
+        sw_sha256(bytes(abc), abc.size(), out);
+        EXPECT_EQ(to_hex(out, SW_SHA256_SIZE),
+                  "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+        sw_sha512(bytes(abc), abc.size(), out);
+        EXPECT_EQ(to_hex(out, SW_SHA512_SIZE),
+                  "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+                  "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f");
+
+        sw_ripemd160(bytes(abc), abc.size(), out);
+        EXPECT_EQ(to_hex(out, SW_RIPEMD160_SIZE), "8eb208f7e05d987a9b044a8e98c6b087f15a0bfc");
+
+        // Incremental updates across block boundaries
+        const std::string a(1000, 'a');
+        sw_sha256_t ctx;
+        sw_sha256_init(&ctx);
+        for (size_t i = 0; i < a.size(); i += 7) {
+            sw_sha256_update(&ctx, bytes(a) + i, std::min<size_t>(7, a.size() - i));
+        }
+        sw_sha256_final(&ctx, out);
+        uint8_t expected[SW_SHA256_SIZE];
+        sw_sha256(bytes(a), a.size(), expected);
+        EXPECT_EQ(to_hex(out, SW_SHA256_SIZE), to_hex(expected, SW_SHA256_SIZE));
+    }
+
+    TEST(CryptoHost, Hmac) {
+        // RFC 4231 test case 2
+        const std::string key = "Jefe";
+        const std::string data = "what do ya want for nothing?";
+        uint8_t out[SW_SHA512_SIZE];
+
+        sw_hmac_sha256(bytes(key), key.size(), bytes(data), data.size(), out);
+        EXPECT_EQ(to_hex(out, SW_SHA256_SIZE),
+                  "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+
+        sw_hmac_sha512(bytes(key), key.size(), bytes(data), data.size(), out);
+        EXPECT_EQ(to_hex(out, SW_SHA512_SIZE),
+                  "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea250554"
+                  "9758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737");
+    }
+
+    TEST(CryptoHost, Bip32) {
+        // BIP32 test vector 1
+        const std::string seed = from_hex("000102030405060708090a0b0c0d0e0f");
+        sw_bip32_node_t master;
+        ASSERT_TRUE(sw_bip32_master(bytes(seed), seed.size(), &master));
+        EXPECT_EQ(to_hex(master.privateKey, 32),
+                  "e8f32e723decf4051aefac8e2c93c9c5b214313817cdb01a1494b917c8436b35");
+        EXPECT_EQ(to_hex(master.chainCode, 32),
+                  "873dff81c02f525623fd1fe5167eac3a55a049de3d314bb42ee227ffed37d508");
+
+        uint8_t publicKey[SW_SECP256K1_POINT_SIZE];
+        ASSERT_TRUE(sw_secp256k1_pubkey_create(master.privateKey, publicKey));
+        EXPECT_EQ(to_hex(publicKey + 1, 32),
+                  "39a36013301597daef41fbe593a02cc513d0b55527ec2df1050e2e8ff49c85c2");
+
+        // m/0H
+        sw_bip32_node_t child;
+        ASSERT_TRUE(sw_bip32_ckd_priv(&master, SW_BIP32_HARDENED, &child));
+        EXPECT_EQ(to_hex(child.privateKey, 32),
+                  "edb2e14f9ee77d26dd93b4ecede8d16ed408ce149b6cd80b0715a2d911a0afea");
+
+        // Public derivation of a normal child matches the private one
+        uint8_t childPublicKey[SW_SECP256K1_POINT_SIZE];
+        uint8_t expected[SW_SECP256K1_POINT_SIZE];
+        ASSERT_TRUE(sw_bip32_ckd_priv(&master, 1, &child));
+        ASSERT_TRUE(sw_secp256k1_pubkey_create(child.privateKey, expected));
+        ASSERT_TRUE(sw_bip32_ckd_pub(publicKey, master.chainCode, 1, childPublicKey));
+        EXPECT_EQ(to_hex(childPublicKey, sizeof(childPublicKey)), to_hex(expected, sizeof(expected)));
+        EXPECT_FALSE(sw_bip32_ckd_pub(publicKey, master.chainCode, SW_BIP32_HARDENED, childPublicKey));
+    }
+
+    TEST(CryptoHost, CkdPub) {
+        // BIP32 test vector 1, m/0H -> m/0H/1
+        const std::string seed = from_hex("000102030405060708090a0b0c0d0e0f");
+        sw_bip32_node_t master;
+        sw_bip32_node_t parent;
+        ASSERT_TRUE(sw_bip32_master(bytes(seed), seed.size(), &master));
+        ASSERT_TRUE(sw_bip32_ckd_priv(&master, SW_BIP32_HARDENED, &parent));
+        EXPECT_EQ(to_hex(parent.chainCode, 32),
+                  "47fdacbd0f1097043b78c63c20c34ef4ed9a111d980047ad16282c7ae6236141");
+
+        uint8_t publicKey[SW_SECP256K1_POINT_SIZE];
+        ASSERT_TRUE(sw_secp256k1_pubkey_create(parent.privateKey, publicKey));
+
+        uint8_t child[PK_LEN_SECP256K1];
+        ASSERT_TRUE(crypto_ckd_pub(publicKey, parent.chainCode, 1, child));
+        EXPECT_EQ(to_hex(child, sizeof(child)),
+                  "03501e454bf00751f24b1b489aa925215d66af2234e3891c3b21a52bedb3cd711c");
+
+        EXPECT_FALSE(crypto_ckd_pub(publicKey, parent.chainCode, SW_BIP32_HARDENED, child));
+        EXPECT_EQ(to_hex(child, sizeof(child)), std::string(2 * PK_LEN_SECP256K1, '0'));
+    }
+
+    TEST(CryptoHost, SignRfc6979) {
+        // Private key 1, "Satoshi Nakamoto": r is the well known vector, s is not normalized
+        uint8_t privateKey[32] = {0};
+        privateKey[31] = 1;
+        const std::string message = "Satoshi Nakamoto";
+        uint8_t digest[SW_SHA256_SIZE];
+        sw_sha256(bytes(message), message.size(), digest);
+
+        uint8_t r[32], s[32];
+        ASSERT_TRUE(sw_secp256k1_sign(privateKey, digest, r, s));
+        EXPECT_EQ(to_hex(r, 32), "934b1ea10a4b3c1757e2b0c017d0b6143ce3c9a7e6a4a49860d7a6ab210ee3d8");
+        EXPECT_EQ(to_hex(s, 32), "dbbd3162d46e9f9bef7feb87c16dc13b4f6568a87f4e83f728e2443ba586675c");
+
+        uint8_t publicKey[SW_SECP256K1_POINT_SIZE];
+        ASSERT_TRUE(sw_secp256k1_pubkey_create(privateKey, publicKey));
+        EXPECT_TRUE(sw_secp256k1_verify(publicKey, digest, r, s));
+        digest[0] ^= 1;
+        EXPECT_FALSE(sw_secp256k1_verify(publicKey, digest, r, s));
+
+        uint8_t der[SW_SECP256K1_DER_MAX_SIZE];
+        const uint16_t der_len = sw_secp256k1_der_encode(r, s, der, sizeof(der));
+        // Both integers have the high bit set and need a leading zero
+        ASSERT_EQ(der_len, SW_SECP256K1_DER_MAX_SIZE);
+        EXPECT_EQ(to_hex(der, 5), "3046022100");
+        EXPECT_EQ(to_hex(der + 37, 3), "022100");
+        EXPECT_EQ(sw_secp256k1_der_encode(r, s, der, der_len - 1), 0);
+    }
+
+    TEST(CryptoHost, Address) {
+        crypto_host_set_mnemonic(CRYPTO_HOST_DEFAULT_MNEMONIC);
+        crypto_set_hrp((char *) "thor");
+        set_default_path();
+
+        uint8_t buffer[200];
+        const uint16_t len = crypto_fillAddress(buffer, sizeof(buffer));
+        ASSERT_EQ(len, PK_LEN_SECP256K1 + 43);
+        EXPECT_EQ(to_hex(buffer, PK_LEN_SECP256K1),
+                  "0264bff60f78aae3326b4fc3e16a7c48d0158bfe175fa4a9361190a42565662ae6");
+        EXPECT_STREQ((const char *) buffer + PK_LEN_SECP256K1,
+                     "thor1mwyrp6lj85swy5e5g4hjlaacm33g6rw3p4qmq4");
+    }
+
+    TEST(CryptoHost, AddressBatch) {
+        crypto_host_set_mnemonic(CRYPTO_HOST_DEFAULT_MNEMONIC);
+        crypto_set_hrp((char *) "thor");
+        set_default_path();
+
+        uint8_t batch[250];
+        const uint16_t batch_len = crypto_fillAddressBatch(batch, sizeof(batch), hdPath, 0, 3);
+        ASSERT_EQ(batch[0], 3);
+        ASSERT_EQ(batch_len, 1 + 3 * (PK_LEN_SECP256K1 + 1 + 43));
+
+        // Every entry matches a full derivation of the same path
+        uint16_t pos = 1;
+        for (uint32_t i = 0; i < 3; i++) {
+            hdPath[HDPATH_LEN_DEFAULT - 1] = i;
+            uint8_t single[200];
+            crypto_fillAddress(single, sizeof(single));
+
+            EXPECT_EQ(to_hex(batch + pos, PK_LEN_SECP256K1), to_hex(single, PK_LEN_SECP256K1));
+            pos += PK_LEN_SECP256K1;
+            const uint8_t addr_len = batch[pos++];
+            EXPECT_EQ(std::string((const char *) batch + pos, addr_len),
+                      std::string((const char *) single + PK_LEN_SECP256K1));
+            pos += addr_len;
+        }
+    }
+
+    TEST(CryptoHost, Sign) {
+        crypto_host_set_mnemonic(CRYPTO_HOST_DEFAULT_MNEMONIC);
+        set_default_path();
+
+        const std::string tx = R"({"account_number":"0"})";
+        uint8_t digest[CRYPTO_DIGEST_LEN];
+        sw_sha256(bytes(tx), tx.size(), digest);
+
+        uint8_t signature[SW_SECP256K1_DER_MAX_SIZE];
+        EXPECT_EQ(crypto_sign(signature, sizeof(signature), digest, CRYPTO_DIGEST_LEN - 1), 0);
+
+        // Signing with the staged key never derives it
+        crypto_clear_signing_key();
+        EXPECT_EQ(crypto_sign_with_staged_key(signature, sizeof(signature), digest, sizeof(digest)),
+                  0);
+
+        crypto_stage_signing_key(hdPath);
+        EXPECT_TRUE(crypto_signing_key_staged(hdPath));
+        const uint16_t len = crypto_sign(signature, sizeof(signature), digest, sizeof(digest));
+        EXPECT_FALSE(crypto_signing_key_staged(hdPath));
+        ASSERT_EQ(len, 71);
+        EXPECT_EQ(to_hex(signature, len),
+                  "3045"
+                  "022011041f2a57fd7c5fc90b4b320fffd9a3d6941af949637eadcc988a4bfede01f3"
+                  "022100ff91eb88a359b65887a8f8cb3721604da9d825d0b3d5e9e8b3a5294fa8762584");
+
+        // Deterministic, also when the key is derived on demand
+        uint8_t again[SW_SECP256K1_DER_MAX_SIZE];
+        ASSERT_EQ(crypto_sign(again, sizeof(again), digest, sizeof(digest)), len);
+        EXPECT_EQ(to_hex(again, len), to_hex(signature, len));
+    }
+}
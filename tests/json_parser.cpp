@@ -20,6 +20,31 @@
 #include <json/json_parser.h>
 
 namespace {
+    // Token arena sized at runtime
+    struct VectorArena {
+        explicit VectorArena(uint16_t capacity)
+            : tokens(capacity), ascii(JSON_TOKEN_ASCII_BYTES(capacity)), type(capacity),
+              start(capacity), end(capacity), skip(capacity) {
+            arena.capacity = capacity;
+            arena.tokens = tokens.data();
+            arena.ascii = ascii.data();
+#if defined(JSON_SOA_TOKENS)
+            arena.type = type.data();
+            arena.start = start.data();
+            arena.end = end.data();
+            arena.skip = skip.data();
+#endif
+        }
+
+        std::vector<jsmntok_t> tokens;
+        std::vector<uint8_t> ascii;
+        std::vector<uint8_t> type;
+        std::vector<jsmnint_t> start;
+        std::vector<jsmnint_t> end;
+        std::vector<uint16_t> skip;
+        json_token_arena_t arena{};
+    };
+
     TEST(JsonParserTest, Empty) {
         parsed_json_t parserData = {false};
         JSON_PARSE(&parserData, "");
@@ -34,7 +59,7 @@ namespace {
 
         EXPECT_TRUE(parserData.isValid);
         EXPECT_EQ(1, parserData.numberOfTokens);
-        EXPECT_TRUE(parserData.tokens[0].type == jsmntype_t::JSMN_PRIMITIVE);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 0) == jsmntype_t::JSMN_PRIMITIVE);
     }
 
     TEST(JsonParserTest, KeyValuePrimitives) {
@@ -43,8 +68,8 @@ namespace {
 
         EXPECT_TRUE(parserData.isValid);
         EXPECT_EQ(2, parserData.numberOfTokens);
-        EXPECT_TRUE(parserData.tokens[0].type == jsmntype_t::JSMN_PRIMITIVE);
-        EXPECT_TRUE(parserData.tokens[1].type == jsmntype_t::JSMN_PRIMITIVE);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 0) == jsmntype_t::JSMN_PRIMITIVE);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 1) == jsmntype_t::JSMN_PRIMITIVE);
     }
 
     TEST(JsonParserTest, SingleString) {
@@ -53,7 +78,7 @@ namespace {
 
         EXPECT_TRUE(parserData.isValid);
         EXPECT_EQ(1, parserData.numberOfTokens);
-        EXPECT_TRUE(parserData.tokens[0].type == jsmntype_t::JSMN_STRING);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 0) == jsmntype_t::JSMN_STRING);
     }
 
     TEST(JsonParserTest, KeyValueStrings) {
@@ -62,8 +87,8 @@ namespace {
 
         EXPECT_TRUE(parserData.isValid);
         EXPECT_EQ(2, parserData.numberOfTokens);
-        EXPECT_TRUE(parserData.tokens[0].type == jsmntype_t::JSMN_STRING);
-        EXPECT_TRUE(parserData.tokens[1].type == jsmntype_t::JSMN_STRING);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 0) == jsmntype_t::JSMN_STRING);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 1) == jsmntype_t::JSMN_STRING);
     }
 
     TEST(JsonParserTest, SimpleArray) {
@@ -72,12 +97,12 @@ namespace {
 
         EXPECT_TRUE(parserData.isValid);
         EXPECT_EQ(6, parserData.numberOfTokens);
-        EXPECT_TRUE(parserData.tokens[0].type == jsmntype_t::JSMN_PRIMITIVE);
-        EXPECT_TRUE(parserData.tokens[1].type == jsmntype_t::JSMN_ARRAY);
-        EXPECT_TRUE(parserData.tokens[2].type == jsmntype_t::JSMN_PRIMITIVE);
-        EXPECT_TRUE(parserData.tokens[3].type == jsmntype_t::JSMN_PRIMITIVE);
-        EXPECT_TRUE(parserData.tokens[4].type == jsmntype_t::JSMN_PRIMITIVE);
-        EXPECT_TRUE(parserData.tokens[5].type == jsmntype_t::JSMN_PRIMITIVE);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 0) == jsmntype_t::JSMN_PRIMITIVE);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 1) == jsmntype_t::JSMN_ARRAY);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 2) == jsmntype_t::JSMN_PRIMITIVE);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 3) == jsmntype_t::JSMN_PRIMITIVE);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 4) == jsmntype_t::JSMN_PRIMITIVE);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 5) == jsmntype_t::JSMN_PRIMITIVE);
     }
 
     TEST(JsonParserTest, MixedArray) {
@@ -86,12 +111,12 @@ namespace {
 
         EXPECT_TRUE(parserData.isValid);
         EXPECT_EQ(6, parserData.numberOfTokens);
-        EXPECT_TRUE(parserData.tokens[0].type == jsmntype_t::JSMN_PRIMITIVE);
-        EXPECT_TRUE(parserData.tokens[1].type == jsmntype_t::JSMN_ARRAY);
-        EXPECT_TRUE(parserData.tokens[2].type == jsmntype_t::JSMN_PRIMITIVE);
-        EXPECT_TRUE(parserData.tokens[3].type == jsmntype_t::JSMN_STRING);
-        EXPECT_TRUE(parserData.tokens[4].type == jsmntype_t::JSMN_PRIMITIVE);
-        EXPECT_TRUE(parserData.tokens[5].type == jsmntype_t::JSMN_STRING);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 0) == jsmntype_t::JSMN_PRIMITIVE);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 1) == jsmntype_t::JSMN_ARRAY);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 2) == jsmntype_t::JSMN_PRIMITIVE);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 3) == jsmntype_t::JSMN_STRING);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 4) == jsmntype_t::JSMN_PRIMITIVE);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 5) == jsmntype_t::JSMN_STRING);
     }
 
     TEST(JsonParserTest, SimpleObject) {
@@ -106,16 +131,16 @@ namespace {
 
         EXPECT_TRUE(parserData.isValid);
         EXPECT_EQ(10, parserData.numberOfTokens);
-        EXPECT_TRUE(parserData.tokens[0].type == jsmntype_t::JSMN_PRIMITIVE);
-        EXPECT_TRUE(parserData.tokens[1].type == jsmntype_t::JSMN_OBJECT);
-        EXPECT_TRUE(parserData.tokens[2].type == jsmntype_t::JSMN_STRING);
-        EXPECT_TRUE(parserData.tokens[3].type == jsmntype_t::JSMN_STRING);
-        EXPECT_TRUE(parserData.tokens[4].type == jsmntype_t::JSMN_STRING);
-        EXPECT_TRUE(parserData.tokens[5].type == jsmntype_t::JSMN_OBJECT);
-        EXPECT_TRUE(parserData.tokens[6].type == jsmntype_t::JSMN_STRING);
-        EXPECT_TRUE(parserData.tokens[7].type == jsmntype_t::JSMN_STRING);
-        EXPECT_TRUE(parserData.tokens[8].type == jsmntype_t::JSMN_STRING);
-        EXPECT_TRUE(parserData.tokens[9].type == jsmntype_t::JSMN_PRIMITIVE);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 0) == jsmntype_t::JSMN_PRIMITIVE);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 1) == jsmntype_t::JSMN_OBJECT);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 2) == jsmntype_t::JSMN_STRING);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 3) == jsmntype_t::JSMN_STRING);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 4) == jsmntype_t::JSMN_STRING);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 5) == jsmntype_t::JSMN_OBJECT);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 6) == jsmntype_t::JSMN_STRING);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 7) == jsmntype_t::JSMN_STRING);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 8) == jsmntype_t::JSMN_STRING);
+        EXPECT_TRUE(JSON_TOKEN_TYPE(&parserData, 9) == jsmntype_t::JSMN_PRIMITIVE);
     }
 
     TEST(JsonParserTest, ArrayElementCount_objects) {
@@ -172,7 +197,7 @@ namespace {
         uint16_t token_index;
         EXPECT_EQ(array_get_nth_element(&parsed_json, 2, 1, &token_index), parser_ok);
         EXPECT_EQ(token_index, 8) << "Wrong token index returned";
-        EXPECT_EQ(parsed_json.tokens[token_index].type, JSMN_OBJECT) << "Wrong token type returned";
+        EXPECT_EQ(JSON_TOKEN_TYPE(&parsed_json, token_index), JSMN_OBJECT) << "Wrong token type returned";
     }
 
     TEST(JsonParserTest, ArrayElementGet_primitives) {
@@ -184,7 +209,7 @@ namespace {
         uint16_t token_index;
         EXPECT_EQ(array_get_nth_element(&parsed_json, 2, 5, &token_index), parser_ok);
         EXPECT_EQ(token_index, 8) << "Wrong token index returned";
-        EXPECT_EQ(parsed_json.tokens[token_index].type, JSMN_PRIMITIVE) << "Wrong token type returned";
+        EXPECT_EQ(JSON_TOKEN_TYPE(&parsed_json, token_index), JSMN_PRIMITIVE) << "Wrong token type returned";
     }
 
     TEST(TxValidationTest, ArrayElementGet_strings) {
@@ -196,7 +221,7 @@ namespace {
         uint16_t token_index;
         EXPECT_EQ(array_get_nth_element(&parsed_json, 2, 0, &token_index), parser_ok);
         EXPECT_EQ(token_index, 3) << "Wrong token index returned";
-        EXPECT_EQ(parsed_json.tokens[token_index].type, JSMN_STRING) << "Wrong token type returned";
+        EXPECT_EQ(JSON_TOKEN_TYPE(&parsed_json, token_index), JSMN_STRING) << "Wrong token type returned";
     }
 
     TEST(TxValidationTest, ArrayElementGet_empty) {
@@ -303,8 +328,8 @@ namespace {
         uint16_t token_index;
         EXPECT_EQ(object_get_nth_key(&parsed_json, 0, 0, &token_index), parser_ok);
         EXPECT_EQ(token_index, 1) << "Wrong token index";
-        EXPECT_EQ(parsed_json.tokens[token_index].type, JSMN_STRING) << "Wrong token type returned";
-        EXPECT_EQ(memcmp(transaction + parsed_json.tokens[token_index].start, "age", strlen("age")), 0)
+        EXPECT_EQ(JSON_TOKEN_TYPE(&parsed_json, token_index), JSMN_STRING) << "Wrong token type returned";
+        EXPECT_EQ(memcmp(transaction + JSON_TOKEN_START(&parsed_json, token_index), "age", strlen("age")), 0)
                             << "Wrong key returned";
     }
 
@@ -317,8 +342,8 @@ namespace {
         uint16_t token_index;
         EXPECT_EQ(object_get_nth_value(&parsed_json, 0, 3, &token_index), parser_ok);
         EXPECT_EQ(token_index, 8) << "Wrong token index";
-        EXPECT_EQ(parsed_json.tokens[token_index].type, JSMN_STRING) << "Wrong token type returned";
-        EXPECT_EQ(memcmp(transaction + parsed_json.tokens[token_index].start, "july", strlen("july")), 0)
+        EXPECT_EQ(JSON_TOKEN_TYPE(&parsed_json, token_index), JSMN_STRING) << "Wrong token type returned";
+        EXPECT_EQ(memcmp(transaction + JSON_TOKEN_START(&parsed_json, token_index), "july", strlen("july")), 0)
                             << "Wrong key returned";
     }
 
@@ -357,7 +382,7 @@ namespace {
         EXPECT_EQ(object_get_value(&parsed_json, 0, "years", &token_index), parser_ok);
 
         EXPECT_EQ(token_index, 14) << "Wrong token index";
-        EXPECT_EQ(parsed_json.tokens[token_index].type, JSMN_ARRAY) << "Wrong token type returned";
+        EXPECT_EQ(JSON_TOKEN_TYPE(&parsed_json, token_index), JSMN_ARRAY) << "Wrong token type returned";
         uint16_t number_elements;
         EXPECT_EQ(array_get_element_count(&parsed_json, token_index, &number_elements), parser_ok);
         EXPECT_EQ(number_elements, 5) << "Wrong number of array elements";
@@ -388,4 +413,258 @@ namespace {
         EXPECT_EQ(object_get_value(&parsed_json, 0, "sequence", &token_index), parser_ok);
         EXPECT_EQ(token_index, 34) << "Wrong token index";
     }
+
+    TEST(JsonParserTest, SkipToken) {
+        auto transaction = R"({"a":{"b":[1,2,{"c":3}]},"d":"e"})";
+        parsed_json_t parsed_json;
+        JSON_PARSE(&parsed_json, transaction);
+
+        // Skipping the value of "a" lands on the key "d"
+        EXPECT_EQ(json_skip_token(&parsed_json, 2), 10);
+        EXPECT_EQ(json_skip_token(&parsed_json, 10), 11);
+        EXPECT_EQ(json_skip_token(&parsed_json, 11), parsed_json.numberOfTokens);
+        EXPECT_EQ(json_skip_token(&parsed_json, 0), parsed_json.numberOfTokens);
+        EXPECT_EQ(json_skip_token(&parsed_json, 100), parsed_json.numberOfTokens);
+    }
+
+    TEST(JsonParserTest, Projection) {
+        auto transaction =
+                R"({"chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","asset":"THOR.RUNE"},{"amount":"5","asset":"BTC/BTC"}],"to_address":"tthor10x"}},{"type":"thorchain/MsgDeposit","value":{"signer":"tthor1c6"}}],"sequence":"5"})";
+        parsed_json_t parsed_json;
+        JSON_PARSE(&parsed_json, transaction);
+
+        const char *paths[] = {
+                "chain_id",
+                "msgs/*/value/to_address",
+                "msgs/*/value/amount/*/amount",
+                "msgs/0/value/amount/1/asset",
+                "fee/gas",
+                "missing/key",
+        };
+        json_projection_t projection;
+        ASSERT_EQ(json_projection_compile(&projection, paths, 6), parser_ok);
+
+        json_projection_match_t matches[10];
+        uint16_t num_matches = 0;
+        ASSERT_EQ(json_projection_resolve(&parsed_json, &projection, matches, 10, &num_matches), parser_ok);
+
+        std::vector<std::string> values;
+        for (uint16_t i = 0; i < num_matches; i++) {
+            const uint16_t token_index = matches[i].token_index;
+            values.push_back(std::to_string(matches[i].path_index) + ":" +
+                             std::string(transaction + JSON_TOKEN_START(&parsed_json, token_index),
+                                         JSON_TOKEN_LEN(&parsed_json, token_index)));
+        }
+
+        // Matches are in document order
+        std::vector<std::string> expected = {"0:thorchain", "4:2000000", "2:150000000", "2:5", "3:BTC/BTC", "1:tthor10x"};
+        EXPECT_EQ(values, expected);
+
+        // Result table too small
+        EXPECT_EQ(json_projection_resolve(&parsed_json, &projection, matches, 3, &num_matches),
+                  parser_unexpected_buffer_end);
+        EXPECT_EQ(num_matches, 3);
+    }
+
+    TEST(JsonParserTest, ProjectionCompile) {
+        json_projection_t projection;
+
+        const char *empty_segment[] = {"msgs//value"};
+        EXPECT_EQ(json_projection_compile(&projection, empty_segment, 1), parser_value_out_of_range);
+
+        const char *too_deep[] = {"a/b/c/d/e/f/g/h/i"};
+        EXPECT_EQ(json_projection_compile(&projection, too_deep, 1), parser_value_out_of_range);
+
+        const char *ok[] = {"msgs/12/value"};
+        ASSERT_EQ(json_projection_compile(&projection, ok, 1), parser_ok);
+        EXPECT_EQ(projection.paths[0].num_segments, 3);
+        EXPECT_EQ(projection.paths[0].segments[0].index, JSON_PROJECTION_NO_INDEX);
+        EXPECT_EQ(projection.paths[0].segments[1].index, 12);
+    }
+
+    TEST(JsonParserTest, LargeInput) {
+        // Offsets past 32 KB need the wide token build
+        const std::string memo(40000, 'a');
+        const std::string transaction = R"({"memo":")" + memo + R"(","sequence":"5"})";
+
+        parsed_json_t parsed_json = {false};
+        ASSERT_EQ(JSON_PARSE(&parsed_json, transaction.c_str()), parser_ok);
+        EXPECT_EQ(parsed_json.bufferLen, transaction.size());
+        EXPECT_EQ(JSON_TOKEN_END(&parsed_json, 2) - JSON_TOKEN_START(&parsed_json, 2), memo.size());
+
+        uint16_t token_index = 0;
+        ASSERT_EQ(object_get_value(&parsed_json, ROOT_TOKEN_INDEX, "sequence", &token_index),
+                  parser_ok);
+        EXPECT_EQ(token_index, 4);
+        EXPECT_GT(JSON_TOKEN_START(&parsed_json, token_index), INT16_MAX);
+        EXPECT_EQ(transaction[JSON_TOKEN_START(&parsed_json, token_index)], '5');
+    }
+
+    TEST(JsonParserTest, TokenTooLong) {
+        const std::string memo(JSON_MAX_TOKEN_LEN + 1, 'a');
+        const std::string transaction = R"({"memo":")" + memo + R"("})";
+
+        parsed_json_t parsed_json = {false};
+        EXPECT_EQ(JSON_PARSE(&parsed_json, transaction.c_str()), parser_value_out_of_range);
+        EXPECT_FALSE(parsed_json.isValid);
+    }
+
+    TEST(JsonParserTest, CountTokens) {
+        auto transaction = R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"1","denom":"rune"}],"from_address":"a","to_address":"b"}}],"sequence":"5"})";
+
+        uint16_t num_tokens = 0;
+        ASSERT_EQ(json_count_tokens(transaction, strlen(transaction), &num_tokens), parser_ok);
+
+        parsed_json_t parsed_json = {false};
+        ASSERT_EQ(JSON_PARSE(&parsed_json, transaction), parser_ok);
+        EXPECT_EQ(num_tokens, parsed_json.numberOfTokens);
+
+        // An arena of exactly the counted size is enough
+        VectorArena arena(num_tokens);
+        EXPECT_EQ(json_parse(&parsed_json, &arena.arena, transaction, strlen(transaction)), parser_ok);
+        EXPECT_EQ(parsed_json.maxTokens, num_tokens);
+
+        VectorArena smaller_arena(num_tokens - 1);
+        EXPECT_EQ(json_parse(&parsed_json, &smaller_arena.arena, transaction, strlen(transaction)),
+                  parser_json_too_many_tokens);
+
+        EXPECT_EQ(json_count_tokens("", 0, &num_tokens), parser_json_zero_tokens);
+        EXPECT_EQ(json_count_tokens(R"({"a":"b)", 7, &num_tokens), parser_json_incomplete_json);
+    }
+
+    TEST(JsonParserTest, SmallArena) {
+        // Same limit as the Nano S build
+        const std::string msg = R"({"type":"thorchain/MsgSend","value":{"amount":[{"amount":"1","denom":"rune"}],"from_address":"a","to_address":"b"}})";
+        std::string transaction = R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"","msgs":[)";
+        for (int i = 0; i < 8; i++) {
+            transaction += (i > 0 ? "," : "") + msg;
+        }
+        transaction += R"(],"sequence":"5"})";
+
+        VectorArena arena(128);
+        parsed_json_t parsed_json = {false};
+        EXPECT_EQ(json_parse(&parsed_json, &arena.arena, transaction.c_str(), transaction.size()),
+                  parser_json_too_many_tokens);
+        EXPECT_EQ(JSON_PARSE(&parsed_json, transaction.c_str()), parser_ok);
+        EXPECT_GT(parsed_json.numberOfTokens, 128);
+    }
+
+    TEST(JsonParserTest, FindCharClass) {
+        const std::string clean(100, 'a');
+        EXPECT_EQ(json_find_char_class(clean.c_str(), clean.size(), JSON_CHAR_SPACE), clean.size());
+
+        // Matches are found before, inside and after a 16 byte block
+        for (size_t pos : {0, 5, 16, 17, 63, 99}) {
+            std::string s = clean;
+            s[pos] = '\n';
+            EXPECT_EQ(json_find_char_class(s.c_str(), s.size(), JSON_CHAR_SPACE), pos);
+            s[pos] = 0x01;
+            EXPECT_EQ(json_find_char_class(s.c_str(), s.size(), JSON_CHAR_SPACE), s.size());
+            EXPECT_EQ(json_find_char_class(s.c_str(), s.size(), JSON_CHAR_CONTROL), pos);
+            s[pos] = ':';
+            EXPECT_EQ(json_find_char_class(s.c_str(), s.size(), JSON_CHAR_STRUCTURAL), pos);
+        }
+
+        // Bytes from 0x80 are not classified
+        const std::string utf8 = "\xc3\xa9\xe2\x82\xac\xff";
+        EXPECT_EQ(json_find_char_class(utf8.c_str(), utf8.size(),
+                                       JSON_CHAR_SPACE | JSON_CHAR_CONTROL | JSON_CHAR_STRUCTURAL),
+                  utf8.size());
+    }
+
+    TEST(JsonParserTest, ValidateString) {
+        auto validate = [](const std::string &s, bool *is_ascii) {
+            return json_validate_string(s.c_str(), s.size(), is_ascii);
+        };
+        bool is_ascii = false;
+
+        EXPECT_EQ(validate("", &is_ascii), parser_ok);
+        EXPECT_TRUE(is_ascii);
+        EXPECT_EQ(validate("plain text that spans more than one block", &is_ascii), parser_ok);
+        EXPECT_TRUE(is_ascii);
+
+        // Escapes and UTF-8 are valid, but not ASCII
+        for (const char *s : {R"(a\"b\\c\/d\b\f\n\r\t)", R"(é)", R"(😀)",
+                              "caf\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80",
+                              "0123456789abcdef0123456789abcdef\xc3\xa9"}) {
+            EXPECT_EQ(validate(s, &is_ascii), parser_ok) << s;
+            EXPECT_FALSE(is_ascii) << s;
+        }
+
+        for (const char *s : {R"(\x)", R"(\)", R"(\u12)", R"(\u12G4)", R"(\uDC00)", R"(\uD800)",
+                              R"(\uD800\n)", R"(\uD800A)"}) {
+            EXPECT_EQ(validate(s, &is_ascii), parser_json_invalid_escape) << s;
+        }
+
+        // Stray continuation, overlong, surrogate, above U+10FFFF, truncated
+        for (const char *s : {"\x80", "\xc0\xaf", "\xc3", "\xe0\x80\xaf", "\xed\xa0\x80",
+                              "\xf4\x90\x80\x80", "\xf5\x80\x80\x80", "\xe2\x82",
+                              "0123456789abcdef0123456789abcdef\xff"}) {
+            EXPECT_EQ(validate(s, &is_ascii), parser_json_invalid_utf8) << s;
+        }
+    }
+
+    TEST(JsonParserTest, AsciiTokens) {
+        auto transaction = R"({"a":"text","b":"café","c":12,"d":[]})";
+
+        parsed_json_t parsed_json = {false};
+        ASSERT_EQ(JSON_PARSE(&parsed_json, transaction), parser_ok);
+
+        uint16_t token_index;
+        ASSERT_EQ(object_get_value(&parsed_json, 0, "a", &token_index), parser_ok);
+        EXPECT_TRUE(JSON_TOKEN_IS_ASCII(&parsed_json, token_index));
+        EXPECT_TRUE(JSON_TOKEN_IS_ASCII(&parsed_json, token_index - 1));
+        ASSERT_EQ(object_get_value(&parsed_json, 0, "b", &token_index), parser_ok);
+        EXPECT_FALSE(JSON_TOKEN_IS_ASCII(&parsed_json, token_index));
+        ASSERT_EQ(object_get_value(&parsed_json, 0, "c", &token_index), parser_ok);
+        EXPECT_TRUE(JSON_TOKEN_IS_ASCII(&parsed_json, token_index));
+
+        EXPECT_EQ(JSON_PARSE(&parsed_json, "{\"a\":\"\xc3\x28\"}"), parser_json_invalid_utf8);
+        EXPECT_EQ(JSON_PARSE(&parsed_json, R"({"a":"\uDE00"})"), parser_json_invalid_escape);
+    }
+
+    TEST(JsonParserTest, Fingerprint) {
+        auto fingerprint = [](const char *transaction) {
+            parsed_json_t parsed_json = {false};
+            EXPECT_EQ(JSON_PARSE(&parsed_json, transaction), parser_ok) << transaction;
+            return parsed_json.fingerprint;
+        };
+
+        const uint64_t base = fingerprint(R"({"a":"text","b":[1,2],"c":{"d":true}})");
+        EXPECT_NE(base, 0u);
+
+        // Only values differ
+        EXPECT_EQ(fingerprint(R"({"a":"other text","b":[3,4],"c":{"d":false}})"), base);
+
+        // Keys, nesting and types are part of the shape
+        EXPECT_NE(fingerprint(R"({"x":"text","b":[1,2],"c":{"d":true}})"), base);
+        EXPECT_NE(fingerprint(R"({"a":"text","b":[1,2,3],"c":{"d":true}})"), base);
+        EXPECT_NE(fingerprint(R"({"a":"text","b":[1,[2]],"c":{"d":true}})"), base);
+        EXPECT_NE(fingerprint(R"({"a":1,"b":[1,2],"c":{"d":true}})"), base);
+        EXPECT_NE(fingerprint(R"({"a":"text","b":[1,2],"c":{"de":true}})"), base);
+    }
+
+    TEST(JsonParserTest, DecodeString) {
+        auto decode = [](const std::string &s, uint16_t out_len, std::string *out) {
+            std::vector<char> buffer(out_len);
+            uint16_t written = 0;
+            const parser_error_t err =
+                json_decode_string(s.c_str(), s.size(), buffer.data(), out_len, &written);
+            out->assign(buffer.data(), written);
+            return err;
+        };
+        std::string out;
+
+        EXPECT_EQ(decode(R"(plain)", 16, &out), parser_ok);
+        EXPECT_EQ(out, "plain");
+        EXPECT_EQ(decode(R"(\"a\\b\/c\n)", 16, &out), parser_ok);
+        EXPECT_EQ(out, R"("a\b/c.)");
+        EXPECT_EQ(decode(R"(Aé😀!)", 16, &out), parser_ok);
+        EXPECT_EQ(out, "A..!");
+        EXPECT_EQ(decode("caf\xc3\xa9 \xf0\x9f\x98\x80", 16, &out), parser_ok);
+        EXPECT_EQ(out, "caf. .");
+
+        EXPECT_EQ(decode(R"(AB)", 1, &out), parser_value_out_of_range);
+    }
 }
+
@@ -0,0 +1,95 @@
+/*******************************************************************************
+*   (c) 2018 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gtest/gtest.h"
+#include <json/json_pointer.h>
+#include <common/parser.h>
+#include "util/common.h"
+
+namespace {
+    std::string pointer_value(json_pointer_ctx_t *ctx, const char *transaction, const char *pointer) {
+        uint16_t token_index;
+        const parser_error_t err = json_pointer_get(ctx, pointer, &token_index);
+        if (err != parser_ok) {
+            return parser_getErrorDescription(err);
+        }
+        return std::string(transaction + JSON_TOKEN_START(ctx->json, token_index),
+                           JSON_TOKEN_LEN(ctx->json, token_index));
+    }
+
+    TEST(JsonPointerTest, Resolve) {
+        auto transaction =
+                R"({"fee":{"amount":[],"gas":"2000000"},"msgs":[{"type":"thorchain/MsgDeposit","value":{"coins":[{"amount":"1","asset":"THOR.RUNE"},{"amount":"2","asset":"BTC/BTC"}]}}],"a/b":"slash","m~n":"tilde"})";
+        parsed_json_t parsed_json;
+        ASSERT_EQ(JSON_PARSE(&parsed_json, transaction), parser_ok);
+
+        json_pointer_ctx_t ctx;
+        json_pointer_ctx_init(&ctx, &parsed_json);
+
+        EXPECT_EQ(pointer_value(&ctx, transaction, "/fee/gas"), "2000000");
+        EXPECT_EQ(pointer_value(&ctx, transaction, "/msgs/0/value/coins/1/amount"), "2");
+        EXPECT_EQ(pointer_value(&ctx, transaction, "/msgs/0/value/coins/0/asset"), "THOR.RUNE");
+        EXPECT_EQ(pointer_value(&ctx, transaction, "/msgs/0/type"), "thorchain/MsgDeposit");
+        EXPECT_EQ(pointer_value(&ctx, transaction, "/a~1b"), "slash");
+        EXPECT_EQ(pointer_value(&ctx, transaction, "/m~0n"), "tilde");
+        EXPECT_EQ(pointer_value(&ctx, transaction, ""), transaction);
+
+        // Cached results are returned again without resolving any step
+        const uint8_t num_entries = ctx.num_entries;
+        EXPECT_EQ(pointer_value(&ctx, transaction, "/msgs/0/value/coins/1/amount"), "2");
+        EXPECT_EQ(pointer_value(&ctx, transaction, "/fee/gas"), "2000000");
+        EXPECT_EQ(ctx.num_entries, num_entries);
+    }
+
+    TEST(JsonPointerTest, Reparse) {
+        auto first = R"({"fee":{"gas":"2000000"},"msgs":[{"type":"thorchain/MsgSend"}]})";
+        auto second = R"({"memo":"","msgs":[{"type":"thorchain/MsgDeposit"}]})";
+        parsed_json_t parsed_json;
+        ASSERT_EQ(JSON_PARSE(&parsed_json, first), parser_ok);
+
+        json_pointer_ctx_t ctx;
+        json_pointer_ctx_init(&ctx, &parsed_json);
+        EXPECT_EQ(pointer_value(&ctx, first, "/msgs/0/type"), "thorchain/MsgSend");
+        EXPECT_EQ(pointer_value(&ctx, first, "/fee/gas"), "2000000");
+
+        // The same context on a new document must not reuse the cached prefixes, their token
+        // indices are past the end or point to other values now
+        ASSERT_EQ(JSON_PARSE(&parsed_json, second), parser_ok);
+        EXPECT_EQ(pointer_value(&ctx, second, "/msgs/0/type"), "thorchain/MsgDeposit");
+        EXPECT_EQ(pointer_value(&ctx, second, "/fee/gas"), "No more data");
+    }
+
+    TEST(JsonPointerTest, Errors) {
+        auto transaction = R"({"list":[1,2,3],"obj":{"0":"zero"}})";
+        parsed_json_t parsed_json;
+        ASSERT_EQ(JSON_PARSE(&parsed_json, transaction), parser_ok);
+
+        json_pointer_ctx_t ctx;
+        json_pointer_ctx_init(&ctx, &parsed_json);
+
+        uint16_t token_index;
+        EXPECT_EQ(json_pointer_get(&ctx, "list", &token_index), parser_unexpected_characters);
+        EXPECT_EQ(json_pointer_get(&ctx, "/list~2", &token_index), parser_unexpected_characters);
+        EXPECT_EQ(json_pointer_get(&ctx, "/list/3", &token_index), parser_no_data);
+        EXPECT_EQ(json_pointer_get(&ctx, "/list/01", &token_index), parser_no_data);
+        EXPECT_EQ(json_pointer_get(&ctx, "/list/-", &token_index), parser_no_data);
+        EXPECT_EQ(json_pointer_get(&ctx, "/missing", &token_index), parser_no_data);
+        EXPECT_EQ(json_pointer_get(&ctx, "/a/b/c/d/e/f/g/h/i", &token_index), parser_value_out_of_range);
+
+        EXPECT_EQ(pointer_value(&ctx, transaction, "/list/2"), "3");
+        EXPECT_EQ(pointer_value(&ctx, transaction, "/obj/0"), "zero");
+    }
+}
@@ -0,0 +1,94 @@
+/*******************************************************************************
+*   (c) 2018 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gtest/gtest.h"
+#include <tx_numbers.h>
+#include <tx_display.h>
+#include <common/parser.h>
+#include "util/common.h"
+
+namespace {
+    const char *deposit_tx = R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[{"amount":"2000000","denom":"rune"}],"gas":"10000000"},"memo":"","msgs":[{"type":"thorchain/MsgDeposit","value":{"coins":[{"amount":"100000000","asset":"THOR.RUNE"}],"memo":"=:BNB.BNB","signer":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp"}},{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"18446744073709551615","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}],"sequence":"6"})";
+
+    TEST(TxNumbers, ParseUint64) {
+        uint64_t value = 1;
+
+        EXPECT_EQ(tx_numbers_parse_uint64("0", 1, &value), parser_ok);
+        EXPECT_EQ(value, 0u);
+        EXPECT_EQ(tx_numbers_parse_uint64("000588", 6, &value), parser_ok);
+        EXPECT_EQ(value, 588u);
+        EXPECT_EQ(tx_numbers_parse_uint64("18446744073709551615", 20, &value), parser_ok);
+        EXPECT_EQ(value, UINT64_MAX);
+
+        EXPECT_EQ(tx_numbers_parse_uint64("18446744073709551616", 20, &value),
+                  parser_value_out_of_range);
+        EXPECT_EQ(tx_numbers_parse_uint64("99999999999999999999", 20, &value),
+                  parser_value_out_of_range);
+        EXPECT_EQ(tx_numbers_parse_uint64("", 0, &value), parser_unexpected_value);
+        EXPECT_EQ(tx_numbers_parse_uint64("12a", 3, &value), parser_unexpected_characters);
+        EXPECT_EQ(tx_numbers_parse_uint64("-1", 2, &value), parser_unexpected_characters);
+        EXPECT_EQ(tx_numbers_parse_uint64("1.5", 3, &value), parser_unexpected_characters);
+    }
+
+    TEST(TxNumbers, Read) {
+        parser_context_t ctx;
+        parser_error_t err = parser_parse(&ctx, (const uint8_t *) deposit_tx, strlen(deposit_tx));
+        ASSERT_EQ(err, parser_ok) << parser_getErrorDescription(err);
+
+        const tx_numbers_t *numbers = nullptr;
+        ASSERT_EQ(tx_display_numbers(&numbers), parser_ok);
+        ASSERT_NE(numbers, nullptr);
+        EXPECT_EQ(numbers->account_number, 588u);
+        EXPECT_EQ(numbers->sequence, 6u);
+        EXPECT_TRUE(numbers->has_gas);
+        EXPECT_EQ(numbers->gas, 10000000u);
+
+        // Fee first, then the messages in document order
+        ASSERT_EQ(numbers->num_amounts, 3);
+        EXPECT_TRUE(numbers->amounts[0].is_fee);
+        EXPECT_EQ(numbers->amounts[0].value, 2000000u);
+        EXPECT_FALSE(numbers->amounts[1].is_fee);
+        EXPECT_EQ(numbers->amounts[1].value, 100000000u);
+        EXPECT_EQ(numbers->amounts[2].value, UINT64_MAX);
+
+        for (uint16_t i = 0; i < numbers->num_amounts; i++) {
+            EXPECT_EQ(tx_numbers_find_amount(numbers, numbers->amounts[i].token_idx),
+                      &numbers->amounts[i]);
+        }
+        EXPECT_EQ(tx_numbers_find_amount(numbers, 0), nullptr);
+    }
+
+    TEST(TxNumbers, RejectInvalid) {
+        const std::vector<std::pair<std::string, parser_error_t>> cases = {
+            {R"({"account_number":"58x","chain_id":"thorchain","fee":{"amount":[],"gas":"1"},"memo":"","msgs":[],"sequence":"5"})",
+             parser_unexpected_characters},
+            {R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"1"},"memo":"","msgs":[],"sequence":"18446744073709551616"})",
+             parser_value_out_of_range},
+            {R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"1e6"},"memo":"","msgs":[],"sequence":"5"})",
+             parser_unexpected_characters},
+            {R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[{"amount":"","denom":"rune"}],"gas":"1"},"memo":"","msgs":[],"sequence":"5"})",
+             parser_unexpected_value},
+            {R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"1"},"memo":"","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"ABC","denom":"rune"}],"from_address":"a","to_address":"b"}}],"sequence":"5"})",
+             parser_unexpected_characters},
+        };
+
+        for (const auto &c : cases) {
+            parser_context_t ctx;
+            ASSERT_EQ(parser_parse(&ctx, (const uint8_t *) c.first.c_str(), c.first.size()), parser_ok);
+            EXPECT_EQ(parser_validate(&ctx), c.second) << c.first;
+        }
+    }
+}
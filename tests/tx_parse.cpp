@@ -18,7 +18,10 @@
 #include <json/json_parser.h>
 #include <tx_display.h>
 #include <tx_parser.h>
+#include <tx_msgs.h>
 #include <common/parser.h>
+#include <app_mode.h>
+#include <parser_impl.h>
 #include "util/common.h"
 
 namespace {
@@ -45,11 +48,13 @@ namespace {
         ASSERT_EQ(err, parser_ok);
         // Check some tokens
         ASSERT_EQ(parser_tx_obj.json.numberOfTokens, 7) << "It should contain 7 = 1 (dict) + 6 (key+value)";
-        ASSERT_EQ(parser_tx_obj.json.tokens[0].start, 0);
-        ASSERT_EQ(parser_tx_obj.json.tokens[0].end, 46);
-        ASSERT_EQ(parser_tx_obj.json.tokens[0].size, 3) << "size should be 3 = 3 key/values contained in the dict";
-        ASSERT_EQ(parser_tx_obj.json.tokens[3].start, 19);
-        ASSERT_EQ(parser_tx_obj.json.tokens[3].end, 23);
+        ASSERT_EQ(JSON_TOKEN_START(&parser_tx_obj.json, 0), 0);
+        ASSERT_EQ(JSON_TOKEN_END(&parser_tx_obj.json, 0), 46);
+        uint16_t element_count = 0;
+        ASSERT_EQ(object_get_element_count(&parser_tx_obj.json, 0, &element_count), parser_ok);
+        ASSERT_EQ(element_count, 3) << "size should be 3 = 3 key/values contained in the dict";
+        ASSERT_EQ(JSON_TOKEN_START(&parser_tx_obj.json, 3), 19);
+        ASSERT_EQ(JSON_TOKEN_END(&parser_tx_obj.json, 3), 23);
 
         char key[100];
         char val[100];
@@ -131,7 +136,7 @@ namespace {
         parser_error_t err = JSON_PARSE(&parser_tx_obj.json, parser_tx_obj.tx);
         EXPECT_EQ(err, parser_ok);
 
-        uint8_t numItems;
+        uint16_t numItems;
         tx_display_numItems(&numItems);
 
         EXPECT_EQ(1, numItems) << "Wrong number of items";
@@ -145,9 +150,255 @@ namespace {
         parser_error_t err = JSON_PARSE(&parser_tx_obj.json, parser_tx_obj.tx);
         EXPECT_EQ(err, parser_ok);
 
-        uint8_t numItems;
+        uint16_t numItems;
         tx_display_numItems(&numItems);
         EXPECT_EQ(6, numItems) << "Wrong number of items";
     }
 
+    TEST(TxParse, Tx_Display_Keys) {
+        auto transaction = R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"TestMemo","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","asset":"THOR.RUNE"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","test":"test","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}],"sequence":"5"})";
+
+        parser_context_t ctx;
+        parser_error_t err = parser_parse(&ctx, (const uint8_t *) transaction, strlen(transaction));
+        ASSERT_EQ(err, parser_ok) << parser_getErrorDescription(err);
+
+        auto output = dumpUI(&ctx, 40, 64);
+        std::vector<std::string> expected = {
+            "0 | Memo : TestMemo",
+            "1 | Type : Send",
+            "2 | Amount : 1.5 THOR.RUNE",
+            "3 | From : tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp",
+            "4 | msgs/value/test : test",
+            "5 | To : tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z",
+        };
+        EXPECT_EQ(output, expected);
+
+        // Substitutions do not depend on the size of the key buffer
+        output = dumpUI(&ctx, 5, 64);
+        ASSERT_EQ(output.size(), expected.size());
+        EXPECT_EQ(output[3], "3 | From : tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp");
+    }
+
+    TEST(TxParse, Tx_Msgs_Registry) {
+        for (uint8_t i = 0; i < tx_msgs_count(); i++) {
+            const msg_descriptor_t *desc = tx_msgs_descriptor(i);
+            ASSERT_NE(desc, nullptr);
+            EXPECT_EQ(desc->type_hash, tx_msgs_hash(desc->type, desc->type_len)) << desc->type;
+            EXPECT_EQ(tx_msgs_find_type(desc->type, desc->type_len), i);
+            for (uint8_t f = 0; f < desc->num_fields; f++) {
+                const msg_field_t *field = &desc->fields[f];
+                EXPECT_EQ(tx_msgs_find_field(i, field->key, field->key_len), f) << field->key;
+            }
+        }
+
+        EXPECT_EQ(tx_msgs_descriptor(tx_msgs_count()), nullptr);
+        EXPECT_EQ(tx_msgs_find_type("thorchain/MsgSen", 16), MSG_TYPE_UNKNOWN);
+        EXPECT_EQ(tx_msgs_find_field(MSG_TYPE_UNKNOWN, "amount", 6), MSG_FIELD_NONE);
+    }
+
+    TEST(TxParse, Tx_Display_UnknownMsg) {
+        auto transaction = R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"","msgs":[{"type":"thorchain/MsgFoo","value":{"amount":"1","signer":"abc"}},{"type":"thorchain/MsgDeposit","value":{"coins":[{"amount":"100000000","asset":"THOR.RUNE"}],"memo":"=:BNB.BNB","signer":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp"}}],"sequence":"5"})";
+
+        parser_context_t ctx;
+        parser_error_t err = parser_parse(&ctx, (const uint8_t *) transaction, strlen(transaction));
+        ASSERT_EQ(err, parser_ok) << parser_getErrorDescription(err);
+
+        auto output = dumpUI(&ctx, 40, 64);
+        std::vector<std::string> expected = {
+            "0 | Type : thorchain/MsgFoo",
+            "1 | msgs/value/amount : 1",
+            "2 | msgs/value/signer : abc",
+            "3 | Type : Deposit",
+            "4 | Amount : 1.0 THOR.RUNE",
+            "5 | Memo : =:BNB.BNB",
+            "6 | Sender : tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp",
+        };
+        EXPECT_EQ(output, expected);
+    }
+
+    TEST(TxParse, Tx_Display_MsgJump) {
+        auto transaction = R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"","msgs":[{"type":"thorchain/MsgFoo","value":{"amount":"1","signer":"abc"}},{"type":"thorchain/MsgDeposit","value":{"coins":[{"amount":"100000000","asset":"THOR.RUNE"}],"memo":"=:BNB.BNB","signer":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp"}}],"sequence":"5"})";
+
+        parser_context_t ctx;
+        parser_error_t err = parser_parse(&ctx, (const uint8_t *) transaction, strlen(transaction));
+        ASSERT_EQ(err, parser_ok) << parser_getErrorDescription(err);
+
+        uint16_t num_msgs = 0;
+        ASSERT_EQ(parser_getNumMsgs(&ctx, &num_msgs), parser_ok);
+        EXPECT_EQ(num_msgs, 2);
+
+        uint16_t display_idx = 0;
+        ASSERT_EQ(parser_getMsgFirstItem(&ctx, 0, &display_idx), parser_ok);
+        EXPECT_EQ(display_idx, 0);
+        ASSERT_EQ(parser_getMsgFirstItem(&ctx, 1, &display_idx), parser_ok);
+        EXPECT_EQ(display_idx, 3);
+        EXPECT_EQ(parser_getMsgFirstItem(&ctx, 2, &display_idx), parser_display_idx_out_of_range);
+
+        // Expert mode shows the root items before msgs
+        app_mode_set_expert(1);
+        auto output = dumpUI(&ctx, 40, 64);
+        ASSERT_EQ(parser_getMsgFirstItem(&ctx, 1, &display_idx), parser_ok);
+        app_mode_set_expert(0);
+        ASSERT_LT(display_idx, output.size());
+        EXPECT_EQ(output[display_idx], std::to_string(display_idx) + " | Type : Deposit");
+    }
+
+    TEST(TxParse, Tx_Display_ManyItems) {
+        const std::string msg = R"({"type":"thorchain/MsgDeposit","value":{"coins":[{"amount":"1","asset":"THOR.RUNE"}],"memo":"=:BNB.BNB","signer":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp"}})";
+        std::string transaction = R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"","msgs":[)";
+        for (int i = 0; i < 80; i++) {
+            transaction += (i > 0 ? "," : "") + msg;
+        }
+        transaction += R"(],"sequence":"5"})";
+
+        parser_context_t ctx;
+        parser_error_t err = parser_parse(&ctx, (const uint8_t *) transaction.c_str(), transaction.size());
+        ASSERT_EQ(err, parser_ok) << parser_getErrorDescription(err);
+
+        // 4 items per message, the count no longer wraps at 255
+        uint16_t numItems = 0;
+        ASSERT_EQ(parser_getNumItems(&ctx, &numItems), parser_ok);
+        EXPECT_GT(numItems, 320);
+
+        uint16_t display_idx = 0;
+        ASSERT_EQ(parser_getMsgFirstItem(&ctx, 79, &display_idx), parser_ok);
+        EXPECT_EQ(display_idx + 4, numItems);
+
+        auto output = dumpUI(&ctx, 40, 64);
+        ASSERT_EQ(output.back(), std::to_string(numItems - 1) + " | Sender : tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp");
+    }
+
+    TEST(TxParse, Tx_Display_Reparse) {
+        auto send_tx = R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"TestMemo","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}],"sequence":"5"})";
+        auto minimal_tx = R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"","msgs":[],"sequence":"5"})";
+
+        parser_tx_obj.tx = send_tx;
+        parser_tx_obj.flags.cache_valid = 0;
+        ASSERT_EQ(JSON_PARSE(&parser_tx_obj.json, parser_tx_obj.tx), parser_ok);
+        const uint32_t generation = parser_tx_obj.json.generation;
+
+        uint16_t numItems = 0;
+        ASSERT_EQ(tx_display_numItems(&numItems), parser_ok);
+        EXPECT_EQ(5, numItems);
+
+        // A new parse invalidates the display cache without clearing the flag
+        parser_tx_obj.tx = minimal_tx;
+        ASSERT_EQ(JSON_PARSE(&parser_tx_obj.json, parser_tx_obj.tx), parser_ok);
+        EXPECT_EQ(parser_tx_obj.json.generation, generation + 1);
+        ASSERT_EQ(tx_display_numItems(&numItems), parser_ok);
+        EXPECT_EQ(0, numItems);
+    }
+
+    TEST(TxParse, Tx_Display_NonAsciiMemo) {
+        auto transaction = "{\"account_number\":\"588\",\"chain_id\":\"thorchain\",\"fee\":{\"amount\":[],\"gas\":\"2000000\"},\"memo\":\"\","
+                           "\"msgs\":[{\"type\":\"thorchain/MsgDeposit\",\"value\":{\"coins\":[{\"amount\":\"100000000\",\"asset\":\"THOR.RUNE\"}],"
+                           "\"memo\":\"caf\xc3\xa9\",\"signer\":\"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp\"}}],\"sequence\":\"5\"}";
+
+        parser_context_t ctx;
+        parser_error_t err = parser_parse(&ctx, (const uint8_t *) transaction, strlen(transaction));
+        ASSERT_EQ(err, parser_ok) << parser_getErrorDescription(err);
+
+        // Only ASCII reaches the screen, one placeholder per code point
+        auto output = dumpUI(&ctx, 40, 64);
+        std::vector<std::string> expected = {
+            "0 | Type : Deposit",
+            "1 | Amount : 1.0 THOR.RUNE",
+            "2 | Memo : caf.",
+            "3 | Sender : tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp",
+        };
+        EXPECT_EQ(output, expected);
+    }
+
+    TEST(TxParse, Tx_Display_EscapedMemo) {
+        auto transaction = R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"","msgs":[{"type":"thorchain/MsgDeposit","value":{"coins":[{"amount":"100000000","asset":"THOR.RUNE"}],"memo":"\"quoted\" \u00e9t\u00e9 OK","signer":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp"}}],"sequence":"5"})";
+
+        parser_context_t ctx;
+        parser_error_t err = parser_parse(&ctx, (const uint8_t *) transaction, strlen(transaction));
+        ASSERT_EQ(err, parser_ok) << parser_getErrorDescription(err);
+
+        // Pages are counted on the decoded text
+        auto output = dumpUI(&ctx, 40, 11);
+        std::vector<std::string> expected = {
+            "0 | Type : Deposit",
+            "1 | Amount [1/2] : 1.0 THOR.R",
+            "1 | Amount [2/2] : UNE",
+            "2 | Memo [1/2] : \"quoted\" .",
+            "2 | Memo [2/2] : t. OK",
+            "3 | Sender [1/5] : tthor1c648",
+            "3 | Sender [2/5] : xgpter9xff",
+            "3 | Sender [3/5] : hmcqvs7lzd",
+            "3 | Sender [4/5] : 7hxh0prgv5",
+            "3 | Sender [5/5] : t5gp",
+        };
+        EXPECT_EQ(output, expected);
+    }
+
+    TEST(TxParse, Tx_Display_ValueSubstitution) {
+        auto transaction = R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"[]","msgs":[{"type":"thorchain/MsgDeposit","value":{"coins":[{"amount":"100000000","asset":"THOR.RUNE"}],"memo":"=:BNB.BNB","signer":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp"}}],"sequence":"5"})";
+
+        parser_context_t ctx;
+        parser_error_t err = parser_parse(&ctx, (const uint8_t *) transaction, strlen(transaction));
+        ASSERT_EQ(err, parser_ok) << parser_getErrorDescription(err);
+        auto output = dumpUI(&ctx, 40, 64);
+        std::vector<std::string> expected = {
+            "0 | Memo : Empty",
+            "1 | Type : Deposit",
+            "2 | Amount : 1.0 THOR.RUNE",
+            "3 | Memo : =:BNB.BNB",
+            "4 | Sender : tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp",
+        };
+        EXPECT_EQ(output, expected);
+
+        // Same shape, the substitution is matched for every tx
+        std::string other = transaction;
+        other.replace(other.find("\"memo\":\"[]\""), 11, "\"memo\":\"[a\"");
+        err = parser_parse(&ctx, (const uint8_t *) other.c_str(), other.size());
+        ASSERT_EQ(err, parser_ok) << parser_getErrorDescription(err);
+        output = dumpUI(&ctx, 40, 64);
+        expected[0] = "0 | Memo : [a";
+        EXPECT_EQ(output, expected);
+    }
+
+    TEST(TxParse, SubstitutionTablesSorted) {
+        // key_subst_find only compares the entries with the length of the key
+        uint8_t counts[2] = {0, 0};
+        const key_subst_t *tables[2] = {
+            tx_display_keySubstitutions(&counts[0]),
+            tx_display_valueSubstitutions(&counts[1]),
+        };
+        for (uint8_t t = 0; t < 2; t++) {
+            for (uint8_t i = 0; i < counts[t]; i++) {
+                const key_subst_t *entry = &tables[t][i];
+                EXPECT_EQ(entry->str1_len, strlen(entry->str1)) << entry->str1;
+                if (i > 0) {
+                    EXPECT_LE(tables[t][i - 1].str1_len, entry->str1_len) << entry->str1;
+                }
+                EXPECT_EQ(key_subst_find(tables[t], counts[t], entry->str1, entry->str1_len), i)
+                    << entry->str1;
+            }
+        }
+    }
+
+    TEST(TxParse, KeySubstFindByLength) {
+        // Sorted by key length, with several keys of the same length
+        const key_subst_t table[] = {
+            KEY_SUBST("a", "1"),
+            KEY_SUBST("ab", "2"),
+            KEY_SUBST("cd", "3"),
+            KEY_SUBST("ef", "4"),
+            KEY_SUBST("abcd", "5"),
+        };
+        const uint8_t len = sizeof(table) / sizeof(table[0]);
+
+        EXPECT_EQ(key_subst_find(table, len, "a", 1), 0);
+        EXPECT_EQ(key_subst_find(table, len, "ab", 2), 1);
+        EXPECT_EQ(key_subst_find(table, len, "ef", 2), 3);
+        EXPECT_EQ(key_subst_find(table, len, "abcd", 4), 4);
+        // A prefix of a longer key does not match
+        EXPECT_EQ(key_subst_find(table, len, "abcd", 3), KEY_SUBST_NONE);
+        EXPECT_EQ(key_subst_find(table, len, "gh", 2), KEY_SUBST_NONE);
+        EXPECT_EQ(key_subst_find(table, len, "abcde", 5), KEY_SUBST_NONE);
+        EXPECT_EQ(key_subst_find(table, len, "", 0), KEY_SUBST_NONE);
+        EXPECT_EQ(key_subst_find(table, 0, "a", 1), KEY_SUBST_NONE);
+    }
 }
@@ -0,0 +1,149 @@
+/*******************************************************************************
+*   (c) 2018 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gtest/gtest.h"
+#include <tx_plan_cache.h>
+#include <common/parser.h>
+#include <parser_impl.h>
+#include "util/common.h"
+
+namespace {
+    std::string deposit_tx(const std::string &amount, const std::string &memo) {
+        return R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"10000000"},"memo":")" +
+               memo +
+               R"(","msgs":[{"type":"thorchain/MsgDeposit","value":{"coins":[{"amount":")" +
+               amount +
+               R"(","asset":"THOR.RUNE"}],"memo":"=:BNB.BNB","signer":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp"}}],"sequence":"6"})";
+    }
+
+    std::vector<std::string> parseAndDump(const std::string &tx) {
+        parser_context_t ctx;
+        parser_error_t err = parser_parse(&ctx, (const uint8_t *) tx.c_str(), tx.size());
+        EXPECT_EQ(err, parser_ok) << parser_getErrorDescription(err);
+        err = parser_validate(&ctx);
+        EXPECT_EQ(err, parser_ok) << parser_getErrorDescription(err);
+        return dumpUI(&ctx, 40, 40);
+    }
+
+    TEST(TxPlanCache, SameShapeShowsOwnValues) {
+        tx_plan_cache_clear();
+
+        const auto first = parseAndDump(deposit_tx("100000000", ""));
+        const auto second = parseAndDump(deposit_tx("250000000", ""));
+
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+        tx_plan_cache_stats(&hits, &misses);
+        EXPECT_EQ(misses, 1u);
+        EXPECT_GE(hits, 1u);
+
+        // The cached plan must give the same items as indexing the tx from scratch
+        tx_plan_cache_clear();
+        EXPECT_EQ(parseAndDump(deposit_tx("250000000", "")), second);
+        EXPECT_NE(first, second);
+    }
+
+    TEST(TxPlanCache, EmptyMemoGetsOwnPlan) {
+        tx_plan_cache_clear();
+
+        const auto without_memo = parseAndDump(deposit_tx("100000000", ""));
+        const auto with_memo = parseAndDump(deposit_tx("100000000", "hello"));
+        EXPECT_EQ(with_memo.size(), without_memo.size() + 1);
+
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+        tx_plan_cache_stats(&hits, &misses);
+        EXPECT_EQ(misses, 2u);
+
+        tx_plan_cache_clear();
+        EXPECT_EQ(parseAndDump(deposit_tx("100000000", "hello")), with_memo);
+    }
+
+    TEST(TxPlanCache, UnsortedKeysRejectedOnRepeat) {
+        tx_plan_cache_clear();
+
+        const std::string tx =
+            R"({"account_number":"588","chain_id":"thorchain","fee":{"gas":"1","amount":[]},"memo":"","msgs":[],"sequence":"5"})";
+        for (int i = 0; i < 2; i++) {
+            parser_context_t ctx;
+            ASSERT_EQ(parser_parse(&ctx, (const uint8_t *) tx.c_str(), tx.size()), parser_ok);
+            EXPECT_EQ(parser_validate(&ctx), parser_json_is_not_sorted);
+        }
+
+        // Equal keys are compared up to their values, their verdict is never shared
+        const std::string duplicated_a =
+            R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"1"},"memo":"","msgs":[],"sequence":"5","sequence":"6"})";
+        const std::string duplicated_b =
+            R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"1"},"memo":"","msgs":[],"sequence":"6","sequence":"5"})";
+        parser_context_t ctx;
+        ASSERT_EQ(parser_parse(&ctx, (const uint8_t *) duplicated_a.c_str(), duplicated_a.size()),
+                  parser_ok);
+        EXPECT_EQ(parser_validate(&ctx), parser_ok);
+        ASSERT_EQ(parser_parse(&ctx, (const uint8_t *) duplicated_b.c_str(), duplicated_b.size()),
+                  parser_ok);
+        EXPECT_EQ(parser_validate(&ctx), parser_json_is_not_sorted);
+    }
+
+    // Parses tx with the fingerprint of another shape, as if both had collided
+    parser_error_t parseColliding(parser_context_t *ctx, const std::string &tx, uint64_t fingerprint) {
+        const parser_error_t err = parser_parse(ctx, (const uint8_t *) tx.c_str(), tx.size());
+        parser_tx_obj.json.fingerprint = fingerprint;
+        return err;
+    }
+
+    TEST(TxPlanCache, CollidingShapesKeepOwnVerdict) {
+        tx_plan_cache_clear();
+
+        const std::string sorted =
+            R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"1"},"memo":"","msgs":[],"sequence":"5"})";
+        const std::string unsorted =
+            R"({"account_number":"588","chain_id":"thorchain","fee":{"gas":"1","amount":[]},"memo":"","msgs":[],"sequence":"5"})";
+
+        parser_context_t ctx;
+        ASSERT_EQ(parser_parse(&ctx, (const uint8_t *) sorted.c_str(), sorted.size()), parser_ok);
+        const uint64_t fingerprint = parser_tx_obj.json.fingerprint;
+        const uint32_t num_tokens = parser_tx_obj.json.numberOfTokens;
+        EXPECT_EQ(parser_validate(&ctx), parser_ok);
+
+        // Same fingerprint and number of tokens, only the stored shape tells them apart
+        ASSERT_EQ(parseColliding(&ctx, unsorted, fingerprint), parser_ok);
+        ASSERT_EQ(parser_tx_obj.json.numberOfTokens, num_tokens);
+        EXPECT_EQ(parser_validate(&ctx), parser_json_is_not_sorted);
+    }
+
+    TEST(TxPlanCache, CollidingShapesGetOwnPlan) {
+        // Same number of tokens as deposit_tx, a different key in the message
+        std::string other = deposit_tx("100000000", "");
+        other.replace(other.find(R"("memo":"=:)"), 6, R"("mema")");
+
+        tx_plan_cache_clear();
+        const auto expected = parseAndDump(other);
+
+        tx_plan_cache_clear();
+        parseAndDump(deposit_tx("100000000", ""));
+        const uint64_t fingerprint = parser_tx_obj.json.fingerprint;
+
+        parser_context_t ctx;
+        ASSERT_EQ(parseColliding(&ctx, other, fingerprint), parser_ok);
+        ASSERT_EQ(parser_validate(&ctx), parser_ok);
+        EXPECT_EQ(dumpUI(&ctx, 40, 40), expected);
+
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+        tx_plan_cache_stats(&hits, &misses);
+        EXPECT_EQ(hits, 0u);
+    }
+}
@@ -0,0 +1,134 @@
+/*******************************************************************************
+*   (c) 2018 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gtest/gtest.h"
+#include <host/tx_result_cache.h>
+#include <common/parser.h>
+#include <thread>
+#include "util/common.h"
+
+namespace {
+    const std::string deposit_tx =
+        R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"10000000"},"memo":"","msgs":[{"type":"thorchain/MsgDeposit","value":{"coins":[{"amount":"100000000","asset":"THOR.RUNE"}],"memo":"=:BNB.BNB","signer":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp"}}],"sequence":"6"})";
+
+    std::vector<std::string> resultItems(const tx_result_t &result) {
+        std::vector<std::string> items;
+        for (uint16_t i = 0; i < result.num_items; i++) {
+            const char *key = nullptr;
+            const char *value = nullptr;
+            EXPECT_EQ(tx_result_getItem(&result, i, &key, &value), parser_ok);
+            items.push_back(std::string(key) + " : " + value);
+        }
+        return items;
+    }
+
+    TEST(TxResultCache, RepeatIsServedFromCache) {
+        tx_result_cache_clear();
+
+        tx_result_t first;
+        ASSERT_EQ(tx_result_cache_process((const uint8_t *) deposit_tx.c_str(), deposit_tx.size(),
+                                          &first),
+                  parser_ok);
+        EXPECT_FALSE(first.truncated);
+
+        const std::vector<std::string> expected = {
+            "Type : Deposit",
+            "Amount : 1.0 THOR.RUNE",
+            "Memo : =:BNB.BNB",
+            "Sender : tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp",
+        };
+        EXPECT_EQ(resultItems(first), expected);
+
+        tx_result_t second;
+        ASSERT_EQ(tx_result_cache_process((const uint8_t *) deposit_tx.c_str(), deposit_tx.size(),
+                                          &second),
+                  parser_ok);
+        EXPECT_EQ(resultItems(second), expected);
+
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        tx_result_cache_stats(&hits, &misses);
+        EXPECT_EQ(hits, 1u);
+        EXPECT_EQ(misses, 1u);
+
+        const char *key = nullptr;
+        const char *value = nullptr;
+        EXPECT_EQ(tx_result_getItem(&second, second.num_items, &key, &value),
+                  parser_display_idx_out_of_range);
+    }
+
+    TEST(TxResultCache, VerdictIsCached) {
+        tx_result_cache_clear();
+
+        const std::string tx = R"({"account_number":"588","chain_id":"thorchain"})";
+        tx_result_t result;
+        for (int i = 0; i < 2; i++) {
+            EXPECT_EQ(tx_result_cache_process((const uint8_t *) tx.c_str(), tx.size(), &result),
+                      parser_json_missing_fee);
+            EXPECT_EQ(result.num_items, 0);
+        }
+
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        tx_result_cache_stats(&hits, &misses);
+        EXPECT_EQ(hits, 1u);
+        EXPECT_EQ(misses, 1u);
+    }
+
+    TEST(TxResultCache, ConcurrentLookups) {
+        tx_result_cache_clear();
+
+        // Payloads that only differ in their sequence land in different shards
+        std::vector<std::string> txs;
+        for (int i = 0; i < 32; i++) {
+            std::string tx = deposit_tx;
+            const std::string sequence = R"("sequence":")" + std::to_string(i) + "\"";
+            tx.replace(tx.find(R"("sequence":"6")"), 14, sequence);
+            txs.push_back(tx);
+        }
+
+        const int rounds = 4;
+        std::vector<std::thread> threads;
+        std::vector<int> failures(8, 0);
+        for (size_t t = 0; t < failures.size(); t++) {
+            threads.emplace_back([&txs, &failures, t]() {
+                for (int round = 0; round < rounds; round++) {
+                    for (const auto &tx : txs) {
+                        tx_result_t result;
+                        if (tx_result_cache_process((const uint8_t *) tx.c_str(), tx.size(),
+                                                    &result) != parser_ok ||
+                            result.num_items != 4) {
+                            failures[t]++;
+                        }
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        for (int f : failures) {
+            EXPECT_EQ(f, 0);
+        }
+
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        tx_result_cache_stats(&hits, &misses);
+        EXPECT_EQ(hits + misses, failures.size() * rounds * txs.size());
+        EXPECT_GE(misses, txs.size());
+    }
+}
@@ -0,0 +1,225 @@
+/*******************************************************************************
+*   (c) 2018 Zondax GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gtest/gtest.h"
+#include <tx_summary.h>
+#include <tx_msgs.h>
+#include <common/parser.h>
+#include <tx_display.h>
+#include "util/common.h"
+
+namespace {
+    const char *send_tx = R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[{"amount":"2000000","denom":"rune"}],"gas":"2000000"},"memo":"","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}],"sequence":"5"})";
+    const char *deposit_tx = R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"","msgs":[{"type":"thorchain/MsgDeposit","value":{"coins":[{"amount":"100000000","asset":"THOR.RUNE"}],"memo":"=:BNB.BNB","signer":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp"}},{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"50000000","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}],"sequence":"6"})";
+
+    parser_error_t add_tx(tx_summary_t *summary, const char *tx) {
+        parser_context_t ctx;
+        parser_error_t err = parser_parse(&ctx, (const uint8_t *) tx, strlen(tx));
+        if (err != parser_ok) {
+            return err;
+        }
+        return tx_summary_add_tx(summary, &parser_tx_obj.json);
+    }
+
+    std::vector<std::string> dumpSummary(const tx_summary_t *summary) {
+        std::vector<std::string> answer;
+
+        uint16_t numItems = 0;
+        EXPECT_EQ(parser_getSummaryNumItems(summary, &numItems), parser_ok);
+        for (uint16_t idx = 0; idx < numItems; idx++) {
+            char key[40];
+            char value[40];
+            uint8_t pageCount = 1;
+            for (uint8_t page = 0; page < pageCount; page++) {
+                EXPECT_EQ(parser_getSummaryItem(summary, idx, key, sizeof(key), value,
+                                                sizeof(value), page, &pageCount), parser_ok);
+                answer.push_back(std::to_string(idx) + " | " + key + " : " + value);
+            }
+        }
+
+        return answer;
+    }
+
+    TEST(TxSummary, AddDecimal) {
+        char acc[8] = "";
+
+        EXPECT_EQ(tx_summary_add_decimal(acc, sizeof(acc), "0042", 4), parser_ok);
+        EXPECT_STREQ(acc, "42");
+        EXPECT_EQ(tx_summary_add_decimal(acc, sizeof(acc), "958", 3), parser_ok);
+        EXPECT_STREQ(acc, "1000");
+        EXPECT_EQ(tx_summary_add_decimal(acc, sizeof(acc), "0", 1), parser_ok);
+        EXPECT_STREQ(acc, "1000");
+        EXPECT_EQ(tx_summary_add_decimal(acc, sizeof(acc), "99999", 5), parser_ok);
+        EXPECT_STREQ(acc, "100999");
+
+        EXPECT_EQ(tx_summary_add_decimal(acc, sizeof(acc), "12a", 3), parser_unexpected_characters);
+        EXPECT_EQ(tx_summary_add_decimal(acc, sizeof(acc), "", 0), parser_unexpected_value);
+        // A carry could need 8 digits
+        EXPECT_EQ(tx_summary_add_decimal(acc, sizeof(acc), "9999999", 7), parser_value_out_of_range);
+        EXPECT_STREQ(acc, "100999");
+    }
+
+    TEST(TxSummary, Aggregate) {
+        // Messages are counted per registry entry
+        ASSERT_LE(tx_msgs_count(), TX_SUMMARY_MAX_MSG_TYPES);
+
+        tx_summary_t summary;
+        tx_summary_init(&summary);
+
+        ASSERT_EQ(add_tx(&summary, send_tx), parser_ok);
+        ASSERT_EQ(add_tx(&summary, deposit_tx), parser_ok);
+
+        EXPECT_EQ(summary.num_txs, 2);
+        EXPECT_EQ(summary.num_msgs, 3);
+        ASSERT_EQ(summary.num_assets, 2);
+        EXPECT_STREQ(summary.assets[0].asset, "rune");
+        EXPECT_STREQ(summary.assets[0].amount, "200000000");
+        EXPECT_STREQ(summary.assets[0].fee, "2000000");
+        EXPECT_STREQ(summary.assets[1].asset, "THOR.RUNE");
+        EXPECT_STREQ(summary.assets[1].amount, "100000000");
+        EXPECT_STREQ(summary.assets[1].fee, "");
+        // The second send goes to the same address
+        EXPECT_EQ(summary.num_destinations, 2);
+
+        std::vector<std::string> expected = {
+            "0 | Transactions : 2",
+            "1 | Chain ID : thorchain",
+            "2 | Messages : 2 Send, 1 Deposit",
+            "3 | Total : 2.0 RUNE",
+            "4 | Total : 1.0 THOR.RUNE",
+            "5 | Fee : 0.02 RUNE",
+            "6 | To [1/2] : tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e6",
+            "6 | To [2/2] : 8lc9z",
+            "7 | Memo : =:BNB.BNB",
+        };
+        EXPECT_EQ(dumpSummary(&summary), expected);
+    }
+
+    TEST(TxSummary, Rejected) {
+        tx_summary_t summary;
+        tx_summary_init(&summary);
+        ASSERT_EQ(add_tx(&summary, send_tx), parser_ok);
+
+        std::string other_chain = send_tx;
+        other_chain.replace(other_chain.find("thorchain"), 9, "stagenet");
+        EXPECT_EQ(add_tx(&summary, other_chain.c_str()), parser_unexpected_chain);
+
+        // Amounts of unknown messages cannot be added up
+        auto unknown = R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"","msgs":[{"type":"thorchain/MsgFoo","value":{"amount":"1"}}],"sequence":"5"})";
+        tx_summary_init(&summary);
+        EXPECT_EQ(add_tx(&summary, unknown), parser_unexpected_type);
+    }
+
+    TEST(TxSummary, BatchListsRootMemos) {
+        tx_summary_t summary;
+        tx_summary_init(&summary);
+
+        std::string first = send_tx;
+        first.replace(first.find("\"memo\":\"\""), 9, "\"memo\":\"12345\"");
+        std::string second = send_tx;
+        second.replace(second.find("\"memo\":\"\""), 9, "\"memo\":\"67890\"");
+        ASSERT_EQ(add_tx(&summary, first.c_str()), parser_ok);
+        ASSERT_EQ(add_tx(&summary, second.c_str()), parser_ok);
+        // Repeated and empty memos are listed once
+        ASSERT_EQ(add_tx(&summary, first.c_str()), parser_ok);
+        ASSERT_EQ(add_tx(&summary, send_tx), parser_ok);
+
+        std::vector<std::string> expected = {
+            "0 | Transactions : 4",
+            "1 | Chain ID : thorchain",
+            "2 | Messages : 4 Send",
+            "3 | Total : 6.0 RUNE",
+            "4 | Fee : 0.08 RUNE",
+            "5 | Memo : 12345",
+            "6 | To [1/2] : tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e6",
+            "6 | To [2/2] : 8lc9z",
+            "7 | Memo : 67890",
+        };
+        EXPECT_EQ(dumpSummary(&summary), expected);
+
+        // Memos that do not fit reject the batch instead of being hidden
+        // (the summary points into the transactions, they have to stay alive)
+        std::vector<std::string> txs(TX_SUMMARY_MAX_DESTINATIONS, send_tx);
+        tx_summary_init(&summary);
+        for (uint8_t i = 0; i < txs.size(); i++) {
+            txs[i].replace(txs[i].find("\"memo\":\"\""), 9, "\"memo\":\"" + std::to_string(i) + "\"");
+            const parser_error_t expected_err =
+                i + 1 < TX_SUMMARY_MAX_DESTINATIONS ? parser_ok : parser_value_out_of_range;
+            EXPECT_EQ(add_tx(&summary, txs[i].c_str()), expected_err);
+        }
+    }
+
+    TEST(TxSummary, SummaryItemsFirst) {
+        parser_context_t ctx;
+        parser_error_t err = parser_parse(&ctx, (const uint8_t *) deposit_tx, strlen(deposit_tx));
+        ASSERT_EQ(err, parser_ok) << parser_getErrorDescription(err);
+        err = parser_validate(&ctx);
+        ASSERT_EQ(err, parser_ok) << parser_getErrorDescription(err);
+
+        auto output = dumpUI(&ctx, 40, 64);
+        std::vector<std::string> expected = {
+            "0 | Messages : 1 Send, 1 Deposit",
+            "1 | Total : 1.0 THOR.RUNE",
+            "2 | Total : 0.5 RUNE",
+            "3 | Memo : =:BNB.BNB",
+            "4 | To : tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z",
+            "5 | Type : Deposit",
+            "6 | Amount : 1.0 THOR.RUNE",
+            "7 | Memo : =:BNB.BNB",
+            "8 | Sender : tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp",
+            "9 | Type : Send",
+            "10 | Amount : 0.5 RUNE",
+            "11 | From : tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp",
+            "12 | To : tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z",
+        };
+        EXPECT_EQ(output, expected);
+
+        // Jumps skip the summary
+        uint16_t display_idx = 0;
+        ASSERT_EQ(parser_getMsgFirstItem(&ctx, 1, &display_idx), parser_ok);
+        EXPECT_EQ(display_idx, 9);
+
+        // A single message does not need a summary
+        err = parser_parse(&ctx, (const uint8_t *) send_tx, strlen(send_tx));
+        ASSERT_EQ(err, parser_ok) << parser_getErrorDescription(err);
+        output = dumpUI(&ctx, 40, 64);
+        ASSERT_FALSE(output.empty());
+        EXPECT_EQ(output[0], "0 | Type : Send");
+    }
+
+    TEST(TxSummary, BatchHoldsSummaryStorage) {
+        // A batch aggregates into the storage of the single tx summary
+        tx_summary_t *batch = tx_display_holdSummary();
+        ASSERT_EQ(add_tx(batch, deposit_tx), parser_ok);
+        ASSERT_EQ(add_tx(batch, send_tx), parser_ok);
+        const auto batch_items = dumpSummary(batch);
+
+        // Parsing the records must not overwrite it
+        parser_context_t ctx;
+        ASSERT_EQ(parser_parse(&ctx, (const uint8_t *) deposit_tx, strlen(deposit_tx)), parser_ok);
+        ASSERT_EQ(parser_validate(&ctx), parser_ok);
+        EXPECT_EQ(dumpSummary(batch), batch_items);
+        auto output = dumpUI(&ctx, 40, 64);
+        ASSERT_FALSE(output.empty());
+        EXPECT_EQ(output[0], "0 | Type : Deposit");
+
+        // Released, the tx that is still parsed gets its summary back
+        tx_display_releaseSummary();
+        output = dumpUI(&ctx, 40, 64);
+        ASSERT_FALSE(output.empty());
+        EXPECT_EQ(output[0], "0 | Messages : 1 Send, 1 Deposit");
+    }
+}
@@ -17,6 +17,7 @@
 #include "gtest/gtest.h"
 #include <json/json_parser.h>
 #include <tx_validate.h>
+#include <tx_parser.h>
 #include <common/parser.h>
 #include "util/common.h"
 
@@ -26,25 +27,30 @@ namespace {
             R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"TestMemo","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}],"sequence":"5"})";
 
         parsed_json_t json;
+        tx_root_fields_t root_fields;
         parser_error_t err;
 
         err = JSON_PARSE(&json, transaction);
         ASSERT_EQ(err, parser_ok);
 
-        err = tx_validate(&json);
+        err = tx_validate(&json, &root_fields);
         EXPECT_EQ(err, parser_ok) << "Validation failed, error: " << parser_getErrorDescription(err);
+        // Located for the indexer
+        EXPECT_EQ(root_fields.found, (1u << NUM_REQUIRED_ROOT_PAGES) - 1);
+        EXPECT_EQ(root_fields.json_generation, json.generation);
     }
     TEST(TxValidationTest, MissingAccountNumber) {
         auto transaction =
             R"({"chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"TestMemo","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}],"sequence":"5"})";
 
         parsed_json_t json;
+        tx_root_fields_t root_fields;
         parser_error_t err;
 
         err = JSON_PARSE(&json, transaction);
         ASSERT_EQ(err, parser_ok);
 
-        err = tx_validate(&json);
+        err = tx_validate(&json, &root_fields);
 
         EXPECT_EQ(err, parser_json_missing_account_number) << "Validation failed, error: " << parser_getErrorDescription(err);
     }
@@ -54,12 +60,13 @@ namespace {
             R"({"account_number":"588","fee":{"amount":[],"gas":"2000000"},"memo":"TestMemo","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}],"sequence":"5"})";
 
         parsed_json_t json;
+        tx_root_fields_t root_fields;
         parser_error_t err;
 
         err = JSON_PARSE(&json, transaction);
         ASSERT_EQ(err, parser_ok);
 
-        err = tx_validate(&json);
+        err = tx_validate(&json, &root_fields);
         EXPECT_EQ(err, parser_json_missing_chain_id) << "Validation failed, error: " << parser_getErrorDescription(err);
     }
 
@@ -68,12 +75,13 @@ namespace {
             R"({"account_number":"588","chain_id":"thorchain","memo":"TestMemo","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}],"sequence":"5"})";
 
         parsed_json_t json;
+        tx_root_fields_t root_fields;
         parser_error_t err;
 
         err = JSON_PARSE(&json, transaction);
         ASSERT_EQ(err, parser_ok);
 
-        err = tx_validate(&json);
+        err = tx_validate(&json, &root_fields);
         EXPECT_EQ(err, parser_json_missing_fee) << "Validation failed, error: " << parser_getErrorDescription(err);
     }
 
@@ -82,12 +90,13 @@ namespace {
             R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"TestMemo","sequence":"5"})";
 
         parsed_json_t json;
+        tx_root_fields_t root_fields;
         parser_error_t err;
 
         err = JSON_PARSE(&json, transaction);
         ASSERT_EQ(err, parser_ok);
 
-        err = tx_validate(&json);
+        err = tx_validate(&json, &root_fields);
         EXPECT_EQ(err, parser_json_missing_msgs) << "Validation failed, error: " << parser_getErrorDescription(err);
     }
 
@@ -96,12 +105,13 @@ namespace {
             R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"TestMemo","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}]})";
 
         parsed_json_t json;
+        tx_root_fields_t root_fields;
         parser_error_t err;
 
         err = JSON_PARSE(&json, transaction);
         ASSERT_EQ(err, parser_ok);
 
-        err = tx_validate(&json);
+        err = tx_validate(&json, &root_fields);
         EXPECT_EQ(err, parser_json_missing_sequence) << "Validation failed, error: " << parser_getErrorDescription(err);
     }
 
@@ -110,12 +120,13 @@ namespace {
             R"({"account_number":"588", "chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"TestMemo","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}],"sequence":"5"})";
 
         parsed_json_t json;
+        tx_root_fields_t root_fields;
         parser_error_t err;
 
         err = JSON_PARSE(&json, transaction);
         ASSERT_EQ(err, parser_ok);
 
-        err = tx_validate(&json);
+        err = tx_validate(&json, &root_fields);
         EXPECT_EQ(err, parser_json_contains_whitespace) << "Validation failed, error: " << parser_getErrorDescription(err);
     }
 
@@ -124,12 +135,13 @@ namespace {
             R"({  "account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"TestMemo","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}],"sequence":"5"})";
 
         parsed_json_t json;
+        tx_root_fields_t root_fields;
         parser_error_t err;
 
         err = JSON_PARSE(&json, transaction);
         ASSERT_EQ(err, parser_ok);
 
-        err = tx_validate(&json);
+        err = tx_validate(&json, &root_fields);
         EXPECT_EQ(err, parser_json_contains_whitespace) << "Validation failed, error: " << parser_getErrorDescription(err);
     }
 
@@ -138,12 +150,13 @@ namespace {
             R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"TestMemo","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}],"sequence":"5"  })";
 
         parsed_json_t json;
+        tx_root_fields_t root_fields;
         parser_error_t err;
 
         err = JSON_PARSE(&json, transaction);
         ASSERT_EQ(err, parser_ok);
 
-        err = tx_validate(&json);
+        err = tx_validate(&json, &root_fields);
         EXPECT_EQ(err, parser_json_contains_whitespace) << "Validation failed, error: " << parser_getErrorDescription(err);
     }
 
@@ -152,12 +165,13 @@ namespace {
             R"({"account_number": "588","chain_id":"thorchain"  ,"fee":{"amount": [ ],"gas":"2000000"},"memo":"TestMemo","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}],"sequence":"5"})";
 
         parsed_json_t json;
+        tx_root_fields_t root_fields;
         parser_error_t err;
 
         err = JSON_PARSE(&json, transaction);
         ASSERT_EQ(err, parser_ok);
 
-        err = tx_validate(&json);
+        err = tx_validate(&json, &root_fields);
         EXPECT_EQ(err, parser_json_contains_whitespace) << "Validation failed, error: " << parser_getErrorDescription(err);
     }
 
@@ -166,26 +180,74 @@ namespace {
             R"({"account_number":"588","chain_id":"  thorchain  ","fee":{"amount":[],"gas":"2000000"},"memo":"  TestMemo  ","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}],"sequence":"5"})";
 
         parsed_json_t json;
+        tx_root_fields_t root_fields;
         parser_error_t err;
 
         err = JSON_PARSE(&json, transaction);
         ASSERT_EQ(err, parser_ok);
 
-        err = tx_validate(&json);
+        err = tx_validate(&json, &root_fields);
         EXPECT_EQ(err, parser_ok) << "Validation failed, error: " << parser_getErrorDescription(err);
     }
 
+    TEST(TxValidationTest, Spaces_AfterOpeningBracket) {
+        auto transaction =
+            R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[ ],"gas":"2000000"},"memo":"TestMemo","msgs":[ {"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}],"sequence":"5"})";
+
+        parsed_json_t json;
+        tx_root_fields_t root_fields;
+        parser_error_t err;
+
+        err = JSON_PARSE(&json, transaction);
+        ASSERT_EQ(err, parser_ok);
+
+        err = tx_validate(&json, &root_fields);
+        EXPECT_EQ(err, parser_json_contains_whitespace) << "Validation failed, error: " << parser_getErrorDescription(err);
+    }
+
+    TEST(TxValidationTest, Spaces_AfterPrimitive) {
+        auto transaction =
+            R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"flag":true ,"memo":"TestMemo","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}],"sequence":"5"})";
+
+        parsed_json_t json;
+        tx_root_fields_t root_fields;
+        parser_error_t err;
+
+        err = JSON_PARSE(&json, transaction);
+        ASSERT_EQ(err, parser_ok);
+
+        err = tx_validate(&json, &root_fields);
+        EXPECT_EQ(err, parser_json_contains_whitespace) << "Validation failed, error: " << parser_getErrorDescription(err);
+    }
+
+    TEST(TxValidationTest, ControlCharInString) {
+        auto transaction =
+            "{\"account_number\":\"588\",\"chain_id\":\"thorchain\",\"fee\":{\"amount\":[],\"gas\":\"2000000\"},"
+            "\"memo\":\"Test\tMemo\",\"msgs\":[],\"sequence\":\"5\"}";
+
+        parsed_json_t json;
+        tx_root_fields_t root_fields;
+        parser_error_t err;
+
+        err = JSON_PARSE(&json, transaction);
+        ASSERT_EQ(err, parser_ok);
+
+        err = tx_validate(&json, &root_fields);
+        EXPECT_EQ(err, parser_json_contains_control_char) << "Validation failed, error: " << parser_getErrorDescription(err);
+    }
+
     TEST(TxValidationTest, SortedDictionary) {
         auto transaction =
             R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"TestMemo","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}],"sequence":"5"})";
 
         parsed_json_t json;
+        tx_root_fields_t root_fields;
         parser_error_t err;
 
         err = JSON_PARSE(&json, transaction);
         ASSERT_EQ(err, parser_ok);
 
-        err = tx_validate(&json);
+        err = tx_validate(&json, &root_fields);
         EXPECT_EQ(err, parser_ok) << "Validation failed, error: " << parser_getErrorDescription(err);
     }
 
@@ -194,12 +256,13 @@ namespace {
             R"({"chain_id":"thorchain","account_number":"588","fee":{"amount":[],"gas":"2000000"},"memo":"TestMemo","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}],"sequence":"5"})";
 
         parsed_json_t json;
+        tx_root_fields_t root_fields;
         parser_error_t err;
 
         err = JSON_PARSE(&json, transaction);
         ASSERT_EQ(err, parser_ok);
 
-        err = tx_validate(&json);
+        err = tx_validate(&json, &root_fields);
         EXPECT_EQ(err, parser_json_is_not_sorted) << "Validation failed, error: " << parser_getErrorDescription(err);
     }
 
@@ -208,12 +271,13 @@ namespace {
             R"({"account_number":"588","chain_id":"thorchain","fee":{"gas":"2000000","amount":[]},"memo":"TestMemo","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}],"sequence":"5"})";
 
         parsed_json_t json;
+        tx_root_fields_t root_fields;
         parser_error_t err;
 
         err = JSON_PARSE(&json, transaction);
         ASSERT_EQ(err, parser_ok);
 
-        err = tx_validate(&json);
+        err = tx_validate(&json, &root_fields);
         EXPECT_EQ(err, parser_json_is_not_sorted) << "Validation failed, error: " << parser_getErrorDescription(err);
     }
 
@@ -222,12 +286,38 @@ namespace {
             R"({"account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"memo":"TestMemo","sequence":"5","msgs":[{"type":"thorchain/MsgSend","value":{"amount":[{"amount":"150000000","denom":"rune"}],"from_address":"tthor1c648xgpter9xffhmcqvs7lzd7hxh0prgv5t5gp","to_address":"tthor10xgrknu44d83qr4s4uw56cqxg0hsev5e68lc9z"}}]})";
 
         parsed_json_t json;
+        tx_root_fields_t root_fields;
         parser_error_t err;
 
         err = JSON_PARSE(&json, transaction);
         ASSERT_EQ(err, parser_ok);
 
-        err = tx_validate(&json);
+        err = tx_validate(&json, &root_fields);
         EXPECT_EQ(err, parser_json_is_not_sorted) << "Validation failed, error: " << parser_getErrorDescription(err);
     }
+
+    TEST(TxValidationTest, RootFieldsMatch) {
+        // Unsorted root with an unknown key and a duplicated one
+        auto transaction =
+            R"({"sequence":"5","extra":{"memo":"x"},"memo":"TestMemo","account_number":"588","chain_id":"thorchain","fee":{"amount":[],"gas":"2000000"},"msgs":[],"memo":"Other"})";
+
+        parsed_json_t json;
+        parser_error_t err;
+
+        err = JSON_PARSE(&json, transaction);
+        ASSERT_EQ(err, parser_ok);
+
+        tx_root_fields_t fields;
+        err = tx_root_fields_match(&json, &fields);
+        ASSERT_EQ(err, parser_ok);
+
+        EXPECT_EQ(fields.found, (1u << NUM_REQUIRED_ROOT_PAGES) - 1);
+        EXPECT_EQ(fields.json_generation, json.generation);
+
+        for (uint8_t i = 0; i < NUM_REQUIRED_ROOT_PAGES; i++) {
+            uint16_t token_index;
+            ASSERT_EQ(object_get_value(&json, 0, get_required_root_item((root_item_e) i), &token_index), parser_ok);
+            EXPECT_EQ(fields.value_token_idx[i], token_index) << get_required_root_item((root_item_e) i);
+        }
+    }
 }
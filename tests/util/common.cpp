@@ -18,10 +18,13 @@
 #include <sstream>
 #include "common.h"
 
+JSON_TOKEN_ARENA(test_arena, MAX_NUMBER_OF_TOKENS);
+const json_token_arena_t *json_test_arena = &test_arena;
+
 std::vector<std::string> dumpUI(parser_context_t *ctx,
                                 uint16_t maxKeyLen,
                                 uint16_t maxValueLen) {
-    uint8_t numItems;
+    uint16_t numItems;
     parser_error_t err = parser_getNumItems(ctx, &numItems);
 
     auto answer = std::vector<std::string>();
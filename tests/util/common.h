@@ -28,4 +28,8 @@ parser_error_t parse_tx(parsed_json_t *parsed_json, const char *tx);
 
 std::vector<std::string> dumpUI(parser_context_t *ctx, uint16_t maxKeyLen, uint16_t maxValueLen);
 
-#define JSON_PARSE(parsed_json, buffer) json_parse(parsed_json, buffer, strlen(buffer))
+// Token arena shared by the tests that use JSON_PARSE
+extern const json_token_arena_t *json_test_arena;
+
+#define JSON_PARSE(parsed_json, buffer) \
+    json_parse(parsed_json, json_test_arena, buffer, strlen(buffer))